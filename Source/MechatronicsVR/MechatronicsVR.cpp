@@ -1,6 +1,21 @@
 // Copyright Epic Games, Inc. All Rights Reserved.
 
 #include "MechatronicsVR.h"
+#include "AssemblyAllocationCounter.h"
 #include "Modules/ModuleManager.h"
 
-IMPLEMENT_PRIMARY_GAME_MODULE( FDefaultGameModuleImpl, MechatronicsVR, "MechatronicsVR" );
+class FMechatronicsVRModule : public FDefaultGameModuleImpl
+{
+public:
+	virtual void StartupModule() override
+	{
+		FAssemblyAllocationCounter::Install();
+	}
+
+	virtual void ShutdownModule() override
+	{
+		FAssemblyAllocationCounter::Uninstall();
+	}
+};
+
+IMPLEMENT_PRIMARY_GAME_MODULE( FMechatronicsVRModule, MechatronicsVR, "MechatronicsVR" );
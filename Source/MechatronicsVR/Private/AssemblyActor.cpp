@@ -2,15 +2,25 @@
 
 #include "AssemblyActor.h"
 #include "PartActor.h"
+#include "AssemblyAssetSubsystem.h"
 #include "AssemblyComponent.h"
+#include "AssemblyNetComponent.h"
+#include "AssemblyRegistrySubsystem.h"
+#include "AssemblyStats.h"
+#include "HeldPartNetComponent.h"
 #include "SnapPointComponent.h"
+#include "AssemblyTickSubsystem.h"
+#include "Engine/World.h"
+#include "GameFramework/GameModeBase.h"
+#include "GameFramework/PlayerController.h"
+#include "Net/UnrealNetwork.h"
 
 
 // Sets default values
 AAssemblyActor::AAssemblyActor()
 {
-	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+	// Per-frame work lives in UAssemblyTickSubsystem; cleanup runs only after an invalidation callback
+	PrimaryActorTick.bCanEverTick = false;
 
 	// Initialize default state
 	AssemblyState = EAssemblyState::Empty;
@@ -30,6 +40,25 @@ AAssemblyActor::AAssemblyActor()
 	// Default settings
 	bIsAssemblyActive = true;
 	bShowBaseSnapPoints = true;
+
+	// The server's connections replicate to every client, wherever they are standing
+	bReplicates = true;
+	bAlwaysRelevant = true;
+}
+
+void AAssemblyActor::PostInitProperties()
+{
+	Super::PostInitProperties();
+
+	// After property init, so a Blueprint subclass does not inherit its archetype's pointer
+	ReplicatedConnections.Owner = this;
+}
+
+void AAssemblyActor::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(AAssemblyActor, ReplicatedConnections);
 }
 
 // Called when the game starts or when spawned
@@ -37,43 +66,103 @@ void AAssemblyActor::BeginPlay()
 {
 	Super::BeginPlay();
 
+	LessonMatcher.Compile(Lesson);
+
+	if (bUsePhysicsConstraints && bPrewarmConstraintPool)
+	{
+		PrewarmConstraintPool(Lesson ? FMath::Max(ExpectedConnectionCount, Lesson->GetNumExpectedConnections()) : ExpectedConnectionCount);
+	}
+
+	if (UAssemblyTickSubsystem* TickSubsystem = UAssemblyTickSubsystem::Get(this))
+	{
+		TickSubsystem->RegisterAssembly(this);
+	}
+
+	if (UAssemblyRegistrySubsystem* Registry = UAssemblyRegistrySubsystem::Get(this))
+	{
+		Registry->RegisterAssembly(this);
+	}
+
+	if (UAssemblyAssetSubsystem* AssetSubsystem = UAssemblyAssetSubsystem::Get(this))
+	{
+		TArray<FSoftObjectPath> Preload;
+		Preload.Reserve(LessonPartMeshes.Num() + (Lesson ? Lesson->PartMeshes.Num() : 0));
+		for (const TSoftObjectPtr<UStaticMesh>& PartMesh : LessonPartMeshes)
+		{
+			Preload.Add(PartMesh.ToSoftObjectPath());
+		}
+		if (Lesson)
+		{
+			for (const TSoftObjectPtr<UStaticMesh>& PartMesh : Lesson->PartMeshes)
+			{
+				Preload.Add(PartMesh.ToSoftObjectPath());
+			}
+		}
+		AssetSubsystem->RequestPreload(Preload);
+	}
+
+	if (ShouldReplicateConnections())
+	{
+		// Client requests arrive through a component on each player controller
+		for (FConstPlayerControllerIterator It = GetWorld()->GetPlayerControllerIterator(); It; ++It)
+		{
+			UAssemblyNetComponent::FindOrAdd(It->Get());
+		}
+		PostLoginHandle = FGameModeEvents::GameModePostLoginEvent.AddUObject(this, &AAssemblyActor::HandlePostLogin);
+	}
+	else if (!HasAuthority())
+	{
+		ApplyPendingReplicatedConnections();
+	}
+
 	UpdateAssemblyState();
 	
 }
 
-// Called every frame
-void AAssemblyActor::Tick(float DeltaTime)
+void AAssemblyActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
 {
-	Super::Tick(DeltaTime);
+	if (UAssemblyTickSubsystem* TickSubsystem = UAssemblyTickSubsystem::Get(this))
+	{
+		TickSubsystem->UnregisterAssembly(this);
+	}
+
+	if (UAssemblyRegistrySubsystem* Registry = UAssemblyRegistrySubsystem::Get(this))
+	{
+		Registry->UnregisterAssembly(this);
+	}
 
-	CleanupInvalidConstraints();
+	if (PostLoginHandle.IsValid())
+	{
+		FGameModeEvents::GameModePostLoginEvent.Remove(PostLoginHandle);
+		PostLoginHandle.Reset();
+	}
 
+	Super::EndPlay(EndPlayReason);
 }
 
 bool AAssemblyActor::IsPartAttachedToBase(APartActor* Part) const
 {
 	if (!Part) return false;
 
-
-	// check if this part is connected to any base snap point
-	for (const FPartConnection& Connection : Connections)
+	// check if any of this part's connections is to a base snap point
+	for (const FAssemblyConnectionHandle& Handle : GetConnectionHandles(Part))
 	{
-		bool bConnectedToBase = false;
-		if (Connection.PartA == Part || Connection.PartB == Part)
+		const FPartConnection* Connection = ResolveConnection(Handle);
+		if (!Connection)
 		{
-			// Check if this is a base connection
-			if (Connection.bIsBaseConnection)
-			{
-				return true;
-			}
-            
-			// Alternative check: see if either snap point is in our base snap points
-			if (BaseSnapPoints.Contains(Connection.SnapPointA) || 
-				BaseSnapPoints.Contains(Connection.SnapPointB))
-			{
-				return true;
-			}
-			
+			continue;
+		}
+
+		if (Connection->bIsBaseConnection)
+		{
+			return true;
+		}
+
+		// Alternative check: see if either snap point is in our base snap points
+		if (BaseSnapPoints.Contains(Connection->SnapPointA) || 
+			BaseSnapPoints.Contains(Connection->SnapPointB))
+		{
+			return true;
 		}
 	}
 	return false;
@@ -91,8 +180,9 @@ void AAssemblyActor::AddPart(APartActor* NewPart)
 		UE_LOG(LogTemp, Warning, TEXT("AAssemblyActor::AddPart: Part already in assembly"));
 		return;
 	}
-	Parts.Add(NewPart);
-	UpdateAssemblyState();
+	TrackPart(NewPart);
+	SubAssemblies.AddPart(NewPart);
+	RequestStateUpdate();
 
 	UE_LOG(LogTemp, Log, TEXT("AAssemblyActor::AddPart: Added part %s. Total parts: %d"), 
 		*NewPart->GetName(), Parts.Num());
@@ -112,17 +202,24 @@ void AAssemblyActor::RemovePart(APartActor* Part)
 		return;
 	}
 
-	// Disconnect all connections involving this part
-	for (const FPartConnection& Connection : Connections)
+	BeginChangeBatch();
+
+	// Disconnect all connections involving this part. Copy the handles first,
+	// each disconnect edits the adjacency list we would otherwise be walking.
+	const TArray<FAssemblyConnectionHandle, TInlineAllocator<16>> PartConnections(GetConnectionHandles(Part));
+	for (const FAssemblyConnectionHandle& Handle : PartConnections)
 	{
-		if (Connection.PartA == Part || Connection.PartB == Part)
-		{
-			DisconnectParts(Connection.PartA, Connection.PartB);
-		}
+		DisconnectConnection(Handle);
 	}
 
 	Parts.Remove(Part);
-	UpdateAssemblyState();
+	PartAdjacency.Remove(Part);
+	Part->OnDestroyed.RemoveDynamic(this, &AAssemblyActor::HandlePartDestroyed);
+	SubAssemblies.RemovePart(Part);
+	WeldGroups.RemovePart(Part);
+	RequestStateUpdate();
+
+	EndChangeBatch();
 
 	UE_LOG(LogTemp, Log, TEXT("AAssemblyActor::RemovePart: Removed part %s. Total parts: %d"), 
 		   *Part->GetName(), Parts.Num());
@@ -132,17 +229,17 @@ void AAssemblyActor::RemovePart(APartActor* Part)
 
 bool AAssemblyActor::ConnectParts(APartActor* PartA, APartActor* PartB, USnapPointComponent* SnapPointA, USnapPointComponent* SnapPointB)
 {
-	
-	// Declare AND use it immediately to prevent optimization
-	bool bIsBaseConnection = BaseSnapPoints.Contains(SnapPointA) || 
+	ASSEMBLY_SCOPE_CYCLE_COUNTER(ConnectParts);
+
+	const bool bIsBaseConnection = BaseSnapPoints.Contains(SnapPointA) || 
 							BaseSnapPoints.Contains(SnapPointB);
-    
-	UE_LOG(LogTemp, Warning, TEXT("bIsBaseConnection = %s"), 
-		   bIsBaseConnection ? TEXT("true") : TEXT("false"));
 	
 	// Validate inputs
-	
-	
+	if (!SnapPointA || !SnapPointB || (!PartA && !PartB))
+	{
+		UE_LOG(LogTemp, Warning, TEXT("AAssemblyActor::ConnectParts: Invalid input parameters"));
+		return false;
+	}
     
 	// Check if parts are already connected
 	if (ArePartsConnected(PartA, PartB))
@@ -152,7 +249,7 @@ bool AAssemblyActor::ConnectParts(APartActor* PartA, APartActor* PartB, USnapPoi
 	}
     
 	// Validate snap point compatibility
-	if (!SnapPointA->CanAcceptPoint(SnapPointB) || !SnapPointB->CanAcceptPoint(SnapPointA))
+	if (!SnapPointA->CanMutuallyAccept(SnapPointB))
 	{
 		UE_LOG(LogTemp, Warning, TEXT("AAssemblyActor::ConnectParts: Snap points not compatible"));
 		return false;
@@ -165,13 +262,21 @@ bool AAssemblyActor::ConnectParts(APartActor* PartA, APartActor* PartB, USnapPoi
 		return false;
 	}
 
-	// // Create physics constraint
-	// UPhysicsConstraintComponent* Constraint = CreateConstraintBetweenParts(PartA, SnapPointA, PartB, SnapPointB);
-	// if (!Constraint)
-	// {
-	// 	UE_LOG(LogTemp, Error, TEXT("AAssemblyActor::ConnectParts: Failed to create constraint"));
-	// 	return false;
-	// }
+	// Create physics constraint, or weld if the joint would be fully locked anyway
+	UPhysicsConstraintComponent* Constraint = nullptr;
+	const USnapPointComponent* AxisSource = nullptr;
+	const FSnapConstraintProfile& Profile = ResolveConstraintProfile(SnapPointA, SnapPointB, AxisSource);
+	const bool bWeld = bUsePhysicsConstraints && bWeldFixedConnections && PartA && PartB &&
+		Profile.JointType == EAssemblyJointType::Fixed && !Profile.bBreakable;
+	if (bUsePhysicsConstraints && PartA && PartB && !bWeld)
+	{
+		Constraint = CreateConstraintBetweenParts(PartA, SnapPointA, PartB, SnapPointB);
+		if (!Constraint)
+		{
+			UE_LOG(LogTemp, Error, TEXT("AAssemblyActor::ConnectParts: Failed to create constraint"));
+			return false;
+		}
+	}
 
 	//Create connection record
 	FPartConnection NewConnection;
@@ -179,39 +284,36 @@ bool AAssemblyActor::ConnectParts(APartActor* PartA, APartActor* PartB, USnapPoi
 	NewConnection.PartB = PartB;
 	NewConnection.SnapPointA = SnapPointA;
 	NewConnection.SnapPointB = SnapPointB;
-	// NewConnection.Constraint = Constraint;
+	NewConnection.Constraint = Constraint;
+	NewConnection.bIsWelded = bWeld;
 	NewConnection.bIsBaseConnection = bIsBaseConnection;
 	NewConnection.bIsConnected = true;
 
-	Connections.Add(NewConnection);
+	BeginChangeBatch();
 
-	// Mark snap points as assembled
-	SnapPointA->bIsAssembled = true;
-	SnapPointB->bIsAssembled = true;
+	PendingConnected.Add(AddConnectionRecord(MoveTemp(NewConnection)));
+	PendingPartEvents.Add(FPendingPartEvent{ PartA, PartB, true });
 
-	// update assembly state
-	UpdateAssemblyState();
+	// Mark snap points as assembled
+	SnapPointA->SetIsAssembled(true);
+	SnapPointB->SetIsAssembled(true);
 
 	// Add part to the assembly
-	if (PartA && !Parts.Contains(PartA))
-	{
-		Parts.Add(PartA);
-	}
-	if (PartB && !Parts.Contains(PartB))
-	{
-		Parts.Add(PartB);
-	}
+	TrackPart(PartA);
+	TrackPart(PartB);
 
-	//fire events
-	OnPartsConnected.Broadcast(PartA, PartB);
+	// update assembly state, and fire events unless an outer batch is open
+	AssemblyTrace::OutputPartEvent(AssemblyTrace::EPartEvent::Snap, PartB, PartA);
+	RequestStateUpdate();
+	EndChangeBatch();
 
 	if (bIsBaseConnection)
 	{
-		UE_LOG(LogTemp, Log, TEXT("AAssemblyActor::ConnectParts: Successfully connected %s to base"), 
+		UE_LOG(LogTemp, Verbose, TEXT("AAssemblyActor::ConnectParts: Successfully connected %s to base"), 
 		   *PartB->GetName());
 	} else
 	{
-		UE_LOG(LogTemp, Log, TEXT("AAssemblyActor::ConnectParts: Successfully connected %s to %s"), 
+		UE_LOG(LogTemp, Verbose, TEXT("AAssemblyActor::ConnectParts: Successfully connected %s to %s"), 
 		   *PartA->GetName(), *PartB->GetName());
 	}
     
@@ -220,6 +322,8 @@ bool AAssemblyActor::ConnectParts(APartActor* PartA, APartActor* PartB, USnapPoi
 
 bool AAssemblyActor::DisconnectParts(APartActor* PartA, APartActor* PartB)
 {
+	ASSEMBLY_SCOPE_CYCLE_COUNTER(DisconnectParts);
+
 	if (!PartA || !PartB)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("AAssemblyActor::DisconnectParts: Invalid input parameters"));
@@ -227,257 +331,1160 @@ bool AAssemblyActor::DisconnectParts(APartActor* PartA, APartActor* PartB)
 	}
 
 	// Find the connection
-	int32 ConnectionIndex = -1;
-	for (int32 i = 0; i < Connections.Num(); ++i)
+	const FAssemblyConnectionHandle Handle = FindConnectionHandle(PartA, PartB);
+	if (!Handle.IsValid())
 	{
-		const FPartConnection& Connection = Connections[i];
-		if ((Connection.PartA == PartA && Connection.PartB == PartB) ||
-			(Connection.PartA == PartB && Connection.PartB == PartA))
-		{
-			ConnectionIndex = i;
-			break;
-		}
+		UE_LOG(LogTemp, Warning, TEXT("AAssemblyActor::DisconnectParts: No connection found between %s and %s"), 
+			   *PartA->GetName(), *PartB->GetName());
+		return false;
 	}
 
-	if (ConnectionIndex == -1)
+	return DisconnectConnection(Handle);
+}
+
+bool AAssemblyActor::DisconnectConnection(FAssemblyConnectionHandle Handle)
+{
+	const FPartConnection* ConnectionPtr = ResolveConnection(Handle);
+	if (!ConnectionPtr)
 	{
-		UE_LOG(LogTemp, Warning, TEXT("AAssemblyActor::DisconnectParts: No connection found between %s and %s"), 
-			   *PartA->GetName(), *PartB->GetName());
+		UE_LOG(LogTemp, Warning, TEXT("AAssemblyActor::DisconnectConnection: Stale connection handle"));
 		return false;
 	}
-	FPartConnection &Connection = Connections[ConnectionIndex];
+	// Copy, the record is gone once removed
+	const FPartConnection Connection = *ConnectionPtr;
+	AssemblyTrace::OutputPartEvent(AssemblyTrace::EPartEvent::Disconnect, Connection.PartB, Connection.PartA);
 
-	// Destroy the physics constraint
+	BeginChangeBatch();
+
+	// Return the physics constraint to the pool
 	if (Connection.Constraint)
 	{
-		PhysicalConstraints.Remove(Connection.Constraint);
-		Connection.Constraint->DestroyComponent();
+		ReleaseConstraint(Connection.Constraint);
 	}
-	// Find and unmark snap points
-	TArray<USnapPointComponent*> SnapPointsA = PartA->GetSnapPoints();
-	TArray<USnapPointComponent*> SnapPointsB = PartB->GetSnapPoints();
 
-	for (USnapPointComponent* SnapA : SnapPointsA)
+	// Unmark the snap points this connection used
+	if (Connection.SnapPointA)
 	{
-		for (USnapPointComponent* SnapB : SnapPointsB)
-		{
-			if (SnapA->bIsAssembled && SnapB->bIsAssembled &&
-				SnapA->CanAcceptPoint(SnapB) && SnapB->CanAcceptPoint(SnapA))
-			{
-				SnapA->bIsAssembled = false;
-				SnapB->bIsAssembled = false;
-				break;
-			}
-		}
+		Connection.SnapPointA->SetIsAssembled(false);
+	}
+	if (Connection.SnapPointB)
+	{
+		Connection.SnapPointB->SetIsAssembled(false);
 	}
 
-	// Remove the connection
-	Connections.RemoveAt(ConnectionIndex);
-
-	//Update assembly state
-	UpdateAssemblyState();
+	// Remove the connection. One made earlier in this batch simply never happened.
+	RemoveConnectionRecord(Handle);
+	if (PendingConnected.RemoveSwap(Handle, EAllowShrinking::No) == 0)
+	{
+		PendingDisconnected.Add(Connection);
+	}
+	PendingPartEvents.Add(FPendingPartEvent{ Connection.PartA, Connection.PartB, false });
 
-	// Fire events
-	OnPartDisconnected.Broadcast(PartA, PartB);
+	//Update assembly state, and fire events unless an outer batch is open
+	RequestStateUpdate();
+	EndChangeBatch();
 
-	UE_LOG(LogTemp, Log, TEXT("AAssemblyActor::DisconnectParts: Successfully disconnected %s from %s"), 
-		   *PartA->GetName(), *PartB->GetName());
+	UE_LOG(LogTemp, Verbose, TEXT("AAssemblyActor::DisconnectConnection: Successfully disconnected %s from %s"), 
+		   Connection.PartA ? *Connection.PartA->GetName() : TEXT("base"),
+		   Connection.PartB ? *Connection.PartB->GetName() : TEXT("base"));
     
 	return true;
-	
 }
 
-// ================== ASSEMBLY STATE MANAGEMENT ==================
+// ================== CHANGE BATCHES ==================
 
-bool AAssemblyActor::IsFullyAssembled() const
+void AAssemblyActor::BeginChangeBatch()
 {
-	return (Parts.Num() >= ExpectedPartCount) && (Connections.Num() >= ExpectedConnectionCount) &&
-		(AssemblyState == EAssemblyState::FullyAssembled);
+	++ChangeBatchDepth;
 }
 
-float AAssemblyActor::GetAssemblyProgress() const
+void AAssemblyActor::EndChangeBatch()
 {
-	if (ExpectedPartCount == 0 && ExpectedConnectionCount == 0)
+	if (ChangeBatchDepth == 0)
 	{
-		return 0.0f;
+		UE_LOG(LogTemp, Warning, TEXT("AAssemblyActor::EndChangeBatch: No batch in progress"));
+		return;
 	}
+	if (--ChangeBatchDepth == 0)
+	{
+		FlushChangeBatch();
+	}
+}
 
-	// Calculate progress based on both parts and connections
-	const float PartProgress = ExpectedPartCount > 0 ? 
-		                           static_cast<float>(Parts.Num()) / static_cast<float>(ExpectedPartCount) : 1.0f;
-
-	const float ConnectionProgress = ExpectedConnectionCount > 0 ? 
-		                                 static_cast<float>(Connections.Num()) / static_cast<float>(ExpectedConnectionCount) : 1.0f;
-    
-	// Weight parts and connections equally
-	const float TotalProgress = (PartProgress + ConnectionProgress) * 0.5f;
-    
-	// Clamp to 0-1 range
-	return FMath::Clamp(TotalProgress, 0.0f, 1.0f);
+void AAssemblyActor::RequestStateUpdate()
+{
+	if (IsInChangeBatch())
+	{
+		bPendingStateUpdate = true;
+	}
+	else
+	{
+		UpdateAssemblyState();
+	}
 }
-void AAssemblyActor::UpdateAssemblyState()
+
+void AAssemblyActor::FlushChangeBatch()
 {
-	EAssemblyState PreviousState = AssemblyState;
+	// The change set borrows the batch's buffers, so a batch no bigger than the last allocates nothing
+	FAssemblyChangeSet Changes;
+	Changes.Connected = MoveTemp(ChangeSetConnected);
+	Changes.Connected.Reset(PendingConnected.Num());
+	for (const FAssemblyConnectionHandle& Handle : PendingConnected)
+	{
+		if (const FPartConnection* Connection = ResolveConnection(Handle))
+		{
+			Changes.Connected.Add(*Connection);
+		}
+	}
+	Changes.Disconnected = MoveTemp(PendingDisconnected);
+	PendingConnected.Reset();
+	PendingDisconnected.Reset();
 
-	//determine new state
-	if (Parts.Num() == 0)
+	// Copied out first, a listener may connect or disconnect and start a batch of its own
+	const TArray<FPendingPartEvent, TInlineAllocator<8>> PartEvents(PendingPartEvents);
+	PendingPartEvents.Reset();
+
+	if (bPendingStateUpdate)
 	{
-		AssemblyState = EAssemblyState::Empty;
+		bPendingStateUpdate = false;
+		UpdateAssemblyState();
 	}
-	else if (IsFullyAssembled())
+
+	// Every connect and disconnect in the batch, in the order they happened, then the net change set
+	for (const FPendingPartEvent& Event : PartEvents)
 	{
-		AssemblyState = EAssemblyState::FullyAssembled;
+		if (Event.bConnected)
+		{
+			OnPartsConnected.Broadcast(Event.PartA, Event.PartB);
+		}
+		else
+		{
+			OnPartDisconnected.Broadcast(Event.PartA, Event.PartB);
+		}
 	}
-	else
+
+	if (!Changes.IsEmpty())
 	{
-		AssemblyState = EAssemblyState::PartiallyAssembled;
+		OnAssemblyChanged.Broadcast(Changes);
 	}
 
-	// fire event if state changed
-	if (AssemblyState != PreviousState)
+	// Unless a listener's own batch claimed them meanwhile, hand the buffers back
+	if (ChangeSetConnected.Max() == 0)
 	{
-		OnAssemblyStateChanged.Broadcast(AssemblyState);
-		UE_LOG(LogTemp, Log, TEXT("AAssemblyActor::UpdateAssemblyState: State changed to %d. Parts: %d/%d, Connections: %d/%d"), 
-			   static_cast<int32>(AssemblyState), Parts.Num(), ExpectedPartCount, 
-			   Connections.Num(), ExpectedConnectionCount);
+		Changes.Connected.Reset();
+		ChangeSetConnected = MoveTemp(Changes.Connected);
+	}
+	if (PendingDisconnected.Max() == 0)
+	{
+		Changes.Disconnected.Reset();
+		PendingDisconnected = MoveTemp(Changes.Disconnected);
 	}
 }
 
+// ================== CONNECTION STORAGE ==================
 
-// ================== CONNECTION QUERIES ==================
-FPartConnection AAssemblyActor::FindConnection(APartActor* PartA, APartActor* PartB)
+FAssemblyConnectionHandle AAssemblyActor::AddConnectionRecord(FPartConnection&& Connection)
 {
-	if (!PartA  || !PartB) return FPartConnection(); //return invalid connection
+	int32 SlotIndex;
+	if (FreeConnectionSlots.Num() > 0)
+	{
+		SlotIndex = FreeConnectionSlots.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		SlotIndex = ConnectionSlots.AddDefaulted();
+	}
 
-	for (const FPartConnection& Connection : Connections)
+	FConnectionSlot& Slot = ConnectionSlots[SlotIndex];
+	FAssemblyConnectionHandle Handle;
+	Handle.Index = SlotIndex;
+	Handle.Generation = Slot.Generation;
+
+	Connection.Handle = Handle;
+	Slot.DenseIndex = Connections.Add(MoveTemp(Connection));
+
+	const FPartConnection& Stored = Connections[Slot.DenseIndex];
+	if (ShouldReplicateConnections())
 	{
-		if ((Connection.PartA == PartA && Connection.PartB == PartB) ||
-			(Connection.PartA == PartB && Connection.PartB == PartA))
-		{
-			return Connection;
-		}
+		AddReplicatedConnection(Stored);
+	}
+	AddAdjacency(Stored.PartA, Handle);
+	if (Stored.PartB != Stored.PartA)
+	{
+		AddAdjacency(Stored.PartB, Handle);
 	}
-	return FPartConnection(); // return invalid connection	
+	UpdatePartMovementReplication(Stored.PartA, Stored.PartB);
+	SubAssemblies.Connect(Stored.PartA, Stored.PartB);
+	LessonMatcher.OnConnected(Handle.Index,
+		Stored.PartA ? Stored.PartA->GetClass() : nullptr, Stored.SnapPointA ? Stored.SnapPointA->SnapID : NAME_None,
+		Stored.PartB ? Stored.PartB->GetClass() : nullptr, Stored.SnapPointB ? Stored.SnapPointB->SnapID : NAME_None);
+	if (Stored.bIsWelded)
+	{
+		WeldGroups.Connect(Stored.PartA, Stored.PartB);
+		RebuildWeldGroup(Stored.PartA);
+	}
+	return Handle;
 }
 
-bool AAssemblyActor::HasConnection(APartActor* PartA, APartActor* PartB) const
+void AAssemblyActor::RemoveConnectionRecord(FAssemblyConnectionHandle Handle)
 {
-	if (!PartA || !PartB) return false;
+	if (!ResolveConnection(Handle))
+	{
+		return;
+	}
 
-	for (const FPartConnection& Connection : Connections)
+	if (ShouldReplicateConnections())
+	{
+		RemoveReplicatedConnection(Handle);
+	}
+
+	FConnectionSlot& Slot = ConnectionSlots[Handle.Index];
+	const int32 DenseIndex = Slot.DenseIndex;
+	APartActor* PartA = Connections[DenseIndex].PartA;
+	APartActor* PartB = Connections[DenseIndex].PartB;
+	const bool bWasWelded = Connections[DenseIndex].bIsWelded;
+	RemoveAdjacency(PartA, Handle);
+	RemoveAdjacency(PartB, Handle);
+	UpdatePartMovementReplication(PartA, PartB);
+	LessonMatcher.OnDisconnected(Handle.Index);
+
+	// Swap the last record into the hole and repoint its slot
+	Connections.RemoveAtSwap(DenseIndex, 1, EAllowShrinking::No);
+	if (Connections.IsValidIndex(DenseIndex))
+	{
+		ConnectionSlots[Connections[DenseIndex].Handle.Index].DenseIndex = DenseIndex;
+	}
+
+	Slot.DenseIndex = INDEX_NONE;
+	++Slot.Generation;
+	FreeConnectionSlots.Add(Handle.Index);
+
+	// Adjacency no longer has this connection, so the split search sees the graph as it now is
+	SubAssemblies.Disconnect(PartA, PartB, [this](APartActor* Part, FSubAssemblyTracker::FNeighborArray& OutNeighbors)
 	{
-		if ((Connection.PartA == PartA && Connection.PartB == PartB) ||
-			(Connection.PartA == PartB && Connection.PartB == PartA))
+		for (const FAssemblyConnectionHandle& Adjacent : GetConnectionHandles(Part))
 		{
-			return true;
+			if (const FPartConnection* Connection = ResolveConnection(Adjacent))
+			{
+				OutNeighbors.Add(Connection->PartA == Part ? Connection->PartB : Connection->PartA);
+			}
+		}
+	});
+
+	if (bWasWelded)
+	{
+		WeldGroups.Disconnect(PartA, PartB, [this](APartActor* Part, FSubAssemblyTracker::FNeighborArray& OutNeighbors)
+		{
+			for (const FAssemblyConnectionHandle& Adjacent : GetConnectionHandles(Part))
+			{
+				const FPartConnection* Connection = ResolveConnection(Adjacent);
+				if (Connection && Connection->bIsWelded)
+				{
+					OutNeighbors.Add(Connection->PartA == Part ? Connection->PartB : Connection->PartA);
+				}
+			}
+		});
+		RebuildWeldGroup(PartA);
+		if (!WeldGroups.AreConnected(PartA, PartB))
+		{
+			RebuildWeldGroup(PartB);
 		}
 	}
-	return false;
 }
 
-bool AAssemblyActor::ArePartsConnected(APartActor* PartA, APartActor* PartB) const
+void AAssemblyActor::AddAdjacency(const APartActor* Part, FAssemblyConnectionHandle Handle)
 {
-	return HasConnection(PartA, PartB);
+	PartAdjacency.FindOrAdd(Part).Add(Handle);
 }
 
-TArray<APartActor*> AAssemblyActor::GetConnectedParts(APartActor* Part) const
+void AAssemblyActor::RemoveAdjacency(const APartActor* Part, FAssemblyConnectionHandle Handle)
 {
-	TArray<APartActor*> ConnectedParts;
-	if (!Part) return ConnectedParts;
+	if (TArray<FAssemblyConnectionHandle>* Adjacent = PartAdjacency.Find(Part))
+	{
+		Adjacent->RemoveSwap(Handle, EAllowShrinking::No);
+	}
+}
 
-	for (const FPartConnection& Connection : Connections)
+void AAssemblyActor::UpdatePartMovementReplication(APartActor* PartA, APartActor* PartB) const
+{
+	if (!HasAuthority())
 	{
-		if (Connection.PartA == Part && Connection.PartB)
-		{
-			ConnectedParts.Add(Connection.PartB);
-		}
-		else if (Connection.PartB == Part && Connection.PartA)
+		return;
+	}
+	for (APartActor* Part : { PartA, PartB })
+	{
+		// Only parts that snap into this assembly decide from its connections
+		if (IsValid(Part) && Part->GetAssemblyActor() == this)
 		{
-			ConnectedParts.Add(Connection.PartA);
+			Part->UpdateMovementReplication();
 		}
 	}
-	return ConnectedParts;
 }
 
-// ================== PHYSICS CONSTRAINT CREATION ==================
-
-UPhysicsConstraintComponent* AAssemblyActor::CreateConstraintBetweenParts(APartActor* PartA, USnapPointComponent* SnapPointA, 
-	APartActor* PartB, USnapPointComponent* SnapPointB)
+const FPartConnection* AAssemblyActor::ResolveConnection(FAssemblyConnectionHandle Handle) const
 {
-	if (!PartA || !PartB || !SnapPointA || !SnapPointB)
+	if (!ConnectionSlots.IsValidIndex(Handle.Index))
 	{
-		UE_LOG(LogTemp, Error, TEXT("AAssemblyActor::CreateConstraintBetweenParts: Invalid parameters"));
 		return nullptr;
 	}
+	const FConnectionSlot& Slot = ConnectionSlots[Handle.Index];
+	if (Slot.Generation != Handle.Generation || Slot.DenseIndex == INDEX_NONE)
+	{
+		return nullptr;
+	}
+	return &Connections[Slot.DenseIndex];
+}
 
-	// Create constraint component
-	const FString ConstraintName = FString::Printf(TEXT("Constraint_%s_%s"), 
-	                                               *PartA->GetName(), *PartB->GetName());
-    
-	UPhysicsConstraintComponent* Constraint = NewObject<UPhysicsConstraintComponent>(this, 
-																				   UPhysicsConstraintComponent::StaticClass(), *ConstraintName);
-	// attach to root component
-	Constraint->AttachToComponent(RootComponent, FAttachmentTransformRules::KeepWorldTransform);
+TConstArrayView<FAssemblyConnectionHandle> AAssemblyActor::GetConnectionHandles(const APartActor* Part) const
+{
+	const TArray<FAssemblyConnectionHandle>* Adjacent = PartAdjacency.Find(Part);
+	return Adjacent ? TConstArrayView<FAssemblyConnectionHandle>(*Adjacent) : TConstArrayView<FAssemblyConnectionHandle>();
+}
 
-	// set constraint bodies
-	Constraint->SetConstrainedComponents(PartA->Mesh, NAME_None, PartB->Mesh, NAME_None);
+// ================== NETWORKING ==================
 
-	//configure constraint type based on snap point metadata
-	ConfigureConstraintType(Constraint, SnapPointA, SnapPointB);
+bool AAssemblyActor::RequestConnect(APartActor* PartA, APartActor* PartB, USnapPointComponent* SnapPointA, USnapPointComponent* SnapPointB)
+{
+	if (HasAuthority())
+	{
+		return ConnectParts(PartA, PartB, SnapPointA, SnapPointB);
+	}
 
-	// set constraint location (midpoint between snap points)
-	const FVector ConstraintLocation = (SnapPointA->GetComponentLocation() + SnapPointB->GetComponentLocation()) * 0.5f;
-	Constraint->SetWorldLocation(ConstraintLocation);
+	UAssemblyNetComponent* NetComponent = UAssemblyNetComponent::FindLocal(this);
+	if (!NetComponent)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("AAssemblyActor::RequestConnect: No UAssemblyNetComponent on the local player controller yet"));
+		return false;
+	}
 
-	PhysicalConstraints.Add(Constraint);
+	// Predict: snap now and let the server's replicated connection confirm it
+	if (!ConnectParts(PartA, PartB, SnapPointA, SnapPointB))
+	{
+		return false;
+	}
 
-	UE_LOG(LogTemp, Log, TEXT("AAssemblyActor::CreateConstraintBetweenParts: Created constraint between %s and %s"), 
-		   *PartA->GetName(), *PartB->GetName());
-    
-	return Constraint;
+	FPredictedConnect& Prediction = PredictedConnects.AddDefaulted_GetRef();
+	Prediction.Id = ++NextPredictionId;
+	Prediction.Handle = FindConnectionBySnapPoints(SnapPointA, SnapPointB);
 
+	NetComponent->ServerRequestConnect(this, PartA, PartB, SnapPointA, SnapPointB, Prediction.Id);
+	AssemblyNetStats::RecordConnectRequest();
+	return true;
 }
 
-void AAssemblyActor::ConfigureConstraintType(UPhysicsConstraintComponent* Constraint, 
-											USnapPointComponent* SnapPointA, 
-											USnapPointComponent* SnapPointB)
+bool AAssemblyActor::RequestDisconnect(APartActor* PartA, APartActor* PartB)
 {
-	if (!Constraint || !SnapPointA || !SnapPointB) return;
+	if (HasAuthority())
+	{
+		return DisconnectParts(PartA, PartB);
+	}
+
+	UAssemblyNetComponent* NetComponent = UAssemblyNetComponent::FindLocal(this);
+	if (!NetComponent)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("AAssemblyActor::RequestDisconnect: No UAssemblyNetComponent on the local player controller yet"));
+		return false;
+	}
+	NetComponent->ServerRequestDisconnect(this, PartA, PartB);
+	return true;
+}
+
+bool AAssemblyActor::HandleConnectRequest(APartActor* PartA, APartActor* PartB, USnapPointComponent* SnapPointA,
+	USnapPointComponent* SnapPointB, const AActor* Requester)
+{
+	if (!SnapPointA || !SnapPointB)
+	{
+		return false;
+	}
+
+	if (!CanRequesterChange(PartA, PartB, Requester, TEXT("HandleConnectRequest")))
+	{
+		return false;
+	}
+
+	// Each snap point must belong to the part sent with it, or to this assembly on the base side
+	const AActor* OwnerA = PartA ? static_cast<const AActor*>(PartA) : this;
+	const AActor* OwnerB = PartB ? static_cast<const AActor*>(PartB) : this;
+	if (SnapPointA->GetOwner() != OwnerA || SnapPointB->GetOwner() != OwnerB)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("AAssemblyActor::HandleConnectRequest: Snap points do not belong to the parts sent"));
+		return false;
+	}
+
+	return ApplyConnection(PartA, PartB, SnapPointA, SnapPointB);
+}
+
+bool AAssemblyActor::HandleDisconnectRequest(APartActor* PartA, APartActor* PartB, const AActor* Requester)
+{
+	if (!CanRequesterChange(PartA, PartB, Requester, TEXT("HandleDisconnectRequest")))
+	{
+		return false;
+	}
+	return DisconnectParts(PartA, PartB);
+}
+
+bool AAssemblyActor::CanRequesterChange(const APartActor* PartA, const APartActor* PartB, const AActor* Requester, const TCHAR* Context) const
+{
+	// Only a player with a pawn in the world can reach a part
+	if (!Requester)
+	{
+		UE_LOG(LogTemp, Log, TEXT("AAssemblyActor::%s: no requesting pawn"), Context);
+		return false;
+	}
+
+	// A part in someone else's hand is theirs until they let go
+	for (const APartActor* Part : { PartA, PartB })
+	{
+		const AActor* HeldBy = Part && Part->HeldPartNet ? Part->HeldPartNet->GetHeldBy() : nullptr;
+		if (HeldBy && HeldBy != Requester)
+		{
+			UE_LOG(LogTemp, Log, TEXT("AAssemblyActor::%s: %s is held by %s"), Context, *Part->GetName(), *HeldBy->GetName());
+			return false;
+		}
+	}
+	return true;
+}
+
+void AAssemblyActor::HandleConnectRejected(int32 PredictionId)
+{
+	const int32 Index = PredictedConnects.IndexOfByPredicate([PredictionId](const FPredictedConnect& Prediction)
+	{
+		return Prediction.Id == PredictionId;
+	});
+	// Already undone if a conflicting connection from the server arrived first
+	if (Index == INDEX_NONE)
+	{
+		return;
+	}
+
+	const FPredictedConnect Prediction = PredictedConnects[Index];
+	PredictedConnects.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+	UndoPrediction(Prediction);
+}
+
+void AAssemblyActor::HandleReplicatedConnectionAdded(FReplicatedPartConnection& Item)
+{
+	if (HasAuthority())
+	{
+		return;
+	}
+
+	// A null part is the base only when the snap point is ours; otherwise its reference has not mapped yet
+	auto IsSideResolved = [this](const APartActor* Part, const USnapPointComponent* SnapPoint)
+	{
+		return SnapPoint && SnapPoint->GetOwner() == (Part ? static_cast<const AActor*>(Part) : this);
+	};
+	if (!HasActorBegunPlay() || !IsSideResolved(Item.PartA, Item.SnapPointA) || !IsSideResolved(Item.PartB, Item.SnapPointB))
+	{
+		Item.bPendingApply = true;
+		return;
+	}
+	Item.bPendingApply = false;
+
+	FAssemblyConnectionHandle Handle = FindConnectionBySnapPoints(Item.SnapPointA, Item.SnapPointB);
+	if (Handle.IsValid())
+	{
+		// Our prediction, confirmed
+		PredictedConnects.RemoveAll([Handle](const FPredictedConnect& Prediction) { return Prediction.Handle == Handle; });
+	}
+	else
+	{
+		// Predictions that used either snap point lost to this connection
+		for (int32 Index = PredictedConnects.Num() - 1; Index >= 0; --Index)
+		{
+			const FPartConnection* Predicted = ResolveConnection(PredictedConnects[Index].Handle);
+			if (!Predicted ||
+				Predicted->SnapPointA == Item.SnapPointA || Predicted->SnapPointA == Item.SnapPointB ||
+				Predicted->SnapPointB == Item.SnapPointA || Predicted->SnapPointB == Item.SnapPointB)
+			{
+				const FPredictedConnect Prediction = PredictedConnects[Index];
+				PredictedConnects.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+				UndoPrediction(Prediction);
+			}
+		}
+
+		if (!ApplyConnection(Item.PartA, Item.PartB, Item.SnapPointA, Item.SnapPointB))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("AAssemblyActor::HandleReplicatedConnectionAdded: Could not apply the server's connection"));
+			return;
+		}
+		Handle = FindConnectionBySnapPoints(Item.SnapPointA, Item.SnapPointB);
+	}
+
+	Item.LocalHandleIndex = Handle.Index;
+	Item.LocalHandleGeneration = Handle.Generation;
+}
+
+void AAssemblyActor::HandleReplicatedConnectionRemoved(const FReplicatedPartConnection& Item)
+{
+	if (HasAuthority())
+	{
+		return;
+	}
+
+	FAssemblyConnectionHandle Handle;
+	Handle.Index = Item.LocalHandleIndex;
+	Handle.Generation = Item.LocalHandleGeneration;
+	if (ResolveConnection(Handle))
+	{
+		DisconnectConnection(Handle);
+	}
+}
+
+void AAssemblyActor::ApplyPendingReplicatedConnections()
+{
+	for (FReplicatedPartConnection& Item : ReplicatedConnections.Items)
+	{
+		if (Item.bPendingApply)
+		{
+			HandleReplicatedConnectionAdded(Item);
+		}
+	}
+}
+
+bool AAssemblyActor::ApplyConnection(APartActor* PartA, APartActor* PartB, USnapPointComponent* SnapPointA, USnapPointComponent* SnapPointB)
+{
+	APartActor* Mover = PartA ? PartA : PartB;
+	USnapPointComponent* MoverSnapPoint = PartA ? SnapPointA : SnapPointB;
+	USnapPointComponent* TargetSnapPoint = PartA ? SnapPointB : SnapPointA;
+	if (!Mover || !MoverSnapPoint || !TargetSnapPoint)
+	{
+		return false;
+	}
+
+	// Replicated parts can be connected before they have begun play and baked their snap points
+	for (USnapPointComponent* SnapPoint : { MoverSnapPoint, TargetSnapPoint })
+	{
+		if (!SnapPoint->HasCachedTransform())
+		{
+			SnapPoint->RefreshCachedTransform();
+		}
+	}
+
+	const FTransform PreviousTransform = Mover->GetActorTransform();
+	Mover->SetActorTransform(Mover->CalculateSnapTransform(MoverSnapPoint, TargetSnapPoint));
+	if (!ConnectParts(PartA, PartB, SnapPointA, SnapPointB))
+	{
+		Mover->SetActorTransform(PreviousTransform);
+		return false;
+	}
+
+	Mover->SetSnappedPhysics(true);
+	return true;
+}
+
+void AAssemblyActor::UndoPrediction(const FPredictedConnect& Prediction)
+{
+	const FPartConnection* Connection = ResolveConnection(Prediction.Handle);
+	if (!Connection)
+	{
+		return;
+	}
+
+	APartActor* Mover = Connection->PartA ? Connection->PartA.Get() : Connection->PartB.Get();
+	UE_LOG(LogTemp, Log, TEXT("AAssemblyActor: Server rejected the connect of %s, undoing it"), Mover ? *Mover->GetName() : TEXT("none"));
+
+	DisconnectConnection(Prediction.Handle);
+	if (Mover)
+	{
+		Mover->SetSnappedPhysics(false);
+	}
+}
+
+FAssemblyConnectionHandle AAssemblyActor::FindConnectionBySnapPoints(const USnapPointComponent* SnapPointA, const USnapPointComponent* SnapPointB) const
+{
+	if (!SnapPointA || !SnapPointB)
+	{
+		return FAssemblyConnectionHandle();
+	}
+
+	// Walk a part side's connections; nullptr (both sides on the base) walks the base connections
+	const APartActor* Part = Cast<APartActor>(SnapPointA->GetOwner());
+	if (!Part)
+	{
+		Part = Cast<APartActor>(SnapPointB->GetOwner());
+	}
+
+	for (const FAssemblyConnectionHandle& Handle : GetConnectionHandles(Part))
+	{
+		const FPartConnection* Connection = ResolveConnection(Handle);
+		if (Connection &&
+			((Connection->SnapPointA == SnapPointA && Connection->SnapPointB == SnapPointB) ||
+			 (Connection->SnapPointA == SnapPointB && Connection->SnapPointB == SnapPointA)))
+		{
+			return Handle;
+		}
+	}
+	return FAssemblyConnectionHandle();
+}
+
+bool AAssemblyActor::ShouldReplicateConnections() const
+{
+	return HasAuthority() && GetNetMode() != NM_Standalone;
+}
+
+void AAssemblyActor::AddReplicatedConnection(const FPartConnection& Connection)
+{
+	const int32 SlotIndex = Connection.Handle.Index;
+	if (SlotIndex >= ReplicatedItemBySlot.Num())
+	{
+		const int32 OldNum = ReplicatedItemBySlot.Num();
+		ReplicatedItemBySlot.SetNumUninitialized(SlotIndex + 1);
+		for (int32 Index = OldNum; Index <= SlotIndex; ++Index)
+		{
+			ReplicatedItemBySlot[Index] = INDEX_NONE;
+		}
+	}
+
+	FReplicatedPartConnection& Item = ReplicatedConnections.Items.AddDefaulted_GetRef();
+	Item.PartA = Connection.PartA;
+	Item.PartB = Connection.PartB;
+	Item.SnapPointA = Connection.SnapPointA;
+	Item.SnapPointB = Connection.SnapPointB;
+	Item.LocalHandleIndex = SlotIndex;
+	Item.LocalHandleGeneration = Connection.Handle.Generation;
+	ReplicatedItemBySlot[SlotIndex] = ReplicatedConnections.Items.Num() - 1;
+
+	ReplicatedConnections.MarkItemDirty(Item);
+	ForceNetUpdate();
+}
+
+void AAssemblyActor::RemoveReplicatedConnection(FAssemblyConnectionHandle Handle)
+{
+	if (!ReplicatedItemBySlot.IsValidIndex(Handle.Index))
+	{
+		return;
+	}
+	const int32 ItemIndex = ReplicatedItemBySlot[Handle.Index];
+	TArray<FReplicatedPartConnection>& Items = ReplicatedConnections.Items;
+	if (!Items.IsValidIndex(ItemIndex))
+	{
+		return;
+	}
+
+	// Order does not matter to a fast array; swap the last item into the hole
+	ReplicatedItemBySlot[Handle.Index] = INDEX_NONE;
+	Items.RemoveAtSwap(ItemIndex, 1, EAllowShrinking::No);
+	if (Items.IsValidIndex(ItemIndex))
+	{
+		ReplicatedItemBySlot[Items[ItemIndex].LocalHandleIndex] = ItemIndex;
+	}
+
+	ReplicatedConnections.MarkArrayDirty();
+	ForceNetUpdate();
+}
+
+void AAssemblyActor::HandlePostLogin(AGameModeBase* GameMode, APlayerController* NewPlayer)
+{
+	if (NewPlayer && NewPlayer->GetWorld() == GetWorld())
+	{
+		UAssemblyNetComponent::FindOrAdd(NewPlayer);
+	}
+}
+
+// ================== ASSEMBLY STATE MANAGEMENT ==================
+
+bool AAssemblyActor::IsFullyAssembled() const
+{
+	if (LessonMatcher.IsActive())
+	{
+		const FLessonProgress Progress = LessonMatcher.GetProgress();
+		return Progress.Missing == 0 && Progress.Incorrect == 0;
+	}
+
+	return (Parts.Num() >= ExpectedPartCount) && (Connections.Num() >= ExpectedConnectionCount) &&
+		(AssemblyState == EAssemblyState::FullyAssembled);
+}
+
+float AAssemblyActor::GetAssemblyProgress() const
+{
+	// Only correct connections count; a wrong one is progress toward nothing
+	if (LessonMatcher.IsActive())
+	{
+		const FLessonProgress Progress = LessonMatcher.GetProgress();
+		return Progress.Expected > 0 ? FMath::Clamp(static_cast<float>(Progress.Correct) / Progress.Expected, 0.0f, 1.0f) : 0.0f;
+	}
+
+	if (ExpectedPartCount == 0 && ExpectedConnectionCount == 0)
+	{
+		return 0.0f;
+	}
+
+	// Calculate progress based on both parts and connections
+	const float PartProgress = ExpectedPartCount > 0 ? 
+		                           static_cast<float>(Parts.Num()) / static_cast<float>(ExpectedPartCount) : 1.0f;
+
+	const float ConnectionProgress = ExpectedConnectionCount > 0 ? 
+		                                 static_cast<float>(Connections.Num()) / static_cast<float>(ExpectedConnectionCount) : 1.0f;
+    
+	// Weight parts and connections equally
+	const float TotalProgress = (PartProgress + ConnectionProgress) * 0.5f;
+    
+	// Clamp to 0-1 range
+	return FMath::Clamp(TotalProgress, 0.0f, 1.0f);
+}
+// ================== LESSON ==================
+
+void AAssemblyActor::SetLesson(ULessonData* NewLesson)
+{
+	Lesson = NewLesson;
+	LessonMatcher.Compile(Lesson);
+
+	for (const FPartConnection& Connection : Connections)
+	{
+		LessonMatcher.OnConnected(Connection.Handle.Index,
+			Connection.PartA ? Connection.PartA->GetClass() : nullptr, Connection.SnapPointA ? Connection.SnapPointA->SnapID : NAME_None,
+			Connection.PartB ? Connection.PartB->GetClass() : nullptr, Connection.SnapPointB ? Connection.SnapPointB->SnapID : NAME_None);
+	}
+
+	RequestStateUpdate();
+}
+
+bool AAssemblyActor::IsConnectionCorrect(FAssemblyConnectionHandle Handle) const
+{
+	return ResolveConnection(Handle) && LessonMatcher.IsConnectionCorrect(Handle.Index);
+}
+
+TArray<FAssemblyConnectionHandle> AAssemblyActor::GetIncorrectConnections() const
+{
+	TArray<int32> Ids;
+	LessonMatcher.GetIncorrectConnectionIds(Ids);
+
+	TArray<FAssemblyConnectionHandle> Handles;
+	Handles.Reserve(Ids.Num());
+	for (const int32 Id : Ids)
+	{
+		FAssemblyConnectionHandle& Handle = Handles.AddDefaulted_GetRef();
+		Handle.Index = Id;
+		Handle.Generation = ConnectionSlots[Id].Generation;
+	}
+	return Handles;
+}
+
+TArray<FLessonConnection> AAssemblyActor::GetMissingConnections() const
+{
+	TArray<FLessonConnection> Missing;
+	LessonMatcher.GetMissingConnections(Missing);
+	return Missing;
+}
+
+void AAssemblyActor::UpdateAssemblyState()
+{
+	ASSEMBLY_SCOPE_CYCLE_COUNTER(UpdateAssemblyState);
+
+	EAssemblyState PreviousState = AssemblyState;
+
+	//determine new state
+	if (Parts.Num() == 0)
+	{
+		AssemblyState = EAssemblyState::Empty;
+	}
+	else if (IsFullyAssembled())
+	{
+		AssemblyState = EAssemblyState::FullyAssembled;
+	}
+	else
+	{
+		AssemblyState = EAssemblyState::PartiallyAssembled;
+	}
+
+	// fire event if state changed
+	if (AssemblyState != PreviousState)
+	{
+		OnAssemblyStateChanged.Broadcast(AssemblyState);
+		UE_LOG(LogTemp, Log, TEXT("AAssemblyActor::UpdateAssemblyState: State changed to %d. Parts: %d/%d, Connections: %d/%d"), 
+			   static_cast<int32>(AssemblyState), Parts.Num(), ExpectedPartCount, 
+			   Connections.Num(), ExpectedConnectionCount);
+	}
+}
+
+
+// ================== CONNECTION QUERIES ==================
+FPartConnection AAssemblyActor::FindConnection(APartActor* PartA, APartActor* PartB)
+{
+	const FPartConnection* Connection = FindConnectionPtr(PartA, PartB);
+	return Connection ? *Connection : FPartConnection(); // return invalid connection if none
+}
+
+const FPartConnection* AAssemblyActor::FindConnectionPtr(const APartActor* PartA, const APartActor* PartB) const
+{
+	if (!PartA || !PartB) return nullptr;
+
+	// Walk whichever part has fewer connections
+	TConstArrayView<FAssemblyConnectionHandle> Handles = GetConnectionHandles(PartA);
+	const APartActor* Other = PartB;
+	TConstArrayView<FAssemblyConnectionHandle> HandlesB = GetConnectionHandles(PartB);
+	if (HandlesB.Num() < Handles.Num())
+	{
+		Handles = HandlesB;
+		Other = PartA;
+	}
+
+	for (const FAssemblyConnectionHandle& Handle : Handles)
+	{
+		const FPartConnection* Connection = ResolveConnection(Handle);
+		if (Connection && (Connection->PartA == Other || Connection->PartB == Other))
+		{
+			return Connection;
+		}
+	}
+	return nullptr;
+}
+
+FAssemblyConnectionHandle AAssemblyActor::FindConnectionHandle(APartActor* PartA, APartActor* PartB) const
+{
+	const FPartConnection* Connection = FindConnectionPtr(PartA, PartB);
+	return Connection ? Connection->Handle : FAssemblyConnectionHandle();
+}
+
+bool AAssemblyActor::GetConnectionByHandle(FAssemblyConnectionHandle Handle, FPartConnection& OutConnection) const
+{
+	if (const FPartConnection* Connection = ResolveConnection(Handle))
+	{
+		OutConnection = *Connection;
+		return true;
+	}
+	return false;
+}
+
+bool AAssemblyActor::HasConnection(APartActor* PartA, APartActor* PartB) const
+{
+	return FindConnectionPtr(PartA, PartB) != nullptr;
+}
+
+bool AAssemblyActor::ArePartsConnected(APartActor* PartA, APartActor* PartB) const
+{
+	return HasConnection(PartA, PartB);
+}
+
+TArray<APartActor*> AAssemblyActor::GetConnectedParts(APartActor* Part) const
+{
+	TArray<APartActor*> ConnectedParts;
+	if (!Part) return ConnectedParts;
+
+	TConstArrayView<FAssemblyConnectionHandle> Handles = GetConnectionHandles(Part);
+	ConnectedParts.Reserve(Handles.Num());
+	for (const FAssemblyConnectionHandle& Handle : Handles)
+	{
+		const FPartConnection* Connection = ResolveConnection(Handle);
+		if (!Connection)
+		{
+			continue;
+		}
+		if (Connection->PartA == Part && Connection->PartB)
+		{
+			ConnectedParts.Add(Connection->PartB);
+		}
+		else if (Connection->PartB == Part && Connection->PartA)
+		{
+			ConnectedParts.Add(Connection->PartA);
+		}
+	}
+	return ConnectedParts;
+}
+
+// ================== SUB-ASSEMBLY QUERIES ==================
+
+int32 AAssemblyActor::GetSubAssemblyId(APartActor* Part) const
+{
+	return Part ? SubAssemblies.GetComponentId(Part) : INDEX_NONE;
+}
+
+bool AAssemblyActor::IsPartGrounded(APartActor* Part) const
+{
+	return Part && SubAssemblies.IsGrounded(Part);
+}
+
+bool AAssemblyActor::AreInSameSubAssembly(APartActor* PartA, APartActor* PartB) const
+{
+	return PartA && PartB && SubAssemblies.AreConnected(PartA, PartB);
+}
+
+TArray<APartActor*> AAssemblyActor::GetSubAssemblyParts(APartActor* Part) const
+{
+	TArray<APartActor*> Members;
+	if (Part)
+	{
+		SubAssemblies.GetComponentMembers(Part, Members);
+	}
+	return Members;
+}
+
+TArray<APartActor*> AAssemblyActor::GetWeldedParts(APartActor* Part) const
+{
+	TArray<APartActor*> Members;
+	if (Part)
+	{
+		WeldGroups.GetComponentMembers(Part, Members);
+		if (Members.Num() == 0)
+		{
+			Members.Add(Part);
+		}
+	}
+	return Members;
+}
+
+int32 AAssemblyActor::GetNumRigidBodies() const
+{
+	// Parts never welded are a body each, every weld group is one more
+	return Parts.Num() - WeldGroups.GetNumParts() + WeldGroups.GetNumComponents();
+}
+
+// ================== WELDING ==================
+
+void AAssemblyActor::RebuildWeldGroup(APartActor* Part)
+{
+	if (!IsValid(Part) || !Part->Mesh)
+	{
+		return;
+	}
+
+	TArray<APartActor*, TInlineAllocator<16>> Members;
+	WeldGroups.ForEachComponentMember(Part, [&Members](APartActor* Member)
+	{
+		if (IsValid(Member) && Member->Mesh)
+		{
+			Members.Add(Member);
+		}
+	});
+	if (Members.Num() == 0)
+	{
+		Members.Add(Part);
+	}
+
+	auto WeldedToPart = [](const UPrimitiveComponent* Mesh) -> APartActor*
+	{
+		const USceneComponent* Parent = Mesh->GetAttachParent();
+		APartActor* ParentPart = Parent ? Cast<APartActor>(Parent->GetOwner()) : nullptr;
+		return ParentPart && ParentPart->Mesh == Parent ? ParentPart : nullptr;
+	};
+
+	// Keep the current root body if there is one, so only the parts that changed group move
+	APartActor* Root = Members[0];
+	for (APartActor* Member : Members)
+	{
+		if (!Members.Contains(WeldedToPart(Member->Mesh)))
+		{
+			Root = Member;
+			break;
+		}
+	}
+
+	const FDetachmentTransformRules DetachRules(FDetachmentTransformRules::KeepWorldTransform);
+	const FAttachmentTransformRules WeldRules(EAttachmentRule::KeepWorld, /*bWeldSimulatedBodies*/ true);
+	bool bChanged = false;
+
+	// Root is still welded into a group it has left
+	if (WeldedToPart(Root->Mesh))
+	{
+		Root->Mesh->DetachFromComponent(DetachRules);
+		bChanged = true;
+	}
+
+	for (APartActor* Member : Members)
+	{
+		if (Member == Root || Member->Mesh->GetAttachParent() == Root->Mesh)
+		{
+			continue;
+		}
+		if (WeldedToPart(Member->Mesh))
+		{
+			Member->Mesh->DetachFromComponent(DetachRules);
+		}
+		Member->Mesh->AttachToComponent(Root->Mesh, WeldRules);
+		bChanged = true;
+	}
+
+	if (bChanged)
+	{
+		// Welding and unwelding edit the root's shapes; recompute mass and inertia for the new set
+		if (FBodyInstance* RootBody = Root->Mesh->GetBodyInstance())
+		{
+			RootBody->UpdateMassProperties();
+		}
+		UE_LOG(LogTemp, Verbose, TEXT("AAssemblyActor::RebuildWeldGroup: %s is the root of %d welded parts"),
+			*Root->GetName(), Members.Num());
+	}
+}
+
+// ================== PHYSICS CONSTRAINT CREATION ==================
+
+UPhysicsConstraintComponent* AAssemblyActor::CreateConstraintBetweenParts(APartActor* PartA, USnapPointComponent* SnapPointA, 
+	APartActor* PartB, USnapPointComponent* SnapPointB)
+{
+	if (!PartA || !PartB || !SnapPointA || !SnapPointB)
+	{
+		UE_LOG(LogTemp, Error, TEXT("AAssemblyActor::CreateConstraintBetweenParts: Invalid parameters"));
+		return nullptr;
+	}
+
+	// Reuse a pooled constraint component
+	UPhysicsConstraintComponent* Constraint = AcquireConstraint();
 
-	// parse metadata to determine constraint type
-	FString MetadataA = SnapPointA->Metadata.ToLower();
-	FString MetadataB = SnapPointB->Metadata.ToLower();
-
-	// Default to fixed constraint
-    Constraint->SetLinearXLimit(ELinearConstraintMotion::LCM_Locked, 0.0f);
-    Constraint->SetLinearYLimit(ELinearConstraintMotion::LCM_Locked, 0.0f);
-    Constraint->SetLinearZLimit(ELinearConstraintMotion::LCM_Locked, 0.0f);
-    Constraint->SetAngularSwing1Limit(EAngularConstraintMotion::ACM_Locked, 0.0f);
-    Constraint->SetAngularSwing2Limit(EAngularConstraintMotion::ACM_Locked, 0.0f);
-    Constraint->SetAngularTwistLimit(EAngularConstraintMotion::ACM_Locked, 0.0f);
+	// set constraint location (midpoint between snap points), the joint frames are taken from it on bind
+	const FVector ConstraintLocation = (SnapPointA->GetComponentLocation() + SnapPointB->GetComponentLocation()) * 0.5f;
+	Constraint->SetWorldLocation(ConstraintLocation);
+
+	//configure constraint type based on snap point metadata. Sets every limit, so nothing leaks from the last use.
+	ConfigureConstraintType(Constraint, SnapPointA, SnapPointB);
+
+	// set constraint bodies, this creates the joint
+	Constraint->SetConstrainedComponents(PartA->Mesh, NAME_None, PartB->Mesh, NAME_None);
+
+	PhysicalConstraints.Add(Constraint);
+
+	UE_LOG(LogTemp, Verbose, TEXT("AAssemblyActor::CreateConstraintBetweenParts: Bound constraint between %s and %s"), 
+		   *PartA->GetName(), *PartB->GetName());
     
-    // Check for specific constraint types in metadata
-    if (MetadataA.Contains("hinge") || MetadataB.Contains("hinge") ||
-        MetadataA.Contains("rotate") || MetadataB.Contains("rotate") ||
-        MetadataA.Contains("shaft") || MetadataB.Contains("shaft"))
-    {
-        // Allow rotation around one axis (typically Z for motors)
-        Constraint->SetAngularTwistLimit(EAngularConstraintMotion::ACM_Free, 0.0f);
-        
-        UE_LOG(LogTemp, Log, TEXT("AAssemblyActor::ConfigureConstraintType: Set hinge constraint"));
-    }
-    else if (MetadataA.Contains("slide") || MetadataB.Contains("slide") ||
-             MetadataA.Contains("prismatic") || MetadataB.Contains("prismatic"))
-    {
-        // Allow linear motion along one axis
-        Constraint->SetLinearZLimit(ELinearConstraintMotion::LCM_Free, 0.0f);
-        
-        UE_LOG(LogTemp, Log, TEXT("AAssemblyActor::ConfigureConstraintType: Set prismatic constraint"));
-    }
-    else
-    {
-        UE_LOG(LogTemp, Log, TEXT("AAssemblyActor::ConfigureConstraintType: Set fixed constraint"));
-    }
+	return Constraint;
+
+}
+
+const FSnapConstraintProfile& AAssemblyActor::ResolveConstraintProfile(const USnapPointComponent* SnapPointA,
+	const USnapPointComponent* SnapPointB, const USnapPointComponent*& OutAxisSource) const
+{
+	check(SnapPointA && SnapPointB);
+	const FSnapConstraintProfile& ProfileA = SnapPointA->GetConstraintProfile();
+	const FSnapConstraintProfile& ProfileB = SnapPointB->GetConstraintProfile();
+
+	for (const EAssemblyJointType JointType : { EAssemblyJointType::Hinge, EAssemblyJointType::Prismatic })
+	{
+		if (ProfileA.JointType == JointType)
+		{
+			OutAxisSource = SnapPointA;
+			return ProfileA;
+		}
+		if (ProfileB.JointType == JointType)
+		{
+			OutAxisSource = SnapPointB;
+			return ProfileB;
+		}
+	}
+
+	// Both fixed; a breakable side makes the joint breakable
+	OutAxisSource = ProfileB.bBreakable && !ProfileA.bBreakable ? SnapPointB : SnapPointA;
+	return OutAxisSource == SnapPointA ? ProfileA : ProfileB;
+}
+
+void AAssemblyActor::ConfigureConstraintType(UPhysicsConstraintComponent* Constraint, 
+											USnapPointComponent* SnapPointA, 
+											USnapPointComponent* SnapPointB)
+{
+	if (!Constraint || !SnapPointA || !SnapPointB) return;
+
+	const USnapPointComponent* AxisSource = nullptr;
+	const FSnapConstraintProfile& Profile = ResolveConstraintProfile(SnapPointA, SnapPointB, AxisSource);
+
+	// Default to fixed constraint, and clear anything a pooled constraint kept from its last use
+	Constraint->SetLinearXLimit(ELinearConstraintMotion::LCM_Locked, 0.0f);
+	Constraint->SetLinearYLimit(ELinearConstraintMotion::LCM_Locked, 0.0f);
+	Constraint->SetLinearZLimit(ELinearConstraintMotion::LCM_Locked, 0.0f);
+	Constraint->SetAngularSwing1Limit(EAngularConstraintMotion::ACM_Locked, 0.0f);
+	Constraint->SetAngularSwing2Limit(EAngularConstraintMotion::ACM_Locked, 0.0f);
+	Constraint->SetAngularTwistLimit(EAngularConstraintMotion::ACM_Locked, 0.0f);
+	Constraint->SetLinearVelocityDrive(false, false, false);
+	Constraint->SetAngularVelocityDriveTwistAndSwing(false, false);
+	Constraint->SetLinearBreakable(Profile.bBreakable, Profile.LinearBreakThreshold);
+	Constraint->SetAngularBreakable(Profile.bBreakable, Profile.AngularBreakThreshold);
+
+	if (Profile.JointType == EAssemblyJointType::Fixed)
+	{
+		Constraint->SetRelativeRotation(FRotator::ZeroRotator);
+		UE_LOG(LogTemp, Verbose, TEXT("AAssemblyActor::ConfigureConstraintType: Set fixed constraint"));
+		return;
+	}
+
+	// The constraint's X axis is both the twist axis and the free linear axis, point it along the profile axis
+	const FVector WorldAxis = AxisSource->GetComponentTransform().TransformVectorNoScale(Profile.Axis.GetSafeNormal(UE_SMALL_NUMBER, FVector::ForwardVector));
+	Constraint->SetWorldRotation(FRotationMatrix::MakeFromX(WorldAxis).Rotator());
+
+	if (Profile.JointType == EAssemblyJointType::Hinge)
+	{
+		Constraint->SetAngularTwistLimit(Profile.bLimited ? EAngularConstraintMotion::ACM_Limited : EAngularConstraintMotion::ACM_Free, Profile.Limit);
+		if (Profile.bDriven)
+		{
+			Constraint->SetAngularDriveMode(EAngularDriveMode::TwistAndSwing);
+			Constraint->SetAngularVelocityDriveTwistAndSwing(true, false);
+			Constraint->SetAngularVelocityTarget(FVector(Profile.DriveTargetVelocity, 0.0f, 0.0f));
+			Constraint->SetAngularDriveParams(0.0f, Profile.DriveDamping, Profile.DriveMaxForce);
+		}
+		UE_LOG(LogTemp, Verbose, TEXT("AAssemblyActor::ConfigureConstraintType: Set hinge constraint"));
+	}
+	else
+	{
+		Constraint->SetLinearXLimit(Profile.bLimited ? ELinearConstraintMotion::LCM_Limited : ELinearConstraintMotion::LCM_Free, Profile.Limit);
+		if (Profile.bDriven)
+		{
+			Constraint->SetLinearVelocityDrive(true, false, false);
+			Constraint->SetLinearVelocityTarget(FVector(Profile.DriveTargetVelocity, 0.0f, 0.0f));
+			Constraint->SetLinearDriveParams(0.0f, Profile.DriveDamping, Profile.DriveMaxForce);
+		}
+		UE_LOG(LogTemp, Verbose, TEXT("AAssemblyActor::ConfigureConstraintType: Set prismatic constraint"));
+	}
+}
+
+// ================== CONSTRAINT POOL ==================
+
+void AAssemblyActor::PrewarmConstraintPool(int32 Count)
+{
+	while (PhysicalConstraints.Num() + FreeConstraints.Num() < Count)
+	{
+		FreeConstraints.Add(CreatePooledConstraint());
+		++ConstraintPoolStats.Prewarmed;
+	}
+}
+
+FConstraintPoolStats AAssemblyActor::GetConstraintPoolStats() const
+{
+	FConstraintPoolStats Stats = ConstraintPoolStats;
+	Stats.Active = PhysicalConstraints.Num();
+	Stats.Free = FreeConstraints.Num();
+	return Stats;
+}
+
+UPhysicsConstraintComponent* AAssemblyActor::CreatePooledConstraint()
+{
+	UPhysicsConstraintComponent* Constraint = NewObject<UPhysicsConstraintComponent>(this);
+	Constraint->SetupAttachment(RootComponent);
+	Constraint->RegisterComponent();
+	Constraint->OnConstraintBroken.AddDynamic(this, &AAssemblyActor::HandleConstraintBroken);
+	return Constraint;
+}
+
+UPhysicsConstraintComponent* AAssemblyActor::AcquireConstraint()
+{
+	while (FreeConstraints.Num() > 0)
+	{
+		UPhysicsConstraintComponent* Constraint = FreeConstraints.Pop(EAllowShrinking::No);
+		if (IsValid(Constraint))
+		{
+			++ConstraintPoolStats.Hits;
+			return Constraint;
+		}
+	}
+
+	++ConstraintPoolStats.Misses;
+	UE_LOG(LogTemp, Verbose, TEXT("AAssemblyActor::AcquireConstraint: Pool empty, creating constraint %d"),
+		PhysicalConstraints.Num() + 1);
+	return CreatePooledConstraint();
+}
+
+void AAssemblyActor::ReleaseConstraint(UPhysicsConstraintComponent* Constraint)
+{
+	PhysicalConstraints.Remove(Constraint);
+	if (!IsValid(Constraint))
+	{
+		return;
+	}
+
+	// Terminate the joint but keep the component; SetConstrainedComponents re-creates it on reuse
+	Constraint->BreakConstraint();
+	Constraint->ConstraintActor1 = nullptr;
+	Constraint->ConstraintActor2 = nullptr;
+	Constraint->ComponentName1 = FConstrainComponentPropName();
+	Constraint->ComponentName2 = FConstrainComponentPropName();
+	FreeConstraints.Add(Constraint);
+	++ConstraintPoolStats.Releases;
 }
 
 // ================== CLEANUP ==================
@@ -490,9 +1497,107 @@ void AAssemblyActor::CleanupInvalidConstraints()
 		return !IsValid(Constraint);
 	});
     
-	// Remove any connections with invalid constraints
-	Connections.RemoveAll([](const FPartConnection& Connection)
+	// Remove any connections whose parts went away or whose constraint was destroyed or broke.
+	// A connection without a constraint is normal (see bUsePhysicsConstraints), so keep those.
+	TArray<FAssemblyConnectionHandle, TInlineAllocator<8>> StaleConnections;
+	for (const FPartConnection& Connection : Connections)
 	{
-		return !IsValid(Connection.Constraint) || !IsValid(Connection.PartA) || !IsValid(Connection.PartB);
-	});
-}
\ No newline at end of file
+		// Only a base connection may have a null side, and only one; any other null is a part that went away
+		const int32 NumNullParts = (Connection.PartA == nullptr) + (Connection.PartB == nullptr);
+		const bool bPartsDestroyed = NumNullParts > (Connection.bIsBaseConnection ? 1 : 0) ||
+			(Connection.PartA && !IsValid(Connection.PartA)) || (Connection.PartB && !IsValid(Connection.PartB));
+		const bool bConstraintGone = Connection.Constraint && (!IsValid(Connection.Constraint) || Connection.Constraint->IsBroken());
+		if (bPartsDestroyed || bConstraintGone)
+		{
+			StaleConnections.Add(Connection.Handle);
+		}
+	}
+
+	TArray<APartActor*, TInlineAllocator<8>> DestroyedParts;
+	for (APartActor* Part : Parts)
+	{
+		if (!IsValid(Part))
+		{
+			DestroyedParts.Add(Part);
+		}
+	}
+
+	if (StaleConnections.Num() == 0 && DestroyedParts.Num() == 0)
+	{
+		return;
+	}
+
+	BeginChangeBatch();
+	for (const FAssemblyConnectionHandle& Handle : StaleConnections)
+	{
+		const FPartConnection* Connection = ResolveConnection(Handle);
+		if (!Connection)
+		{
+			continue;
+		}
+		if (Connection->Constraint)
+		{
+			// Broken joints, or a part went away but its constraint did not; keep the component for reuse
+			ReleaseConstraint(Connection->Constraint);
+		}
+		// Free the surviving side's snap point
+		for (USnapPointComponent* SnapPoint : { Connection->SnapPointA.Get(), Connection->SnapPointB.Get() })
+		{
+			if (IsValid(SnapPoint))
+			{
+				SnapPoint->SetIsAssembled(false);
+			}
+		}
+		if (PendingConnected.RemoveSwap(Handle, EAllowShrinking::No) == 0)
+		{
+			PendingDisconnected.Add(*Connection);
+		}
+		PendingPartEvents.Add(FPendingPartEvent{ Connection->PartA, Connection->PartB, false });
+		RemoveConnectionRecord(Handle);
+	}
+	for (APartActor* Part : DestroyedParts)
+	{
+		Parts.RemoveSingleSwap(Part, EAllowShrinking::No);
+		// The nullptr adjacency list holds the base's connections, so a cleared pointer must not drop it
+		if (Part)
+		{
+			PartAdjacency.Remove(Part);
+			SubAssemblies.RemovePart(Part);
+			WeldGroups.RemovePart(Part);
+		}
+	}
+	RequestStateUpdate();
+	EndChangeBatch();
+}
+
+void AAssemblyActor::RequestCleanup()
+{
+	if (UAssemblyTickSubsystem* TickSubsystem = UAssemblyTickSubsystem::Get(this))
+	{
+		TickSubsystem->MarkAssemblyDirty(this);
+	}
+	else
+	{
+		CleanupInvalidConstraints();
+	}
+}
+
+void AAssemblyActor::HandlePartDestroyed(AActor* DestroyedActor)
+{
+	// Take it out while its pointer is still valid; once it is gone its connections look like base ones
+	RemovePart(Cast<APartActor>(DestroyedActor));
+}
+
+void AAssemblyActor::HandleConstraintBroken(int32 ConstraintIndex)
+{
+	RequestCleanup();
+}
+
+void AAssemblyActor::TrackPart(APartActor* Part)
+{
+	if (Part && !Parts.Contains(Part))
+	{
+		Parts.Add(Part);
+		Part->OnDestroyed.AddUniqueDynamic(this, &AAssemblyActor::HandlePartDestroyed);
+	}
+}
@@ -0,0 +1,156 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AssemblyAllocationCounter.h"
+#include "HAL/MemoryBase.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+#if !UE_BUILD_SHIPPING
+
+namespace AssemblyAllocationCounter
+{
+	static thread_local int32 OpenScopes = 0;
+	static thread_local uint64 ThreadCount = 0;
+
+	/** Forwards everything to the original allocator, counting new blocks on threads with an open scope */
+	class FCountingMalloc final : public FMalloc
+	{
+	public:
+		explicit FCountingMalloc(FMalloc* InInner) : Inner(InInner) {}
+
+		FMalloc* GetInner() const { return Inner; }
+
+		virtual void* Malloc(SIZE_T Count, uint32 Alignment) override
+		{
+			Tally();
+			return Inner->Malloc(Count, Alignment);
+		}
+
+		virtual void* TryMalloc(SIZE_T Count, uint32 Alignment) override
+		{
+			Tally();
+			return Inner->TryMalloc(Count, Alignment);
+		}
+
+		virtual void* Realloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			CountRealloc(Original, Count);
+			return Inner->Realloc(Original, Count, Alignment);
+		}
+
+		virtual void* TryRealloc(void* Original, SIZE_T Count, uint32 Alignment) override
+		{
+			CountRealloc(Original, Count);
+			return Inner->TryRealloc(Original, Count, Alignment);
+		}
+
+		virtual void Free(void* Original) override { Inner->Free(Original); }
+		virtual SIZE_T QuantizeSize(SIZE_T Count, uint32 Alignment) override { return Inner->QuantizeSize(Count, Alignment); }
+		virtual bool GetAllocationSize(void* Original, SIZE_T& SizeOut) override { return Inner->GetAllocationSize(Original, SizeOut); }
+		virtual void Trim(bool bTrimThreadCaches) override { Inner->Trim(bTrimThreadCaches); }
+		virtual void SetupTLSCachesOnCurrentThread() override { Inner->SetupTLSCachesOnCurrentThread(); }
+		virtual void ClearAndDisableTLSCachesOnCurrentThread() override { Inner->ClearAndDisableTLSCachesOnCurrentThread(); }
+		virtual void InitializeStatsMetadata() override { Inner->InitializeStatsMetadata(); }
+		virtual void UpdateStats() override { Inner->UpdateStats(); }
+		virtual void GetAllocatorStats(FGenericMemoryStats& OutStats) override { Inner->GetAllocatorStats(OutStats); }
+		virtual void DumpAllocatorStats(FOutputDevice& Ar) override { Inner->DumpAllocatorStats(Ar); }
+		virtual bool IsInternallyThreadSafe() const override { return Inner->IsInternallyThreadSafe(); }
+		virtual bool ValidateHeap() override { return Inner->ValidateHeap(); }
+		virtual const TCHAR* GetDescriptiveName() override { return Inner->GetDescriptiveName(); }
+
+	private:
+		static void Tally()
+		{
+			if (OpenScopes > 0)
+			{
+				++ThreadCount;
+			}
+		}
+
+		/** A realloc of nothing is a malloc and one that grows past its block may move; shrinks and frees are neither */
+		void CountRealloc(void* Original, SIZE_T Count)
+		{
+			if (Count == 0 || OpenScopes == 0)
+			{
+				return;
+			}
+			SIZE_T CurrentSize = 0;
+			if (!Original || !Inner->GetAllocationSize(Original, CurrentSize) || Count > CurrentSize)
+			{
+				++ThreadCount;
+			}
+		}
+
+		FMalloc* Inner;
+	};
+
+	/** Set by Install, cleared by Uninstall; only ever touched on the game thread */
+	static FCountingMalloc* Proxy = nullptr;
+}
+
+void FAssemblyAllocationCounter::Install()
+{
+	using namespace AssemblyAllocationCounter;
+	check(IsInGameThread());
+	if (Proxy || !GMalloc || !FParse::Param(FCommandLine::Get(), TEXT("AssemblyAllocCounter")))
+	{
+		return;
+	}
+
+	// Other threads allocate while we swap, so publish the proxy with one atomic store. It forwards
+	// every call, so blocks handed out before it went in free normally.
+	Proxy = new FCountingMalloc(GMalloc);
+	FPlatformAtomics::InterlockedExchangePtr(reinterpret_cast<void**>(&GMalloc), Proxy);
+	UE_LOG(LogTemp, Log, TEXT("FAssemblyAllocationCounter: Counting allocations inside allocation scopes"));
+}
+
+void FAssemblyAllocationCounter::Uninstall()
+{
+	using namespace AssemblyAllocationCounter;
+	check(IsInGameThread());
+	// Only when nothing has wrapped GMalloc after us; otherwise the proxy stays in the chain
+	if (Proxy && FPlatformAtomics::InterlockedCompareExchangePointer(reinterpret_cast<void**>(&GMalloc), Proxy->GetInner(), Proxy) == Proxy)
+	{
+		// Leaked on purpose: a thread may still be inside one of its calls
+		Proxy = nullptr;
+	}
+}
+
+bool FAssemblyAllocationCounter::IsEnabled()
+{
+	return AssemblyAllocationCounter::Proxy != nullptr;
+}
+
+uint64 FAssemblyAllocationCounter::GetThreadCount()
+{
+	return AssemblyAllocationCounter::ThreadCount;
+}
+
+FAssemblyAllocationScope::FAssemblyAllocationScope()
+{
+	++AssemblyAllocationCounter::OpenScopes;
+	StartCount = AssemblyAllocationCounter::ThreadCount;
+}
+
+FAssemblyAllocationScope::~FAssemblyAllocationScope()
+{
+	--AssemblyAllocationCounter::OpenScopes;
+}
+
+uint64 FAssemblyAllocationScope::GetNumAllocations() const
+{
+	return AssemblyAllocationCounter::ThreadCount - StartCount;
+}
+
+#else
+
+void FAssemblyAllocationCounter::Install() {}
+void FAssemblyAllocationCounter::Uninstall() {}
+bool FAssemblyAllocationCounter::IsEnabled() { return false; }
+uint64 FAssemblyAllocationCounter::GetThreadCount() { return 0; }
+
+FAssemblyAllocationScope::FAssemblyAllocationScope() {}
+FAssemblyAllocationScope::~FAssemblyAllocationScope() {}
+uint64 FAssemblyAllocationScope::GetNumAllocations() const { return 0; }
+
+#endif
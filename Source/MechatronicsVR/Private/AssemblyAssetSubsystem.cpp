@@ -0,0 +1,151 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AssemblyAssetSubsystem.h"
+#include "AssemblyStats.h"
+#include "Engine/World.h"
+#include "Haptics/HapticFeedbackEffect_Base.h"
+#include "Materials/MaterialInterface.h"
+
+static TAutoConsoleVariable<bool> CVarBlockInteractionUntilLoaded(
+	TEXT("Assembly.Assets.BlockInteractionUntilLoaded"),
+	true,
+	TEXT("Refuse grabs while lesson assets are still streaming in."));
+
+void UAssemblyAssetSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	LevelStartTime = FPlatformTime::Seconds();
+
+	// Assemblies queue their lesson assets during BeginPlay, load them as one batch once they all have
+	GetWorld()->OnWorldBeginPlay.AddUObject(this, &UAssemblyAssetSubsystem::HandleWorldBeginPlay);
+}
+
+void UAssemblyAssetSubsystem::Deinitialize()
+{
+	for (const TSharedPtr<FStreamableHandle>& Handle : PreloadHandles)
+	{
+		if (Handle.IsValid())
+		{
+			Handle->CancelHandle();
+		}
+	}
+	PreloadHandles.Empty();
+	PendingAssets.Empty();
+	NumPreloadsInFlight = 0;
+
+	Super::Deinitialize();
+}
+
+UAssemblyAssetSubsystem* UAssemblyAssetSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UAssemblyAssetSubsystem>() : nullptr;
+}
+
+void UAssemblyAssetSubsystem::HandleWorldBeginPlay()
+{
+	bHasBegunPlay = true;
+
+	// Shared assets ride along with the first batch
+	if (!GhostPreviewMaterial.IsNull())
+	{
+		PendingAssets.AddUnique(GhostPreviewMaterial.ToSoftObjectPath());
+	}
+	if (!GrabHapticEffect.IsNull())
+	{
+		PendingAssets.AddUnique(GrabHapticEffect.ToSoftObjectPath());
+	}
+
+	StartPreload();
+}
+
+void UAssemblyAssetSubsystem::RequestPreload(TConstArrayView<FSoftObjectPath> Assets)
+{
+	for (const FSoftObjectPath& Asset : Assets)
+	{
+		if (Asset.IsValid())
+		{
+			PendingAssets.AddUnique(Asset);
+		}
+	}
+
+	// Spawned after the level started, load on its own
+	if (bHasBegunPlay)
+	{
+		StartPreload();
+	}
+}
+
+void UAssemblyAssetSubsystem::StartPreload()
+{
+	if (PendingAssets.IsEmpty())
+	{
+		MarkInteractive();
+		return;
+	}
+
+	TArray<FSoftObjectPath> Assets = MoveTemp(PendingAssets);
+	PendingAssets.Reset();
+
+	const int32 NumAssets = Assets.Num();
+	const double PreloadStartTime = FPlatformTime::Seconds();
+
+	// Count first, the delegate may fire before RequestAsyncLoad returns
+	++NumPreloadsInFlight;
+	TSharedPtr<FStreamableHandle> Handle = StreamableManager.RequestAsyncLoad(MoveTemp(Assets),
+		FStreamableDelegate::CreateUObject(this, &UAssemblyAssetSubsystem::HandlePreloadComplete, NumAssets, PreloadStartTime),
+		FStreamableManager::AsyncLoadHighPriority);
+
+	if (Handle.IsValid())
+	{
+		PreloadHandles.Add(Handle);
+	}
+	else if (NumPreloadsInFlight > 0)
+	{
+		// Nothing to wait for
+		--NumPreloadsInFlight;
+		MarkInteractive();
+	}
+}
+
+void UAssemblyAssetSubsystem::HandlePreloadComplete(int32 NumAssets, double PreloadStartTime)
+{
+	NumPreloadsInFlight = FMath::Max(0, NumPreloadsInFlight - 1);
+
+	UE_LOG(LogTemp, Log, TEXT("AssemblyAssets: preloaded %d assets in %.2f ms"),
+		NumAssets, (FPlatformTime::Seconds() - PreloadStartTime) * 1000.0);
+
+	if (!GhostPreviewMaterial.IsNull() && !GhostPreviewMaterial.Get())
+	{
+		UE_LOG(LogTemp, Error, TEXT("AssemblyAssets: failed to load ghost preview material %s"), *GhostPreviewMaterial.ToString());
+	}
+
+	if (NumPreloadsInFlight == 0)
+	{
+		MarkInteractive();
+	}
+}
+
+void UAssemblyAssetSubsystem::MarkInteractive()
+{
+	if (TimeToInteractive >= 0.0f || NumPreloadsInFlight > 0)
+	{
+		return;
+	}
+
+	TimeToInteractive = static_cast<float>(FPlatformTime::Seconds() - LevelStartTime);
+	CSV_CUSTOM_STAT(Assembly, TimeToInteractiveMs, TimeToInteractive * 1000.0f, ECsvCustomStatOp::Set);
+	UE_LOG(LogTemp, Log, TEXT("AssemblyAssets: interactive %.2f ms after level load"), TimeToInteractive * 1000.0f);
+
+	OnInteractionReady.Broadcast();
+}
+
+bool UAssemblyAssetSubsystem::IsInteractionEnabled() const
+{
+	if (!CVarBlockInteractionUntilLoaded.GetValueOnGameThread())
+	{
+		return true;
+	}
+	return bHasBegunPlay && NumPreloadsInFlight == 0;
+}
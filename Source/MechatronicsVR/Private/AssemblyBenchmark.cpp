@@ -0,0 +1,435 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AssemblyBenchmark.h"
+#include "AssemblyActor.h"
+#include "AssemblyAllocationCounter.h"
+#include "AssemblyComponent.h"
+#include "LessonData.h"
+#include "PartActor.h"
+#include "SnapPointComponent.h"
+#include "Engine/World.h"
+#include "HAL/FileManager.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/App.h"
+#include "Misc/FileHelper.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+#include "Policies/PrettyJsonPrintPolicy.h"
+#include "Serialization/JsonWriter.h"
+
+namespace AssemblyBenchmark
+{
+	static const FName PlugID(TEXT("Benchmark.Plug"));
+	static const FName SocketID(TEXT("Benchmark.Socket"));
+
+	static double Percentile(const TArray<double>& Sorted, double Fraction)
+	{
+		if (Sorted.Num() == 0)
+		{
+			return 0.0;
+		}
+		const int32 Index = FMath::Clamp(FMath::CeilToInt(Fraction * Sorted.Num()) - 1, 0, Sorted.Num() - 1);
+		return Sorted[Index];
+	}
+
+	static USnapPointComponent* GetSnapPoint(const APartActor* Part, int32 Index)
+	{
+		if (!Part)
+		{
+			return nullptr;
+		}
+		const TConstArrayView<TObjectPtr<USnapPointComponent>> SnapPoints = Part->GetSnapPointsView();
+		return SnapPoints.IsValidIndex(Index) ? SnapPoints[Index].Get() : nullptr;
+	}
+}
+
+void FAssemblyBenchmarkConfig::ParseArgs(const TArray<FString>& Args)
+{
+	for (const FString& Arg : Args)
+	{
+		const TCHAR* Stream = *Arg;
+		FParse::Value(Stream, TEXT("Parts="), NumParts);
+		FParse::Value(Stream, TEXT("SnapPoints="), SnapPointsPerPart);
+		FParse::Value(Stream, TEXT("Iterations="), Iterations);
+		FParse::Value(Stream, TEXT("Seed="), Seed);
+		FParse::Value(Stream, TEXT("Spacing="), Spacing);
+	}
+	NumParts = FMath::Max(2, NumParts);
+	SnapPointsPerPart = FMath::Max(2, SnapPointsPerPart);
+	Iterations = FMath::Max(1, Iterations);
+}
+
+FAssemblyBenchmark::FAssemblyBenchmark(UWorld* InWorld, const FAssemblyBenchmarkConfig& InConfig)
+	: World(InWorld)
+	, Config(InConfig)
+	, Random(InConfig.Seed)
+{
+}
+
+FAssemblyBenchmark::~FAssemblyBenchmark()
+{
+	DestroySetup();
+}
+
+bool FAssemblyBenchmark::Run()
+{
+	using namespace AssemblyBenchmark;
+
+	Results.Reset();
+	Checkpoints = FAssemblyBenchmarkCheckpoints();
+	StartTime = FDateTime::UtcNow();
+	if (!SpawnSetup())
+	{
+		return false;
+	}
+	AAssemblyActor* AssemblyActor = Assembly.Get();
+	const int32 NumLinks = Parts.Num() - 1;
+	Checkpoints.NumParts = Parts.Num();
+
+	Measure(TEXT("FindBestPreviewTarget"), Config.Iterations, [this](int32)
+	{
+		if (const APartActor* Part = Parts[Random.RandHelper(Parts.Num())].Get())
+		{
+			Part->FindBestPreviewTarget();
+		}
+	});
+
+	Measure(TEXT("GetBestSnapPointFor"), Config.Iterations, [this](int32)
+	{
+		const APartActor* Part = Parts[Random.RandHelper(Parts.Num())].Get();
+		const APartActor* Other = Parts[Random.RandHelper(Parts.Num())].Get();
+		if (Part && Other)
+		{
+			Part->GetBestSnapPointFor(GetSnapPoint(Other, Random.RandHelper(Config.SnapPointsPerPart)));
+		}
+	});
+
+	// A held part's whole cycle: preview its target, snap onto it, then pull it off so the next sample starts loose.
+	// Benchmark parts do not simulate, so only the snap and assembly work is in it, not the physics.
+	int32 NumSnapped = 0;
+	auto GrabPreviewSnap = [this, AssemblyActor, &NumSnapped](int32 Sample)
+	{
+		APartActor* Part = Parts[Sample % Parts.Num()].Get();
+		USnapPointComponent* Target = Part ? Part->FindBestPreviewTarget() : nullptr;
+		USnapPointComponent* Source = Target ? Part->GetBestSnapPointFor(Target) : nullptr;
+		APartActor* TargetPart = Target ? Cast<APartActor>(Target->GetOwner()) : nullptr;
+		if (!Source || !TargetPart)
+		{
+			return;
+		}
+		Part->CalculateSnapTransform(Source, Target);
+		if (AssemblyActor->ConnectParts(Part, TargetPart, Source, Target))
+		{
+			AssemblyActor->DisconnectParts(Part, TargetPart);
+			++NumSnapped;
+		}
+	};
+	// One untimed pass first: the first connect of each part sizes the containers every later one reuses
+	for (int32 Sample = 0; Sample < Parts.Num(); ++Sample)
+	{
+		GrabPreviewSnap(Sample);
+	}
+	NumSnapped = 0;
+	Measure(TEXT("GrabPreviewSnap"), Config.Iterations, GrabPreviewSnap);
+	Checkpoints.SnapCycleSnaps = NumSnapped;
+
+	Measure(TEXT("ConnectParts"), NumLinks, [this, AssemblyActor](int32 Link)
+	{
+		APartActor* PartA = Parts[Link].Get();
+		APartActor* PartB = Parts[Link + 1].Get();
+		AssemblyActor->ConnectParts(PartA, PartB, GetSnapPoint(PartA, 0), GetSnapPoint(PartB, 1));
+	});
+	Checkpoints.ConnectionsAfterConnect = AssemblyActor->Connections.Num();
+	Checkpoints.SubAssembliesAfterConnect = AssemblyActor->GetNumSubAssemblies();
+	Checkpoints.StateAfterConnect = AssemblyActor->AssemblyState;
+
+	Measure(TEXT("GetConnectedParts"), Config.Iterations, [this, AssemblyActor](int32)
+	{
+		AssemblyActor->GetConnectedParts(Parts[Random.RandHelper(Parts.Num())].Get());
+	});
+
+	// Random order, so splits land anywhere along the chain rather than always at an end
+	TArray<int32> LinkOrder;
+	LinkOrder.Reserve(NumLinks);
+	for (int32 Link = 0; Link < NumLinks; ++Link)
+	{
+		LinkOrder.Add(Link);
+	}
+	for (int32 Index = NumLinks - 1; Index > 0; --Index)
+	{
+		LinkOrder.Swap(Index, Random.RandHelper(Index + 1));
+	}
+
+	Measure(TEXT("DisconnectParts"), NumLinks, [this, AssemblyActor, &LinkOrder](int32 Sample)
+	{
+		const int32 Link = LinkOrder[Sample];
+		AssemblyActor->DisconnectParts(Parts[Link].Get(), Parts[Link + 1].Get());
+	});
+	Checkpoints.ConnectionsAfterDisconnect = AssemblyActor->Connections.Num();
+	Checkpoints.SubAssembliesAfterDisconnect = AssemblyActor->GetNumSubAssemblies();
+	Checkpoints.StateAfterDisconnect = AssemblyActor->AssemblyState;
+
+	ConnectChain();
+	Measure(TEXT("RemovePart"), Parts.Num(), [this, AssemblyActor, &LinkOrder](int32 Sample)
+	{
+		// Walk the shuffled links, then the last part
+		const int32 PartIndex = Sample < LinkOrder.Num() ? LinkOrder[Sample] : Parts.Num() - 1;
+		AssemblyActor->RemovePart(Parts[PartIndex].Get());
+	});
+	Checkpoints.PartsAfterRemove = AssemblyActor->Parts.Num();
+	Checkpoints.StateAfterRemove = AssemblyActor->AssemblyState;
+
+	DestroySetup();
+	return true;
+}
+
+template <typename FuncType>
+void FAssemblyBenchmark::Measure(const TCHAR* Name, int32 NumSamples, FuncType&& Func)
+{
+	TArray<double> SamplesUs;
+	SamplesUs.Reserve(NumSamples);
+
+	uint64 NumAllocations = 0;
+	const uint64 StartCycles = FPlatformTime::Cycles64();
+	{
+		FAssemblyAllocationScope AllocationScope;
+		for (int32 Sample = 0; Sample < NumSamples; ++Sample)
+		{
+			const uint64 SampleStart = FPlatformTime::Cycles64();
+			Func(Sample);
+			SamplesUs.Add(FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - SampleStart) * 1000.0);
+		}
+		NumAllocations = AllocationScope.GetNumAllocations();
+	}
+	const double TotalMs = FPlatformTime::ToMilliseconds64(FPlatformTime::Cycles64() - StartCycles);
+
+	SamplesUs.Sort();
+	FAssemblyBenchmarkResult& Result = Results.AddDefaulted_GetRef();
+	Result.Name = Name;
+	Result.Samples = NumSamples;
+	Result.TotalMs = TotalMs;
+	double SumUs = 0.0;
+	for (const double SampleUs : SamplesUs)
+	{
+		SumUs += SampleUs;
+	}
+	Result.MeanUs = NumSamples > 0 ? SumUs / NumSamples : 0.0;
+	Result.P50Us = AssemblyBenchmark::Percentile(SamplesUs, 0.50);
+	Result.P90Us = AssemblyBenchmark::Percentile(SamplesUs, 0.90);
+	Result.P99Us = AssemblyBenchmark::Percentile(SamplesUs, 0.99);
+	Result.MaxUs = SamplesUs.Num() > 0 ? SamplesUs.Last() : 0.0;
+	Result.OpsPerSecond = TotalMs > 0.0 ? NumSamples / (TotalMs / 1000.0) : 0.0;
+	// The sample array was reserved up front, so anything counted here came from the calls themselves
+	Result.Allocations = FAssemblyAllocationCounter::IsEnabled() ? static_cast<int64>(NumAllocations) : -1;
+
+	UE_LOG(LogTemp, Log, TEXT("Assembly.Benchmark %-22s n=%-6d mean=%8.2fus p50=%8.2fus p90=%8.2fus p99=%8.2fus max=%8.2fus %10.0f ops/s"),
+		Name, NumSamples, Result.MeanUs, Result.P50Us, Result.P90Us, Result.P99Us, Result.MaxUs, Result.OpsPerSecond);
+}
+
+bool FAssemblyBenchmark::SpawnSetup()
+{
+	using namespace AssemblyBenchmark;
+
+	DestroySetup();
+	if (!World)
+	{
+		return false;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	AAssemblyActor* AssemblyActor = World->SpawnActor<AAssemblyActor>(AAssemblyActor::StaticClass(), FTransform::Identity, SpawnParams);
+	if (!AssemblyActor)
+	{
+		return false;
+	}
+	Assembly = AssemblyActor;
+
+	const int32 GridSide = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(Config.NumParts)));
+	Parts.Reserve(Config.NumParts);
+	for (int32 PartIndex = 0; PartIndex < Config.NumParts; ++PartIndex)
+	{
+		const FVector Location(
+			(PartIndex % GridSide) * Config.Spacing,
+			(PartIndex / GridSide) * Config.Spacing,
+			100.0f + Random.FRandRange(-2.0f, 2.0f));
+		APartActor* Part = World->SpawnActor<APartActor>(APartActor::StaticClass(), FTransform(Location), SpawnParams);
+		if (!Part)
+		{
+			continue;
+		}
+		Part->Mesh->SetSimulatePhysics(false);
+		Part->SetAssemblyActor(AssemblyActor);
+
+		for (int32 SnapIndex = 0; SnapIndex < Config.SnapPointsPerPart; ++SnapIndex)
+		{
+			const bool bPlug = SnapIndex % 2 == 0;
+			USnapPointComponent* SnapPoint = NewObject<USnapPointComponent>(Part, NAME_None, RF_Transient);
+			SnapPoint->SnapID = bPlug ? PlugID : SocketID;
+			SnapPoint->CompatibleSnapIDs.Add(bPlug ? SocketID : PlugID);
+			SnapPoint->SetupAttachment(Part->Assembly);
+
+			const float Angle = 2.0f * PI * SnapIndex / Config.SnapPointsPerPart;
+			SnapPoint->SetRelativeLocation(FVector(FMath::Cos(Angle), FMath::Sin(Angle), 0.0f) * 5.0f);
+			SnapPoint->SetRelativeRotation(FRotator(0.0f, FMath::RadiansToDegrees(Angle), 0.0f));
+			Part->AddInstanceComponent(SnapPoint);
+			SnapPoint->RegisterComponent();
+		}
+		Part->Assembly->RegisterSnapPoints();
+		AssemblyActor->AddPart(Part);
+		Parts.Add(Part);
+	}
+
+	// Every plug-to-socket link of the chain, so the assembly is solved exactly when the chain is whole
+	Lesson.Reset(NewObject<ULessonData>(GetTransientPackage(), NAME_None, RF_Transient));
+	FLessonConnection& ChainLink = Lesson->ExpectedConnections.AddDefaulted_GetRef();
+	ChainLink.PartClassA = APartActor::StaticClass();
+	ChainLink.SnapIDA = PlugID;
+	ChainLink.PartClassB = APartActor::StaticClass();
+	ChainLink.SnapIDB = SocketID;
+	ChainLink.Count = FMath::Max(1, Parts.Num() - 1);
+	AssemblyActor->SetLesson(Lesson.Get());
+
+	return Parts.Num() >= 2;
+}
+
+void FAssemblyBenchmark::ConnectChain()
+{
+	using namespace AssemblyBenchmark;
+
+	AAssemblyActor* AssemblyActor = Assembly.Get();
+	if (!AssemblyActor)
+	{
+		return;
+	}
+	AssemblyActor->BeginChangeBatch();
+	for (int32 Link = 0; Link + 1 < Parts.Num(); ++Link)
+	{
+		APartActor* PartA = Parts[Link].Get();
+		APartActor* PartB = Parts[Link + 1].Get();
+		AssemblyActor->ConnectParts(PartA, PartB, GetSnapPoint(PartA, 0), GetSnapPoint(PartB, 1));
+	}
+	AssemblyActor->EndChangeBatch();
+}
+
+void FAssemblyBenchmark::DestroySetup()
+{
+	for (const TWeakObjectPtr<APartActor>& Part : Parts)
+	{
+		if (APartActor* PartActor = Part.Get())
+		{
+			PartActor->Destroy();
+		}
+	}
+	Parts.Reset();
+
+	if (AAssemblyActor* AssemblyActor = Assembly.Get())
+	{
+		AssemblyActor->Destroy();
+	}
+	Assembly.Reset();
+	Lesson.Reset();
+}
+
+FString FAssemblyBenchmark::ToJson() const
+{
+	FString Json;
+	const TSharedRef<TJsonWriter<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>> Writer = TJsonWriterFactory<TCHAR, TPrettyJsonPrintPolicy<TCHAR>>::Create(&Json);
+
+	Writer->WriteObjectStart();
+	Writer->WriteValue(TEXT("benchmark"), TEXT("Assembly"));
+	Writer->WriteValue(TEXT("timestamp"), StartTime.ToIso8601());
+	Writer->WriteValue(TEXT("build"), FString(FApp::GetBuildVersion()));
+	Writer->WriteValue(TEXT("configuration"), FString(LexToString(FApp::GetBuildConfiguration())));
+
+	Writer->WriteObjectStart(TEXT("config"));
+	Writer->WriteValue(TEXT("parts"), Config.NumParts);
+	Writer->WriteValue(TEXT("snapPointsPerPart"), Config.SnapPointsPerPart);
+	Writer->WriteValue(TEXT("iterations"), Config.Iterations);
+	Writer->WriteValue(TEXT("seed"), Config.Seed);
+	Writer->WriteValue(TEXT("spacing"), Config.Spacing);
+	Writer->WriteObjectEnd();
+
+	Writer->WriteObjectStart(TEXT("checkpoints"));
+	Writer->WriteValue(TEXT("parts"), Checkpoints.NumParts);
+	Writer->WriteValue(TEXT("snapCycleSnaps"), Checkpoints.SnapCycleSnaps);
+	Writer->WriteValue(TEXT("connectionsAfterConnect"), Checkpoints.ConnectionsAfterConnect);
+	Writer->WriteValue(TEXT("solvedAfterConnect"), Checkpoints.StateAfterConnect == EAssemblyState::FullyAssembled);
+	Writer->WriteValue(TEXT("connectionsAfterDisconnect"), Checkpoints.ConnectionsAfterDisconnect);
+	Writer->WriteValue(TEXT("partsAfterRemove"), Checkpoints.PartsAfterRemove);
+	Writer->WriteObjectEnd();
+
+	Writer->WriteArrayStart(TEXT("results"));
+	for (const FAssemblyBenchmarkResult& Result : Results)
+	{
+		Writer->WriteObjectStart();
+		Writer->WriteValue(TEXT("name"), Result.Name);
+		Writer->WriteValue(TEXT("samples"), Result.Samples);
+		Writer->WriteValue(TEXT("totalMs"), Result.TotalMs);
+		Writer->WriteValue(TEXT("meanUs"), Result.MeanUs);
+		Writer->WriteValue(TEXT("p50Us"), Result.P50Us);
+		Writer->WriteValue(TEXT("p90Us"), Result.P90Us);
+		Writer->WriteValue(TEXT("p99Us"), Result.P99Us);
+		Writer->WriteValue(TEXT("maxUs"), Result.MaxUs);
+		Writer->WriteValue(TEXT("opsPerSecond"), Result.OpsPerSecond);
+		Writer->WriteValue(TEXT("allocations"), Result.Allocations);
+		Writer->WriteObjectEnd();
+	}
+	Writer->WriteArrayEnd();
+
+	Writer->WriteObjectEnd();
+	Writer->Close();
+	return Json;
+}
+
+bool FAssemblyBenchmark::WriteJson(const FString& Path, FString* OutWrittenPath) const
+{
+	const FString OutputPath = !Path.IsEmpty() ? Path
+		: FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("Assembly-%s.json"), *StartTime.ToString());
+	if (OutWrittenPath)
+	{
+		*OutWrittenPath = OutputPath;
+	}
+	IFileManager::Get().MakeDirectory(*FPaths::GetPath(OutputPath), true);
+	return FFileHelper::SaveStringToFile(ToJson(), *OutputPath, FFileHelper::EEncodingOptions::ForceUTF8WithoutBOM);
+}
+
+static FAutoConsoleCommandWithWorldArgsAndOutputDevice GAssemblyBenchmarkCommand(
+	TEXT("Assembly.Benchmark"),
+	TEXT("Time the snap and assembly pipeline on a synthetic setup and write JSON to Saved/Benchmarks. ")
+	TEXT("Args: Parts=200 SnapPoints=6 Iterations=1000 Seed=1 Spacing=30 Out=<path>"),
+	FConsoleCommandWithWorldArgsAndOutputDeviceDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World, FOutputDevice& Ar)
+	{
+		if (!World || !World->IsGameWorld())
+		{
+			Ar.Log(TEXT("Assembly.Benchmark: needs a game world (run with -game or in PIE)"));
+			return;
+		}
+
+		FAssemblyBenchmarkConfig Config;
+		Config.ParseArgs(Args);
+		FString OutputPath;
+		for (const FString& Arg : Args)
+		{
+			FParse::Value(*Arg, TEXT("Out="), OutputPath);
+		}
+
+		FAssemblyBenchmark Benchmark(World, Config);
+		if (!Benchmark.Run())
+		{
+			Ar.Log(TEXT("Assembly.Benchmark: could not spawn the benchmark setup"));
+			return;
+		}
+
+		FString WrittenPath;
+		if (Benchmark.WriteJson(OutputPath, &WrittenPath))
+		{
+			Ar.Logf(TEXT("Assembly.Benchmark: wrote %s"), *WrittenPath);
+		}
+		else
+		{
+			Ar.Logf(TEXT("Assembly.Benchmark: failed to write %s"), *WrittenPath);
+		}
+	}));
@@ -24,6 +24,18 @@ void UAssemblyComponent::RegisterSnapPoints()
 		if (USnapPointComponent* SnapPoint = Cast<USnapPointComponent>(Child))
 		{
 			SnapPoints.Add(SnapPoint);
+			SnapPoint->BakeActorRelativeTransform();
+		}
+	}
+}
+
+void UAssemblyComponent::RefreshSnapTransforms()
+{
+	for (USnapPointComponent* SnapPoint : SnapPoints)
+	{
+		if (SnapPoint)
+		{
+			SnapPoint->RefreshCachedTransform();
 		}
 	}
 }
@@ -66,7 +78,8 @@ void UAssemblyComponent::TickComponent(float DeltaTime, ELevelTick TickType, FAc
             if (!SnapPoint)
                 continue;
             
-            FVector Location = SnapPoint->GetComponentLocation();
+            const FTransform SnapWorld = SnapPoint->GetSnapWorldTransform();
+            FVector Location = SnapWorld.GetLocation();
             FColor DrawColor = SnapPoint->bIsAssembled ? FColor::Red : FColor::Green;
             
             // Draw sphere at snap point location
@@ -81,7 +94,7 @@ void UAssemblyComponent::TickComponent(float DeltaTime, ELevelTick TickType, FAc
             );
             
             // Draw arrow showing snap direction
-            FVector ForwardVector = SnapPoint->GetForwardVector();
+            FVector ForwardVector = SnapWorld.GetUnitAxis(EAxis::X);
             DrawDebugDirectionalArrow(
                 GetWorld(),
                 Location,
@@ -106,9 +119,8 @@ void UAssemblyComponent::TickComponent(float DeltaTime, ELevelTick TickType, FAc
             );
             
             // Optional: Draw detection radius
-            if (SnapPoint->SnapDetectionSphere)
             {
-	            const float DetectionRadius = SnapPoint->SnapDetectionSphere->GetScaledSphereRadius();
+	            const float DetectionRadius = SnapPoint->SnapDetectionRadius * SnapWorld.GetMaximumAxisScale();
                 DrawDebugSphere(
                     GetWorld(),
                     Location,
@@ -0,0 +1,108 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AssemblyNetComponent.h"
+#include "AssemblyActor.h"
+#include "AssemblyReplication.h"
+#include "PartActor.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "GameFramework/PlayerController.h"
+
+UAssemblyNetComponent::UAssemblyNetComponent()
+{
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+}
+
+UAssemblyNetComponent* UAssemblyNetComponent::FindLocal(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	const APlayerController* PlayerController = World ? World->GetFirstPlayerController() : nullptr;
+	return PlayerController ? PlayerController->FindComponentByClass<UAssemblyNetComponent>() : nullptr;
+}
+
+UAssemblyNetComponent* UAssemblyNetComponent::FindOrAdd(APlayerController* PlayerController)
+{
+	if (!PlayerController || !PlayerController->HasAuthority())
+	{
+		return nullptr;
+	}
+	if (UAssemblyNetComponent* Existing = PlayerController->FindComponentByClass<UAssemblyNetComponent>())
+	{
+		return Existing;
+	}
+
+	UAssemblyNetComponent* Component = NewObject<UAssemblyNetComponent>(PlayerController, TEXT("AssemblyNet"));
+	PlayerController->AddInstanceComponent(Component);
+	Component->RegisterComponent();
+	return Component;
+}
+
+void UAssemblyNetComponent::ServerRequestConnect_Implementation(AAssemblyActor* Assembly, APartActor* PartA, APartActor* PartB,
+	USnapPointComponent* SnapPointA, USnapPointComponent* SnapPointB, int32 PredictionId)
+{
+	const APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	const APawn* Requester = PlayerController ? PlayerController->GetPawn() : nullptr;
+	if (!Assembly || !Assembly->HandleConnectRequest(PartA, PartB, SnapPointA, SnapPointB, Requester))
+	{
+		UE_LOG(LogTemp, Log, TEXT("UAssemblyNetComponent: rejected connect %d from %s"), PredictionId, *GetOwner()->GetName());
+		ClientRejectConnect(Assembly, PredictionId);
+	}
+}
+
+void UAssemblyNetComponent::ServerRequestDisconnect_Implementation(AAssemblyActor* Assembly, APartActor* PartA, APartActor* PartB)
+{
+	const APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	const APawn* Requester = PlayerController ? PlayerController->GetPawn() : nullptr;
+	if (!Assembly || !Assembly->HandleDisconnectRequest(PartA, PartB, Requester))
+	{
+		UE_LOG(LogTemp, Log, TEXT("UAssemblyNetComponent: rejected disconnect from %s"), *GetOwner()->GetName());
+	}
+}
+
+void UAssemblyNetComponent::ServerBeginHeldPart_Implementation(APartActor* Part)
+{
+	const APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	if (Part && Part->HeldPartNet && PlayerController && !Part->HeldPartNet->HandleHoldBegun(PlayerController->GetPawn()))
+	{
+		UE_LOG(LogTemp, Log, TEXT("UAssemblyNetComponent: rejected hold of %s from %s"), *Part->GetName(), *GetOwner()->GetName());
+		ClientRejectHold(Part);
+	}
+}
+
+void UAssemblyNetComponent::ServerUpdateHeldPart_Implementation(APartActor* Part, FHeldPartSample Sample)
+{
+	// Only the player holding the part moves it
+	const APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	if (Part && Part->HeldPartNet && PlayerController && Part->HeldPartNet->GetHeldBy() == PlayerController->GetPawn())
+	{
+		Part->HeldPartNet->HandleSample(Sample);
+	}
+}
+
+void UAssemblyNetComponent::ServerEndHeldPart_Implementation(APartActor* Part, FHeldPartSample FinalSample)
+{
+	const APlayerController* PlayerController = Cast<APlayerController>(GetOwner());
+	if (Part && Part->HeldPartNet && PlayerController && Part->HeldPartNet->GetHeldBy() == PlayerController->GetPawn())
+	{
+		Part->HeldPartNet->HandleHoldEnded(FinalSample);
+	}
+}
+
+void UAssemblyNetComponent::ClientRejectConnect_Implementation(AAssemblyActor* Assembly, int32 PredictionId)
+{
+	AssemblyNetStats::RecordConnectRejected();
+	if (Assembly)
+	{
+		Assembly->HandleConnectRejected(PredictionId);
+	}
+}
+
+void UAssemblyNetComponent::ClientRejectHold_Implementation(APartActor* Part)
+{
+	AssemblyNetStats::RecordHoldRejected();
+	if (Part && Part->HeldPartNet)
+	{
+		Part->HeldPartNet->HandleHoldRejected();
+	}
+}
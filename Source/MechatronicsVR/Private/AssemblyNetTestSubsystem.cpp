@@ -0,0 +1,93 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AssemblyNetTestSubsystem.h"
+#include "PartActor.h"
+#include "Engine/World.h"
+#include "GameFramework/PlayerStart.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+
+bool UAssemblyNetTestSubsystem::ShouldCreateSubsystem(UObject* Outer) const
+{
+	const UWorld* World = Cast<UWorld>(Outer);
+	return World && World->IsGameWorld() && FParse::Param(FCommandLine::Get(), TEXT("AssemblyNetTest"))
+		&& Super::ShouldCreateSubsystem(Outer);
+}
+
+void UAssemblyNetTestSubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	ActorsInitializedHandle = FWorldDelegates::OnWorldInitializedActors.AddUObject(this, &UAssemblyNetTestSubsystem::HandleActorsInitialized);
+}
+
+void UAssemblyNetTestSubsystem::Deinitialize()
+{
+	FWorldDelegates::OnWorldInitializedActors.Remove(ActorsInitializedHandle);
+
+	Super::Deinitialize();
+}
+
+void UAssemblyNetTestSubsystem::HandleActorsInitialized(const FActorsInitializedParams& Params)
+{
+	UWorld* World = GetWorld();
+	// Clients get the parts by replication and never use player starts
+	if (Params.World != World || World->GetNetMode() == NM_Client)
+	{
+		return;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+
+	int32 NumHeld = 0;
+	int32 NumLoose = 0;
+	for (int32 StartIndex = 0; StartIndex < NumPlayerStarts; ++StartIndex)
+	{
+		// Facing the centre, so every player sees the loose stack and the others' hands
+		const float Angle = 2.0f * PI * StartIndex / NumPlayerStarts;
+		const FVector Outward(FMath::Cos(Angle), FMath::Sin(Angle), 0.0f);
+		const FRotator Facing = (-Outward).Rotation();
+		const FVector StartLocation = Center + Outward * PlayerStartRadius;
+		World->SpawnActor<APlayerStart>(APlayerStart::StaticClass(), StartLocation, Facing, SpawnParams);
+
+		const FVector PartLocation = StartLocation - Outward * HeldPartDistance + FVector(0.0f, 0.0f, HeldPartHeight);
+		if (APartActor* Part = SpawnPart(NumHeld, FTransform(Facing, PartLocation)))
+		{
+			// Held by its player: keep it where they can reach it until grabbed
+			Part->Mesh->SetSimulatePhysics(false);
+			++NumHeld;
+		}
+	}
+
+	for (int32 LooseIndex = 0; LooseIndex < NumLooseParts; ++LooseIndex)
+	{
+		// Slightly off axis, so the stack topples and keeps movement replication busy
+		const FVector Offset(LooseIndex % 2 ? 4.0f : -4.0f, 0.0f, HeldPartHeight + LooseIndex * LoosePartSpacing);
+		if (SpawnPart(LooseIndex, FTransform(FRotator(0.0f, LooseIndex * 37.0f, 0.0f), Center + Offset)))
+		{
+			++NumLoose;
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("AssemblyNetTest: placed %d player starts, %d parts to hold and %d loose parts"),
+		NumPlayerStarts, NumHeld, NumLoose);
+}
+
+APartActor* UAssemblyNetTestSubsystem::SpawnPart(int32 Index, const FTransform& Transform)
+{
+	if (PartClasses.Num() == 0)
+	{
+		return nullptr;
+	}
+	UClass* PartClass = PartClasses[Index % PartClasses.Num()].LoadSynchronous();
+	if (!PartClass)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("AssemblyNetTest: could not load %s"), *PartClasses[Index % PartClasses.Num()].ToString());
+		return nullptr;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	return GetWorld()->SpawnActor<APartActor>(PartClass, Transform, SpawnParams);
+}
@@ -0,0 +1,237 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AssemblyRegistrySubsystem.h"
+#include "AssemblyActor.h"
+#include "PartActor.h"
+#include "Algo/BinarySearch.h"
+#include "Engine/World.h"
+
+void UAssemblyRegistrySubsystem::Initialize(FSubsystemCollectionBase& Collection)
+{
+	Super::Initialize(Collection);
+
+	// Level actors register during their BeginPlay, bind them once they all have
+	GetWorld()->OnWorldBeginPlay.AddUObject(this, &UAssemblyRegistrySubsystem::HandleWorldBeginPlay);
+}
+
+void UAssemblyRegistrySubsystem::Deinitialize()
+{
+	PartsByClass.Empty();
+	AssembliesByClass.Empty();
+	PendingParts.Empty();
+	NumParts = 0;
+	bHasResolvedBindings = false;
+
+	Super::Deinitialize();
+}
+
+UAssemblyRegistrySubsystem* UAssemblyRegistrySubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UAssemblyRegistrySubsystem>() : nullptr;
+}
+
+void UAssemblyRegistrySubsystem::HandleWorldBeginPlay()
+{
+	ResolvePendingParts();
+}
+
+template <typename ActorType>
+bool UAssemblyRegistrySubsystem::AddToIndex(TClassIndex<ActorType>& Index, ActorType* Actor)
+{
+	TArray<TEntry<ActorType>>& Bucket = Index.FindOrAdd(Actor->GetClass());
+	const FName Name = Actor->GetFName();
+	const int32 InsertAt = Algo::LowerBound(Bucket, Name,
+		[](const TEntry<ActorType>& Entry, FName Value) { return Entry.Name.LexicalLess(Value); });
+
+	for (int32 Slot = InsertAt; Slot < Bucket.Num() && Bucket[Slot].Name == Name; ++Slot)
+	{
+		if (Bucket[Slot].Actor == Actor)
+		{
+			return false;
+		}
+	}
+	Bucket.Insert(TEntry<ActorType>{ Name, Actor }, InsertAt);
+	return true;
+}
+
+template <typename ActorType>
+bool UAssemblyRegistrySubsystem::RemoveFromIndex(TClassIndex<ActorType>& Index, ActorType* Actor)
+{
+	TArray<TEntry<ActorType>>* Bucket = Index.Find(Actor->GetClass());
+	if (!Bucket)
+	{
+		return false;
+	}
+
+	const int32 Found = Bucket->IndexOfByPredicate([Actor](const TEntry<ActorType>& Entry) { return Entry.Actor == Actor; });
+	if (Found == INDEX_NONE)
+	{
+		return false;
+	}
+
+	// Keep the name order; buckets are small and removal only happens on EndPlay
+	Bucket->RemoveAt(Found);
+	if (Bucket->IsEmpty())
+	{
+		Index.Remove(Actor->GetClass());
+	}
+	return true;
+}
+
+void UAssemblyRegistrySubsystem::RegisterPart(APartActor* Part)
+{
+	if (!Part || !AddToIndex(PartsByClass, Part))
+	{
+		return;
+	}
+	++NumParts;
+
+	if (bHasResolvedBindings)
+	{
+		// Spawned after the level started, everything it can depend on is already here
+		Part->ResolveRegistryBindings(*this);
+	}
+	else
+	{
+		PendingParts.Add(Part);
+	}
+}
+
+void UAssemblyRegistrySubsystem::UnregisterPart(APartActor* Part)
+{
+	if (!Part)
+	{
+		return;
+	}
+
+	if (RemoveFromIndex(PartsByClass, Part))
+	{
+		--NumParts;
+	}
+	PendingParts.RemoveSingle(Part);
+}
+
+void UAssemblyRegistrySubsystem::RegisterAssembly(AAssemblyActor* Assembly)
+{
+	if (!Assembly || !AddToIndex(AssembliesByClass, Assembly) || !bHasResolvedBindings)
+	{
+		return;
+	}
+
+	// Spawned after the binding pass: parts that found no assembly of its class then get one now.
+	// Assemblies are few and rarely spawned, so walking the part index here is cheap.
+	for (const TPair<const UClass*, TArray<TEntry<APartActor>>>& Pair : PartsByClass)
+	{
+		for (const TEntry<APartActor>& Entry : Pair.Value)
+		{
+			APartActor* Part = Entry.Actor.Get();
+			if (Part && !Part->GetAssemblyActor() && Part->AssemblyActorClass && Assembly->IsA(Part->AssemblyActorClass))
+			{
+				Part->ResolveAssemblyBinding(*this);
+			}
+		}
+	}
+}
+
+void UAssemblyRegistrySubsystem::UnregisterAssembly(AAssemblyActor* Assembly)
+{
+	if (Assembly)
+	{
+		RemoveFromIndex(AssembliesByClass, Assembly);
+	}
+}
+
+void UAssemblyRegistrySubsystem::ResolvePendingParts()
+{
+	const double StartTime = FPlatformTime::Seconds();
+	const int32 NumPending = PendingParts.Num();
+
+	// Later registrations bind immediately, so mark first: a binding may spawn more parts
+	bHasResolvedBindings = true;
+
+	TArray<TWeakObjectPtr<APartActor>> ToResolve = MoveTemp(PendingParts);
+	PendingParts.Reset();
+
+	for (const TWeakObjectPtr<APartActor>& PartPtr : ToResolve)
+	{
+		if (APartActor* Part = PartPtr.Get())
+		{
+			Part->ResolveRegistryBindings(*this);
+		}
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("AssemblyRegistry: bound %d parts (%d part classes, %d assembly classes) in %.2f ms"),
+		NumPending, PartsByClass.Num(), AssembliesByClass.Num(), (FPlatformTime::Seconds() - StartTime) * 1000.0);
+}
+
+template <typename ActorType>
+ActorType* UAssemblyRegistrySubsystem::FindLowestNamed(const TClassIndex<ActorType>& Index, const UClass* Class, const AActor* Ignore)
+{
+	if (!Class)
+	{
+		return nullptr;
+	}
+
+	// Only a handful of classes per level, so walking the keys is cheaper than keeping a hierarchy.
+	// Buckets are sorted, the first live entry of each is that class's candidate.
+	ActorType* Best = nullptr;
+	FName BestName;
+	for (const TPair<const UClass*, TArray<TEntry<ActorType>>>& Pair : Index)
+	{
+		if (!Pair.Key->IsChildOf(Class))
+		{
+			continue;
+		}
+
+		for (const TEntry<ActorType>& Entry : Pair.Value)
+		{
+			ActorType* Candidate = Entry.Actor.Get();
+			if (!Candidate || Candidate == Ignore)
+			{
+				continue;
+			}
+			if (!Best || Entry.Name.LexicalLess(BestName))
+			{
+				Best = Candidate;
+				BestName = Entry.Name;
+			}
+			break;
+		}
+	}
+	return Best;
+}
+
+APartActor* UAssemblyRegistrySubsystem::FindPart(TSubclassOf<APartActor> Class, const APartActor* Ignore) const
+{
+	return FindLowestNamed(PartsByClass, Class.Get(), Ignore);
+}
+
+AAssemblyActor* UAssemblyRegistrySubsystem::FindAssembly(TSubclassOf<AAssemblyActor> Class) const
+{
+	return FindLowestNamed(AssembliesByClass, Class.Get(), nullptr);
+}
+
+void UAssemblyRegistrySubsystem::GetParts(TSubclassOf<APartActor> Class, TArray<APartActor*>& OutParts) const
+{
+	OutParts.Reset();
+	if (!Class)
+	{
+		return;
+	}
+
+	for (const TPair<const UClass*, TArray<TEntry<APartActor>>>& Pair : PartsByClass)
+	{
+		if (!Pair.Key->IsChildOf(Class))
+		{
+			continue;
+		}
+		for (const TEntry<APartActor>& Entry : Pair.Value)
+		{
+			if (APartActor* Part = Entry.Actor.Get())
+			{
+				OutParts.Add(Part);
+			}
+		}
+	}
+}
@@ -0,0 +1,200 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AssemblyReplication.h"
+#include "AssemblyActor.h"
+#include "AssemblyStats.h"
+#include "PartActor.h"
+#include "SnapPointComponent.h"
+#include "HAL/IConsoleManager.h"
+
+namespace AssemblyNetStats
+{
+	namespace
+	{
+		int64 NumDeltas = 0;
+		int64 NumDeltaBits = 0;
+
+		/** Deltas that carried connection items, i.e. connects (disconnects only send the item's id) */
+		int64 NumItemDeltas = 0;
+		int64 NumItemDeltaBits = 0;
+		int64 NumItems = 0;
+
+		int64 NumConnectRequests = 0;
+		int64 NumConnectRejects = 0;
+		int64 NumHoldRejects = 0;
+
+		/** Held-part samples and the time they covered, summed over every part held on this machine */
+		int64 NumHeldSamples = 0;
+		int64 NumHeldSampleBits = 0;
+		int64 NumMovementBits = 0;
+		double HeldSeconds = 0.0;
+		float LastNetUpdateFrequency = 0.0f;
+
+		/** Items serialized since the counter was last read, so a delta knows how many it wrote */
+		int32 ItemsWritten = 0;
+	}
+
+	void RecordConnectionDelta(int64 NumBits, int32 NumItemsInDelta)
+	{
+		++NumDeltas;
+		NumDeltaBits += NumBits;
+		if (NumItemsInDelta > 0)
+		{
+			++NumItemDeltas;
+			NumItemDeltaBits += NumBits;
+			NumItems += NumItemsInDelta;
+		}
+		CSV_CUSTOM_STAT(Assembly, ConnectionReplicationBytes, static_cast<float>(NumBits) / 8.0f, ECsvCustomStatOp::Accumulate);
+	}
+
+	void RecordConnectRequest()
+	{
+		++NumConnectRequests;
+		CSV_CUSTOM_STAT(Assembly, ConnectRequests, 1, ECsvCustomStatOp::Accumulate);
+	}
+
+	void RecordConnectRejected()
+	{
+		++NumConnectRejects;
+		CSV_CUSTOM_STAT(Assembly, ConnectRejects, 1, ECsvCustomStatOp::Accumulate);
+	}
+
+	void RecordHoldRejected()
+	{
+		++NumHoldRejects;
+		CSV_CUSTOM_STAT(Assembly, HoldRejects, 1, ECsvCustomStatOp::Accumulate);
+	}
+
+	void RecordHeldPartSample(float Elapsed, int64 SampleBits, int64 MovementBits, float NetUpdateFrequency)
+	{
+		++NumHeldSamples;
+		NumHeldSampleBits += SampleBits;
+		NumMovementBits += MovementBits;
+		HeldSeconds += Elapsed;
+		LastNetUpdateFrequency = NetUpdateFrequency;
+		CSV_CUSTOM_STAT(Assembly, HeldPartReplicationBytes, static_cast<float>(SampleBits) / 8.0f, ECsvCustomStatOp::Accumulate);
+	}
+
+	void Reset()
+	{
+		NumDeltas = NumDeltaBits = 0;
+		NumItemDeltas = NumItemDeltaBits = NumItems = 0;
+		NumConnectRequests = NumConnectRejects = 0;
+		NumHoldRejects = 0;
+		NumHeldSamples = NumHeldSampleBits = NumMovementBits = 0;
+		HeldSeconds = 0.0;
+	}
+
+	static void Print(FOutputDevice& Ar)
+	{
+		const double BytesPerConnect = NumItems > 0 ? static_cast<double>(NumItemDeltaBits) / 8.0 / NumItems : 0.0;
+		const double BytesPerOtherDelta = NumDeltas > NumItemDeltas
+			? static_cast<double>(NumDeltaBits - NumItemDeltaBits) / 8.0 / (NumDeltas - NumItemDeltas) : 0.0;
+
+		Ar.Logf(TEXT("Assembly.Net: %lld connection deltas, %.1f bytes total (per client connection)"), NumDeltas, NumDeltaBits / 8.0);
+		Ar.Logf(TEXT("  connects: %lld items in %lld deltas, %.1f bytes per connect event"), NumItems, NumItemDeltas, BytesPerConnect);
+		Ar.Logf(TEXT("  other deltas (disconnects): %.1f bytes each"), BytesPerOtherDelta);
+		Ar.Logf(TEXT("  client requests: %lld sent, %lld rejected by the server"), NumConnectRequests, NumConnectRejects);
+		Ar.Logf(TEXT("  grabs rejected because another player held the part: %lld"), NumHoldRejects);
+
+		if (NumHeldSamples > 0 && HeldSeconds > 0.0)
+		{
+			// Payloads only; both paths pay the same property or RPC header on top
+			const double BytesPerSample = NumHeldSampleBits / 8.0 / NumHeldSamples;
+			const double SamplesPerSecond = NumHeldSamples / HeldSeconds;
+			const double BytesPerMovement = NumMovementBits / 8.0 / NumHeldSamples;
+			Ar.Logf(TEXT("Held parts: %lld samples over %.1f held-part seconds"), NumHeldSamples, HeldSeconds);
+			Ar.Logf(TEXT("  quantized samples: %.1f bytes each at %.1f Hz = %.1f bytes/s per held part per connection"),
+				BytesPerSample, SamplesPerSecond, BytesPerSample * SamplesPerSecond);
+			Ar.Logf(TEXT("  default movement replication: %.1f bytes per update at up to %.0f Hz = %.1f bytes/s"),
+				BytesPerMovement, LastNetUpdateFrequency, BytesPerMovement * LastNetUpdateFrequency);
+		}
+	}
+}
+
+static FAutoConsoleCommandWithOutputDevice GAssemblyNetStatsCommand(
+	TEXT("Assembly.Net.Stats"),
+	TEXT("Print assembly replication bandwidth: bytes per connect event and per disconnect, and client request counts."),
+	FConsoleCommandWithOutputDeviceDelegate::CreateStatic(&AssemblyNetStats::Print));
+
+static FAutoConsoleCommand GAssemblyNetResetStatsCommand(
+	TEXT("Assembly.Net.ResetStats"),
+	TEXT("Clear the counters printed by Assembly.Net.Stats."),
+	FConsoleCommandDelegate::CreateStatic(&AssemblyNetStats::Reset));
+
+// ================== ITEMS ==================
+
+void FReplicatedPartConnection::PostReplicatedAdd(const FReplicatedConnectionArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->HandleReplicatedConnectionAdded(*this);
+	}
+}
+
+void FReplicatedPartConnection::PostReplicatedChange(const FReplicatedConnectionArray& InArraySerializer)
+{
+	// Items are never edited in place; a change means a part or snap point reference was mapped late
+	if (bPendingApply && InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->HandleReplicatedConnectionAdded(*this);
+	}
+}
+
+void FReplicatedPartConnection::PreReplicatedRemove(const FReplicatedConnectionArray& InArraySerializer)
+{
+	if (InArraySerializer.Owner)
+	{
+		InArraySerializer.Owner->HandleReplicatedConnectionRemoved(*this);
+	}
+}
+
+template<typename T>
+static void SerializeObjectRef(FArchive& Ar, UPackageMap* Map, TObjectPtr<T>& Ref)
+{
+	UObject* Object = Ref;
+	// An unmapped reference is not a failure; the item is applied once it maps
+	Map->SerializeObject(Ar, T::StaticClass(), Object);
+	if (Ar.IsLoading())
+	{
+		Ref = Cast<T>(Object);
+	}
+}
+
+bool FReplicatedPartConnection::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	bOutSuccess = Map != nullptr;
+	if (!Map)
+	{
+		return false;
+	}
+
+	SerializeObjectRef(Ar, Map, PartA);
+	SerializeObjectRef(Ar, Map, PartB);
+	SerializeObjectRef(Ar, Map, SnapPointA);
+	SerializeObjectRef(Ar, Map, SnapPointB);
+
+	if (Ar.IsSaving())
+	{
+		++AssemblyNetStats::ItemsWritten;
+	}
+	return true;
+}
+
+// ================== ARRAY ==================
+
+bool FReplicatedConnectionArray::NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms)
+{
+	FBitWriter* Writer = DeltaParms.Writer;
+	const int64 StartBits = Writer ? Writer->GetNumBits() : 0;
+	AssemblyNetStats::ItemsWritten = 0;
+
+	const bool bResult = FFastArraySerializer::FastArrayDeltaSerialize<FReplicatedPartConnection, FReplicatedConnectionArray>(Items, DeltaParms, *this);
+
+	// Nothing is written when the array is unchanged for this client
+	if (Writer && Writer->GetNumBits() > StartBits)
+	{
+		AssemblyNetStats::RecordConnectionDelta(Writer->GetNumBits() - StartBits, AssemblyNetStats::ItemsWritten);
+	}
+	return bResult;
+}
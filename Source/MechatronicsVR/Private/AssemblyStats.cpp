@@ -0,0 +1,57 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AssemblyStats.h"
+#include "GameFramework/Actor.h"
+
+DEFINE_STAT(STAT_Assembly_FindBestPreviewTarget);
+DEFINE_STAT(STAT_Assembly_GetBestSnapPointFor);
+DEFINE_STAT(STAT_Assembly_CalculateSnapTransform);
+DEFINE_STAT(STAT_Assembly_TrySnapToPreview);
+DEFINE_STAT(STAT_Assembly_ConnectParts);
+DEFINE_STAT(STAT_Assembly_DisconnectParts);
+DEFINE_STAT(STAT_Assembly_UpdateAssemblyState);
+DEFINE_STAT(STAT_Assembly_SnapOverlapBegin);
+DEFINE_STAT(STAT_Assembly_SnapOverlapEnd);
+DEFINE_STAT(STAT_Assembly_HeldParts);
+DEFINE_STAT(STAT_Assembly_Connections);
+
+UE_TRACE_CHANNEL_DEFINE(AssemblyChannel);
+
+CSV_DEFINE_CATEGORY_MODULE(MECHATRONICSVR_API, Assembly, true);
+
+UE_TRACE_EVENT_BEGIN(Assembly, PartEvent)
+	UE_TRACE_EVENT_FIELD(uint64, Cycle)
+	UE_TRACE_EVENT_FIELD(uint8, Event)
+	UE_TRACE_EVENT_FIELD(uint32, PartId)
+	UE_TRACE_EVENT_FIELD(uint32, OtherId)
+	UE_TRACE_EVENT_FIELD(UE::Trace::WideString, PartName)
+UE_TRACE_EVENT_END()
+
+namespace AssemblyTrace
+{
+	void OutputPartEvent(EPartEvent Event, const AActor* Part, const AActor* Other)
+	{
+#if CSV_PROFILER
+		switch (Event)
+		{
+		case EPartEvent::Grab:		 CSV_CUSTOM_STAT(Assembly, Grabs, 1, ECsvCustomStatOp::Accumulate); break;
+		case EPartEvent::Release:	 CSV_CUSTOM_STAT(Assembly, Releases, 1, ECsvCustomStatOp::Accumulate); break;
+		case EPartEvent::Preview:	 CSV_CUSTOM_STAT(Assembly, Previews, 1, ECsvCustomStatOp::Accumulate); break;
+		case EPartEvent::Snap:		 CSV_CUSTOM_STAT(Assembly, Snaps, 1, ECsvCustomStatOp::Accumulate); break;
+		case EPartEvent::Disconnect: CSV_CUSTOM_STAT(Assembly, Disconnects, 1, ECsvCustomStatOp::Accumulate); break;
+		}
+#endif
+
+		// The name is only formatted when a trace session has the channel enabled
+		if (UE_TRACE_CHANNELEXPR_IS_ENABLED(AssemblyChannel))
+		{
+			const FString PartName = Part ? Part->GetName() : FString();
+			UE_TRACE_LOG(Assembly, PartEvent, AssemblyChannel)
+				<< PartEvent.Cycle(FPlatformTime::Cycles64())
+				<< PartEvent.Event(static_cast<uint8>(Event))
+				<< PartEvent.PartId(Part ? Part->GetUniqueID() : 0)
+				<< PartEvent.OtherId(Other ? Other->GetUniqueID() : 0)
+				<< PartEvent.PartName(*PartName, PartName.Len());
+		}
+	}
+}
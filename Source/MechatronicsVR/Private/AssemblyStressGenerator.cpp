@@ -0,0 +1,304 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AssemblyStressGenerator.h"
+#include "AssemblyActor.h"
+#include "AssemblyComponent.h"
+#include "PartActor.h"
+#include "SnapPointComponent.h"
+#include "Engine/World.h"
+#include "HAL/IConsoleManager.h"
+#include "Misc/Parse.h"
+
+namespace AssemblyStress
+{
+	static const FName BaseID(TEXT("Stress.Base"));
+	static const FName RootID(TEXT("Stress.Root"));
+	static const FName NothingID(TEXT("Stress.Nothing"));
+}
+
+AAssemblyStressGenerator::AAssemblyStressGenerator()
+{
+	PrimaryActorTick.bCanEverTick = false;
+	RootComponent = CreateDefaultSubobject<USceneComponent>(TEXT("Root"));
+}
+
+void AAssemblyStressGenerator::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// Parts register their snap points in their own BeginPlay, which may not have run yet
+	if (bConnectOnBeginPlay && Edges.Num() > 0)
+	{
+		GetWorldTimerManager().SetTimerForNextTick(this, &AAssemblyStressGenerator::ConnectGenerated);
+	}
+}
+
+void AAssemblyStressGenerator::ApplyArgs(const TArray<FString>& Args)
+{
+	for (const FString& Arg : Args)
+	{
+		const TCHAR* Stream = *Arg;
+		FParse::Value(Stream, TEXT("Parts="), NumParts);
+		FParse::Value(Stream, TEXT("Seed="), Seed);
+		FParse::Value(Stream, TEXT("Kinds="), NumPartKinds);
+		FParse::Value(Stream, TEXT("Branching="), BranchingFactor);
+		FParse::Value(Stream, TEXT("ExtraEdges="), ExtraEdgeRatio);
+		FParse::Value(Stream, TEXT("Decoys="), DecoySnapPointsPerPart);
+		FParse::Value(Stream, TEXT("Spacing="), Spacing);
+		FParse::Bool(Stream, TEXT("Overlap="), bUseOverlapDetection);
+		FParse::Bool(Stream, TEXT("Connect="), bConnectOnBeginPlay);
+
+		FString TopologyName;
+		if (FParse::Value(Stream, TEXT("Topology="), TopologyName))
+		{
+			Topology = TopologyName.Equals(TEXT("Graph"), ESearchCase::IgnoreCase) ? EAssemblyStressTopology::Graph : EAssemblyStressTopology::Tree;
+		}
+	}
+}
+
+void AAssemblyStressGenerator::Generate()
+{
+	using namespace AssemblyStress;
+
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return;
+	}
+	ClearGenerated();
+
+	const double StartTime = FPlatformTime::Seconds();
+	FRandomStream Random(Seed);
+	const int32 PartCount = FMath::Max(1, NumParts);
+	const int32 KindCount = FMath::Max(1, NumPartKinds);
+
+	// Topology first, so the stream is consumed in the same order whatever gets spawned
+	TArray<int32> Kinds;
+	Kinds.SetNumUninitialized(PartCount);
+	for (int32& Kind : Kinds)
+	{
+		Kind = Random.RandHelper(KindCount);
+	}
+
+	TArray<TPair<int32, int32>> ParentChild;
+	ParentChild.Reserve(PartCount);
+	for (int32 Child = 1; Child < PartCount; ++Child)
+	{
+		const int32 Parent = Topology == EAssemblyStressTopology::Tree
+			? (Child - 1) / FMath::Max(1, BranchingFactor)
+			: Random.RandHelper(Child);
+		ParentChild.Emplace(Parent, Child);
+	}
+	if (Topology == EAssemblyStressTopology::Graph && PartCount > 1)
+	{
+		// Undirected pairs as (lower, higher); spanning tree parents always have the lower index
+		TSet<TPair<int32, int32>> Pairs;
+		Pairs.Append(ParentChild);
+
+		// No more than the pairs the spanning tree leaves free, and a bounded number of draws to find them
+		const int64 NumFreePairs = static_cast<int64>(PartCount) * (PartCount - 1) / 2 - ParentChild.Num();
+		const int32 NumExtraEdges = static_cast<int32>(FMath::Min<int64>(
+			FMath::RoundToInt(PartCount * FMath::Max(0.0f, ExtraEdgeRatio)), NumFreePairs));
+		const int32 MaxDraws = NumExtraEdges * 8;
+		for (int32 Draw = 0, Added = 0; Added < NumExtraEdges && Draw < MaxDraws; ++Draw)
+		{
+			const int32 A = Random.RandHelper(PartCount);
+			const int32 B = Random.RandHelper(PartCount);
+			if (A == B)
+			{
+				continue;
+			}
+			const TPair<int32, int32> Pair(FMath::Min(A, B), FMath::Max(A, B));
+			bool bAlreadyPresent = false;
+			Pairs.Add(Pair, &bAlreadyPresent);
+			if (!bAlreadyPresent)
+			{
+				ParentChild.Add(Pair);
+				++Added;
+			}
+		}
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+	if (World->IsGameWorld())
+	{
+		SpawnParams.ObjectFlags |= RF_Transient;
+	}
+
+	Assembly = World->SpawnActor<AAssemblyActor>(AAssemblyActor::StaticClass(), GetActorTransform(), SpawnParams);
+	if (!Assembly)
+	{
+		return;
+	}
+	Assembly->ExpectedPartCount = PartCount;
+	if (USnapPointComponent* BaseSnapPoint = Assembly->BaseSnapPoints.Num() > 0 ? Assembly->BaseSnapPoints[0] : nullptr)
+	{
+		BaseSnapPoint->SnapID = BaseID;
+		BaseSnapPoint->CompatibleSnapIDs = { RootID };
+	}
+
+	// Square grid beside the assembly
+	const int32 GridSide = FMath::CeilToInt(FMath::Sqrt(static_cast<float>(PartCount)));
+	TArray<int32> NextSlot;
+	NextSlot.SetNumZeroed(PartCount);
+	GeneratedParts.Reserve(PartCount);
+	for (int32 PartIndex = 0; PartIndex < PartCount; ++PartIndex)
+	{
+		TSubclassOf<APartActor> PartClass = PartClasses.Num() > 0 ? PartClasses[Kinds[PartIndex] % PartClasses.Num()] : nullptr;
+		if (!PartClass)
+		{
+			PartClass = APartActor::StaticClass();
+		}
+
+		const FVector Offset((PartIndex % GridSide + 1) * Spacing, (PartIndex / GridSide) * Spacing, 0.0f);
+		const FTransform PartTransform(GetActorRotation(), GetActorLocation() + GetActorRotation().RotateVector(Offset));
+		APartActor* Part = World->SpawnActor<APartActor>(PartClass, PartTransform, SpawnParams);
+		if (!Part)
+		{
+			GeneratedParts.Add(nullptr);
+			continue;
+		}
+		if (Part->Mesh && !Part->Mesh->GetStaticMesh())
+		{
+			// Nothing to simulate without a mesh
+			Part->Mesh->SetSimulatePhysics(false);
+		}
+		Part->SetAssemblyActor(Assembly);
+		GeneratedParts.Add(Part);
+	}
+	const double SpawnTime = FPlatformTime::Seconds();
+
+	if (APartActor* Root = GeneratedParts[0])
+	{
+		RootSnapPoint = AddSnapPoint(Root, RootID, BaseID, NextSlot[0]++);
+	}
+
+	// One SnapID pair per (parent kind, child kind), like real content that reuses connector types
+	for (const TPair<int32, int32>& Link : ParentChild)
+	{
+		APartActor* Parent = GeneratedParts[Link.Key];
+		APartActor* Child = GeneratedParts[Link.Value];
+		if (!Parent || !Child)
+		{
+			continue;
+		}
+		const FString PairName = FString::Printf(TEXT("Stress.K%d_K%d"), Kinds[Link.Key], Kinds[Link.Value]);
+		const FName SocketID(PairName + TEXT(".Socket"));
+		const FName PlugID(PairName + TEXT(".Plug"));
+
+		FAssemblyStressEdge& Edge = Edges.AddDefaulted_GetRef();
+		Edge.Parent = Parent;
+		Edge.Child = Child;
+		Edge.ParentSnapPoint = AddSnapPoint(Parent, SocketID, PlugID, NextSlot[Link.Key]++);
+		Edge.ChildSnapPoint = AddSnapPoint(Child, PlugID, SocketID, NextSlot[Link.Value]++);
+	}
+
+	for (int32 PartIndex = 0; PartIndex < PartCount; ++PartIndex)
+	{
+		APartActor* Part = GeneratedParts[PartIndex];
+		if (!Part)
+		{
+			continue;
+		}
+		const FName DecoyID(*FString::Printf(TEXT("Stress.Decoy.K%d"), Kinds[PartIndex]));
+		for (int32 Decoy = 0; Decoy < DecoySnapPointsPerPart; ++Decoy)
+		{
+			AddSnapPoint(Part, DecoyID, NothingID, NextSlot[PartIndex]++);
+		}
+		Part->Assembly->RegisterSnapPoints();
+	}
+	const double EndTime = FPlatformTime::Seconds();
+
+	UE_LOG(LogTemp, Log, TEXT("AAssemblyStressGenerator: Seed %d generated %d parts, %d connections in %.1f ms (spawn %.1f ms, snap points %.1f ms, overlap detection %s)"),
+		Seed, GeneratedParts.Num(), Edges.Num(), (EndTime - StartTime) * 1000.0, (SpawnTime - StartTime) * 1000.0, (EndTime - SpawnTime) * 1000.0,
+		bUseOverlapDetection ? TEXT("on") : TEXT("off"));
+
+	// Spawned during play: everything has already begun play, so connect right away
+	if (World->IsGameWorld() && HasActorBegunPlay() && bConnectOnBeginPlay)
+	{
+		ConnectGenerated();
+	}
+}
+
+USnapPointComponent* AAssemblyStressGenerator::AddSnapPoint(APartActor* Part, FName SnapID, FName CompatibleSnapID, int32 SlotIndex)
+{
+	USnapPointComponent* SnapPoint = NewObject<USnapPointComponent>(Part, NAME_None, Part->GetWorld()->IsGameWorld() ? RF_Transient : RF_Transactional);
+	SnapPoint->SnapID = SnapID;
+	SnapPoint->CompatibleSnapIDs.Add(CompatibleSnapID);
+	SnapPoint->bUseOverlapDetection = bUseOverlapDetection;
+	SnapPoint->CreationMethod = EComponentCreationMethod::Instance;
+	SnapPoint->SetupAttachment(Part->Assembly);
+
+	// Golden-angle spiral keeps any number of snap points apart on the part
+	const float Angle = SlotIndex * 2.39996323f;
+	SnapPoint->SetRelativeLocation(FVector(FMath::Cos(Angle) * 8.0f, FMath::Sin(Angle) * 8.0f, (SlotIndex % 3 - 1) * 3.0f));
+	SnapPoint->SetRelativeRotation(FRotator(0.0f, FMath::RadiansToDegrees(Angle), 0.0f));
+
+	Part->AddInstanceComponent(SnapPoint);
+	SnapPoint->RegisterComponent();
+	return SnapPoint;
+}
+
+void AAssemblyStressGenerator::ConnectGenerated()
+{
+	if (!Assembly)
+	{
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	int32 NumConnected = 0;
+	Assembly->BeginChangeBatch();
+	if (RootSnapPoint && Assembly->BaseSnapPoints.Num() > 0 && GeneratedParts.Num() > 0)
+	{
+		NumConnected += Assembly->ConnectParts(nullptr, GeneratedParts[0], Assembly->BaseSnapPoints[0], RootSnapPoint) ? 1 : 0;
+	}
+	for (const FAssemblyStressEdge& Edge : Edges)
+	{
+		NumConnected += Assembly->ConnectParts(Edge.Child, Edge.Parent, Edge.ChildSnapPoint, Edge.ParentSnapPoint) ? 1 : 0;
+	}
+	Assembly->EndChangeBatch();
+
+	UE_LOG(LogTemp, Log, TEXT("AAssemblyStressGenerator: Connected %d / %d in %.1f ms, %d sub-assemblies"),
+		NumConnected, Edges.Num() + (RootSnapPoint ? 1 : 0), (FPlatformTime::Seconds() - StartTime) * 1000.0, Assembly->GetNumSubAssemblies());
+}
+
+void AAssemblyStressGenerator::ClearGenerated()
+{
+	for (APartActor* Part : GeneratedParts)
+	{
+		if (IsValid(Part))
+		{
+			Part->Destroy();
+		}
+	}
+	GeneratedParts.Reset();
+	Edges.Reset();
+	RootSnapPoint = nullptr;
+
+	if (IsValid(Assembly))
+	{
+		Assembly->Destroy();
+	}
+	Assembly = nullptr;
+}
+
+static FAutoConsoleCommandWithWorldAndArgs GAssemblyGenerateStressCommand(
+	TEXT("Assembly.GenerateStress"),
+	TEXT("Spawn a synthetic assembly for scale testing. ")
+	TEXT("Args: Parts=1000 Seed=1 Topology=Tree|Graph Kinds=8 Branching=3 ExtraEdges=0.2 Decoys=2 Spacing=40 Overlap=0 Connect=1"),
+	FConsoleCommandWithWorldAndArgsDelegate::CreateLambda([](const TArray<FString>& Args, UWorld* World)
+	{
+		if (!World)
+		{
+			return;
+		}
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		if (AAssemblyStressGenerator* Generator = World->SpawnActor<AAssemblyStressGenerator>(AAssemblyStressGenerator::StaticClass(), FTransform::Identity, SpawnParams))
+		{
+			Generator->ApplyArgs(Args);
+			Generator->Generate();
+		}
+	}));
@@ -0,0 +1,213 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AssemblyTickSubsystem.h"
+#include "AssemblyActor.h"
+#include "AssemblyAllocationCounter.h"
+#include "AssemblyStats.h"
+#include "HeldPartNetComponent.h"
+#include "PartActor.h"
+#include "Engine/World.h"
+
+static TAutoConsoleVariable<float> CVarHeldPartRate(
+	TEXT("Assembly.Tick.HeldPartRate"),
+	0.0f,
+	TEXT("Times per second held parts run their per-frame work (snap preview tracking). 0 runs it every frame; parts still apply their own PreviewTrackingRate."));
+
+static TAutoConsoleVariable<float> CVarCleanupSweepInterval(
+	TEXT("Assembly.Tick.CleanupSweepInterval"),
+	0.0f,
+	TEXT("Seconds between full sweeps of every assembly for stale connections. 0 relies on invalidation callbacks only."));
+
+static TAutoConsoleVariable<bool> CVarReportHeldPartAllocations(
+	TEXT("Assembly.Tick.ReportHeldPartAllocations"),
+	false,
+	TEXT("Warn whenever held-part work (snap preview tracking) allocates on the heap. Needs -AssemblyAllocCounter."));
+
+void UAssemblyTickSubsystem::Deinitialize()
+{
+	HeldParts.Empty();
+	HeldPartNet.Empty();
+	Assemblies.Empty();
+	DirtyAssemblies.Empty();
+
+	Super::Deinitialize();
+}
+
+UAssemblyTickSubsystem* UAssemblyTickSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<UAssemblyTickSubsystem>() : nullptr;
+}
+
+TStatId UAssemblyTickSubsystem::GetStatId() const
+{
+	RETURN_QUICK_DECLARE_CYCLE_STAT(UAssemblyTickSubsystem, STATGROUP_Tickables);
+}
+
+void UAssemblyTickSubsystem::RegisterHeldPart(APartActor* Part)
+{
+	if (Part)
+	{
+		HeldParts.AddUnique(Part);
+	}
+}
+
+void UAssemblyTickSubsystem::UnregisterHeldPart(APartActor* Part)
+{
+	HeldParts.RemoveSwap(Part, EAllowShrinking::No);
+}
+
+void UAssemblyTickSubsystem::RegisterHeldPartNet(UHeldPartNetComponent* Component)
+{
+	if (Component)
+	{
+		HeldPartNet.AddUnique(Component);
+	}
+}
+
+void UAssemblyTickSubsystem::UnregisterHeldPartNet(UHeldPartNetComponent* Component)
+{
+	HeldPartNet.RemoveSwap(Component, EAllowShrinking::No);
+}
+
+void UAssemblyTickSubsystem::RegisterAssembly(AAssemblyActor* Assembly)
+{
+	if (Assembly)
+	{
+		Assemblies.AddUnique(Assembly);
+	}
+}
+
+void UAssemblyTickSubsystem::UnregisterAssembly(AAssemblyActor* Assembly)
+{
+	Assemblies.RemoveSwap(Assembly, EAllowShrinking::No);
+	DirtyAssemblies.RemoveSwap(Assembly, EAllowShrinking::No);
+}
+
+void UAssemblyTickSubsystem::MarkAssemblyDirty(AAssemblyActor* Assembly)
+{
+	if (Assembly)
+	{
+		DirtyAssemblies.AddUnique(Assembly);
+	}
+}
+
+void UAssemblyTickSubsystem::Tick(float DeltaTime)
+{
+	Super::Tick(DeltaTime);
+
+	TickHeldParts(DeltaTime);
+	TickHeldPartNet(DeltaTime);
+	TickAssemblyCleanup(DeltaTime);
+
+	int32 NumConnections = 0;
+	for (const TWeakObjectPtr<AAssemblyActor>& Assembly : Assemblies)
+	{
+		if (const AAssemblyActor* AssemblyActor = Assembly.Get())
+		{
+			NumConnections += AssemblyActor->Connections.Num();
+		}
+	}
+	SET_DWORD_STAT(STAT_Assembly_HeldParts, HeldParts.Num());
+	SET_DWORD_STAT(STAT_Assembly_Connections, NumConnections);
+	CSV_CUSTOM_STAT(Assembly, HeldParts, HeldParts.Num(), ECsvCustomStatOp::Set);
+	CSV_CUSTOM_STAT(Assembly, Connections, NumConnections, ECsvCustomStatOp::Set);
+}
+
+void UAssemblyTickSubsystem::TickHeldParts(float DeltaTime)
+{
+	if (HeldParts.Num() == 0)
+	{
+		HeldPartAccumulator = 0.0f;
+		return;
+	}
+
+	HeldPartAccumulator += DeltaTime;
+	const float Rate = CVarHeldPartRate.GetValueOnGameThread();
+	if (Rate > 0.0f && HeldPartAccumulator < 1.0f / Rate)
+	{
+		return;
+	}
+	const float ElapsedTime = HeldPartAccumulator;
+	HeldPartAccumulator = 0.0f;
+
+	TOptional<FAssemblyAllocationScope> AllocationScope;
+	if (CVarReportHeldPartAllocations.GetValueOnGameThread())
+	{
+		AllocationScope.Emplace();
+	}
+
+	// Iterate backwards, a part may release itself while ticking
+	for (int32 Index = HeldParts.Num() - 1; Index >= 0; --Index)
+	{
+		if (!HeldParts.IsValidIndex(Index))
+		{
+			continue;
+		}
+		APartActor* Part = HeldParts[Index].Get();
+		if (!Part)
+		{
+			HeldParts.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			continue;
+		}
+		Part->TickPreviewTracking(ElapsedTime);
+	}
+
+	if (AllocationScope.IsSet() && AllocationScope->GetNumAllocations() > 0)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("UAssemblyTickSubsystem: Held part tick made %llu heap allocations"),
+			AllocationScope->GetNumAllocations());
+	}
+}
+
+void UAssemblyTickSubsystem::TickHeldPartNet(float DeltaTime)
+{
+	// Iterate backwards, a component may unregister itself while ticking
+	for (int32 Index = HeldPartNet.Num() - 1; Index >= 0; --Index)
+	{
+		if (!HeldPartNet.IsValidIndex(Index))
+		{
+			continue;
+		}
+		UHeldPartNetComponent* Component = HeldPartNet[Index].Get();
+		if (!Component)
+		{
+			HeldPartNet.RemoveAtSwap(Index, 1, EAllowShrinking::No);
+			continue;
+		}
+		Component->TickNet(DeltaTime);
+	}
+}
+
+void UAssemblyTickSubsystem::TickAssemblyCleanup(float DeltaTime)
+{
+	const float SweepInterval = CVarCleanupSweepInterval.GetValueOnGameThread();
+	if (SweepInterval > 0.0f)
+	{
+		CleanupSweepAccumulator += DeltaTime;
+		if (CleanupSweepAccumulator >= SweepInterval)
+		{
+			CleanupSweepAccumulator = 0.0f;
+			for (const TWeakObjectPtr<AAssemblyActor>& Assembly : Assemblies)
+			{
+				DirtyAssemblies.AddUnique(Assembly);
+			}
+		}
+	}
+
+	if (DirtyAssemblies.Num() == 0)
+	{
+		return;
+	}
+
+	// Cleanup can invalidate more; anything it marks is handled next tick
+	TArray<TWeakObjectPtr<AAssemblyActor>> ToClean = MoveTemp(DirtyAssemblies);
+	DirtyAssemblies.Reset();
+	for (const TWeakObjectPtr<AAssemblyActor>& Assembly : ToClean)
+	{
+		if (AAssemblyActor* AssemblyActor = Assembly.Get())
+		{
+			AssemblyActor->CleanupInvalidConstraints();
+		}
+	}
+}
@@ -0,0 +1,256 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AssemblyTransaction.h"
+#include "PartActor.h"
+#include "SnapPointComponent.h"
+
+FAssemblyTransaction::FAssemblyTransaction(AAssemblyActor& InAssembly)
+	: Assembly(InAssembly)
+{
+}
+
+FAssemblyTransaction::~FAssemblyTransaction()
+{
+	if (!bDone && Operations.Num() > 0)
+	{
+		Commit();
+	}
+}
+
+void FAssemblyTransaction::Connect(APartActor* PartA, APartActor* PartB, USnapPointComponent* SnapPointA, USnapPointComponent* SnapPointB)
+{
+	FOperation& Operation = Operations.AddDefaulted_GetRef();
+	Operation.Type = EOperation::Connect;
+	Operation.PartA = PartA;
+	Operation.PartB = PartB;
+	Operation.SnapPointA = SnapPointA;
+	Operation.SnapPointB = SnapPointB;
+	bDone = false;
+}
+
+void FAssemblyTransaction::Disconnect(APartActor* PartA, APartActor* PartB)
+{
+	FOperation& Operation = Operations.AddDefaulted_GetRef();
+	Operation.Type = EOperation::DisconnectParts;
+	Operation.PartA = PartA;
+	Operation.PartB = PartB;
+	bDone = false;
+}
+
+void FAssemblyTransaction::Disconnect(FAssemblyConnectionHandle Handle)
+{
+	FOperation& Operation = Operations.AddDefaulted_GetRef();
+	Operation.Type = EOperation::DisconnectHandle;
+	Operation.Handle = Handle;
+	bDone = false;
+}
+
+void FAssemblyTransaction::Cancel()
+{
+	Operations.Reset();
+	bDone = true;
+}
+
+bool FAssemblyTransaction::Commit()
+{
+	bDone = true;
+	if (!Validate())
+	{
+		Operations.Reset();
+		return false;
+	}
+
+	Assembly.BeginChangeBatch();
+	TArray<FApplied, TInlineAllocator<8>> Applied;
+	int32 FailedIndex = INDEX_NONE;
+	for (int32 Index = 0; Index < Operations.Num(); ++Index)
+	{
+		bool bForceFail = false;
+#if WITH_DEV_AUTOMATION_TESTS
+		bForceFail = Index == FailOperationForTesting;
+#endif
+		FApplied Record;
+		if (bForceFail || !Apply(Operations[Index], Record))
+		{
+			FailedIndex = Index;
+			break;
+		}
+		Applied.Add(MoveTemp(Record));
+	}
+
+	if (FailedIndex != INDEX_NONE)
+	{
+		// Validation mirrors the checks in ConnectParts, so this means the two have drifted apart
+		UE_LOG(LogTemp, Error, TEXT("FAssemblyTransaction::Commit: Operation %d of %d failed to apply after validating, undoing %d"),
+			FailedIndex + 1, Operations.Num(), Applied.Num());
+		for (int32 Index = Applied.Num() - 1; Index >= 0; --Index)
+		{
+			const FPartConnection& Connection = Applied[Index].Connection;
+			const bool bUndone = Applied[Index].bConnected
+				? Assembly.DisconnectConnection(Connection.Handle)
+				: Assembly.ConnectParts(Connection.PartA, Connection.PartB, Connection.SnapPointA, Connection.SnapPointB);
+			if (!bUndone)
+			{
+				UE_LOG(LogTemp, Error, TEXT("FAssemblyTransaction::Commit: Could not undo operation %d"), Index + 1);
+			}
+		}
+	}
+	Assembly.EndChangeBatch();
+
+	Operations.Reset();
+	return FailedIndex == INDEX_NONE;
+}
+
+bool FAssemblyTransaction::Apply(const FOperation& Operation, FApplied& OutApplied)
+{
+	const FPartConnection* Connection = nullptr;
+	switch (Operation.Type)
+	{
+	case EOperation::Connect:
+		if (!Assembly.ConnectParts(Operation.PartA, Operation.PartB, Operation.SnapPointA, Operation.SnapPointB))
+		{
+			return false;
+		}
+		Connection = Assembly.ResolveConnection(Assembly.FindConnectionBySnapPoints(Operation.SnapPointA, Operation.SnapPointB));
+		OutApplied.bConnected = true;
+		break;
+	case EOperation::DisconnectParts:
+		Connection = Assembly.FindConnectionPtr(Operation.PartA, Operation.PartB);
+		break;
+	case EOperation::DisconnectHandle:
+		Connection = Assembly.ResolveConnection(Operation.Handle);
+		break;
+	}
+	if (!Connection)
+	{
+		return false;
+	}
+
+	// Copy before disconnecting; the record goes away with the connection
+	OutApplied.Connection = *Connection;
+	return OutApplied.bConnected || Assembly.DisconnectConnection(Connection->Handle);
+}
+
+bool FAssemblyTransaction::Validate() const
+{
+	// Assembly state as the operations so far would leave it
+	TMap<const USnapPointComponent*, bool> SnapPointAssembled;
+	TSet<FAssemblyConnectionHandle> Removed;
+	TArray<const FOperation*> Added;
+
+	auto IsAssembled = [&SnapPointAssembled](const USnapPointComponent* SnapPoint)
+	{
+		const bool* Override = SnapPointAssembled.Find(SnapPoint);
+		return Override ? *Override : SnapPoint->bIsAssembled;
+	};
+	auto IsPair = [](const APartActor* A, const APartActor* B, const APartActor* OtherA, const APartActor* OtherB)
+	{
+		return (A == OtherA && B == OtherB) || (A == OtherB && B == OtherA);
+	};
+	auto FindAdded = [&Added, &IsPair](const APartActor* A, const APartActor* B)
+	{
+		return Added.IndexOfByPredicate([&](const FOperation* Operation)
+		{
+			return IsPair(A, B, Operation->PartA, Operation->PartB);
+		});
+	};
+	auto FindExisting = [this, &Removed](const APartActor* A, const APartActor* B) -> const FPartConnection*
+	{
+		const FPartConnection* Connection = Assembly.FindConnectionPtr(A, B);
+		return Connection && !Removed.Contains(Connection->Handle) ? Connection : nullptr;
+	};
+	auto Free = [&SnapPointAssembled](const USnapPointComponent* SnapPointA, const USnapPointComponent* SnapPointB)
+	{
+		if (SnapPointA)
+		{
+			SnapPointAssembled.Add(SnapPointA, false);
+		}
+		if (SnapPointB)
+		{
+			SnapPointAssembled.Add(SnapPointB, false);
+		}
+	};
+
+	for (int32 Index = 0; Index < Operations.Num(); ++Index)
+	{
+		const FOperation& Operation = Operations[Index];
+		const TCHAR* Error = nullptr;
+
+		switch (Operation.Type)
+		{
+		case EOperation::Connect:
+		{
+			if (!Operation.SnapPointA || !Operation.SnapPointB || (!Operation.PartA && !Operation.PartB))
+			{
+				Error = TEXT("invalid input parameters");
+			}
+			// Base connections are not keyed by pair, same as ConnectParts
+			else if (Operation.PartA && Operation.PartB &&
+				(FindExisting(Operation.PartA, Operation.PartB) || FindAdded(Operation.PartA, Operation.PartB) != INDEX_NONE))
+			{
+				Error = TEXT("parts already connected");
+			}
+			else if (!Operation.SnapPointA->CanMutuallyAccept(Operation.SnapPointB))
+			{
+				Error = TEXT("snap points not compatible");
+			}
+			else if (IsAssembled(Operation.SnapPointA) || IsAssembled(Operation.SnapPointB))
+			{
+				Error = TEXT("snap point already assembled");
+			}
+			else
+			{
+				SnapPointAssembled.Add(Operation.SnapPointA, true);
+				SnapPointAssembled.Add(Operation.SnapPointB, true);
+				Added.Add(&Operation);
+			}
+			break;
+		}
+		case EOperation::DisconnectParts:
+		{
+			const int32 AddedIndex = (Operation.PartA && Operation.PartB) ? FindAdded(Operation.PartA, Operation.PartB) : INDEX_NONE;
+			if (!Operation.PartA || !Operation.PartB)
+			{
+				Error = TEXT("invalid input parameters");
+			}
+			else if (AddedIndex != INDEX_NONE)
+			{
+				Free(Added[AddedIndex]->SnapPointA, Added[AddedIndex]->SnapPointB);
+				Added.RemoveAt(AddedIndex);
+			}
+			else if (const FPartConnection* Connection = FindExisting(Operation.PartA, Operation.PartB))
+			{
+				Free(Connection->SnapPointA, Connection->SnapPointB);
+				Removed.Add(Connection->Handle);
+			}
+			else
+			{
+				Error = TEXT("no connection between parts");
+			}
+			break;
+		}
+		case EOperation::DisconnectHandle:
+		{
+			const FPartConnection* Connection = Assembly.ResolveConnection(Operation.Handle);
+			if (!Connection || Removed.Contains(Operation.Handle))
+			{
+				Error = TEXT("stale connection handle");
+			}
+			else
+			{
+				Free(Connection->SnapPointA, Connection->SnapPointB);
+				Removed.Add(Operation.Handle);
+			}
+			break;
+		}
+		}
+
+		if (Error)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("FAssemblyTransaction::Validate: Operation %d of %d rejected (%s), nothing applied"),
+				Index + 1, Operations.Num(), Error);
+			return false;
+		}
+	}
+	return true;
+}
@@ -2,15 +2,15 @@
 
 
 #include "GrabComponent.h"
+#include "AssemblyAssetSubsystem.h"
 #include "MotionControllerComponent.h"
 #include "PartActor.h"
 
 // Sets default values for this component's properties
 UGrabComponent::UGrabComponent()
 {
-	// Set this component to be initialized when the game starts, and to be ticked every frame.  You can turn these features
-	// off to improve performance if you don't need them.
-	PrimaryComponentTick.bCanEverTick = true;
+	// Set this component to be initialized when the game starts. Grabbing is event driven, so it never ticks.
+	PrimaryComponentTick.bCanEverTick = false;
 	PrimaryGrabRelativeRotation = FRotator::ZeroRotator;
 	
 	// ...
@@ -31,6 +31,13 @@ bool UGrabComponent::TryGrab(UMotionControllerComponent* MotionController, bool
 		return false;
 	}
 
+	// Lesson assets are still streaming in
+	const UAssemblyAssetSubsystem* AssetSubsystem = UAssemblyAssetSubsystem::Get(this);
+	if (AssetSubsystem && !AssetSubsystem->IsInteractionEnabled())
+	{
+		return false;
+	}
+
 	// Store grab rotation for secondary grab
 	
 	// Get the parent component (what the macro attaches)
@@ -78,8 +85,13 @@ bool UGrabComponent::TryGrab(UMotionControllerComponent* MotionController, bool
 		return false;
 	}
 
-	// Play haptic feedback
-	if (OnGrabHapticEffect)
+	// Play haptic feedback, the level's shared grab haptic unless this component sets its own
+	UHapticFeedbackEffect_Base* HapticEffect = OnGrabHapticEffect;
+	if (!HapticEffect && AssetSubsystem)
+	{
+		HapticEffect = AssetSubsystem->GetGrabHapticEffect();
+	}
+	if (HapticEffect)
 	{
 		// Get the player controller from the motion controller's owner
 		if (const APawn* Pawn = Cast<APawn>(MotionController->GetOwner()))
@@ -92,7 +104,7 @@ bool UGrabComponent::TryGrab(UMotionControllerComponent* MotionController, bool
 				{
 					Hand = EControllerHand::Right;
 				}
-				PC->PlayHapticEffect(OnGrabHapticEffect, Hand);
+				PC->PlayHapticEffect(HapticEffect, Hand);
 			}
 		}
 	}
@@ -166,12 +178,3 @@ void UGrabComponent::BeginPlay()
 	
 }
 
-
-// Called every frame
-void UGrabComponent::TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction)
-{
-	Super::TickComponent(DeltaTime, TickType, ThisTickFunction);
-
-	// ...
-}
-
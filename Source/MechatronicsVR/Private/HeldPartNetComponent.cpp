@@ -0,0 +1,464 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "HeldPartNetComponent.h"
+#include "AssemblyActor.h"
+#include "AssemblyNetComponent.h"
+#include "AssemblyReplication.h"
+#include "AssemblyTickSubsystem.h"
+#include "GrabComponent.h"
+#include "PartActor.h"
+#include "Engine/NetSerialization.h"
+#include "Engine/World.h"
+#include "GameFramework/Pawn.h"
+#include "Net/UnrealNetwork.h"
+#include "UObject/CoreNet.h"
+
+static TAutoConsoleVariable<float> CVarHeldPartRate(
+	TEXT("Assembly.Net.HeldPartRate"),
+	20.0f,
+	TEXT("Held-part pose samples sent per second by the machine holding the part. 0 sends one every frame."));
+
+static TAutoConsoleVariable<float> CVarHeldPartInterpDelay(
+	TEXT("Assembly.Net.HeldPartInterpDelay"),
+	0.1f,
+	TEXT("Seconds remote viewers render a held part behind its newest sample. About two send intervals hides jitter."));
+
+static TAutoConsoleVariable<float> CVarHeldPartMaxExtrapolation(
+	TEXT("Assembly.Net.HeldPartMaxExtrapolation"),
+	0.2f,
+	TEXT("Seconds remote viewers keep extrapolating a held part past its newest sample before holding it still."));
+
+static TAutoConsoleVariable<bool> CVarHeldPartReplication(
+	TEXT("Assembly.Net.HeldPartReplication"),
+	true,
+	TEXT("Replicate held parts as quantized holder-relative samples. 0 uses default actor movement replication instead, for comparison."));
+
+bool UHeldPartNetComponent::IsSampleReplicationEnabled()
+{
+	return CVarHeldPartReplication.GetValueOnGameThread();
+}
+
+bool FHeldPartSample::NetSerialize(FArchive& Ar, UPackageMap* Map, bool& bOutSuccess)
+{
+	// Offsets from the holder are within arm's reach, so 1 mm needs few bits per component
+	bOutSuccess = SerializePackedVector<10, 24>(Location, Ar);
+	Rotation.SerializeCompressedShort(Ar);
+	Ar << Sequence;
+	return true;
+}
+
+UHeldPartNetComponent::UHeldPartNetComponent()
+{
+	// Ticked by UAssemblyTickSubsystem only while the part is held somewhere
+	PrimaryComponentTick.bCanEverTick = false;
+	SetIsReplicatedByDefault(true);
+}
+
+void UHeldPartNetComponent::GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const
+{
+	Super::GetLifetimeReplicatedProps(OutLifetimeProps);
+
+	DOREPLIFETIME(UHeldPartNetComponent, HeldBy);
+	DOREPLIFETIME(UHeldPartNetComponent, HeldSample);
+}
+
+void UHeldPartNetComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	SetTicking(false);
+
+	Super::EndPlay(EndPlayReason);
+}
+
+APartActor* UHeldPartNetComponent::GetPart() const
+{
+	return Cast<APartActor>(GetOwner());
+}
+
+// ================== HOLDER ==================
+
+void UHeldPartNetComponent::BeginLocalHold(AActor* Holder)
+{
+	APartActor* Part = GetPart();
+	if (!Holder || !Part || Part->GetNetMode() == NM_Standalone)
+	{
+		return;
+	}
+
+	LocalHolder = Holder;
+	LastSentLocation = Part->GetActorLocation();
+	SendAccumulator = 0.0f;
+	SetTicking(true);
+
+	if (Part->HasAuthority())
+	{
+		// A listen server's own grab loses to a client's the same way
+		if (HeldBy && HeldBy != Holder)
+		{
+			AssemblyNetStats::RecordHoldRejected();
+			HandleHoldRejected();
+			return;
+		}
+		HeldBy = Holder;
+		bHasSequence = false;
+		Part->UpdateMovementReplication();
+		Part->ForceNetUpdate();
+	}
+	else if (UAssemblyNetComponent* NetComponent = UAssemblyNetComponent::FindLocal(this))
+	{
+		NetComponent->ServerBeginHeldPart(Part);
+	}
+}
+
+void UHeldPartNetComponent::EndLocalHold()
+{
+	APartActor* Part = GetPart();
+	if (!Part || !IsLocallyHeld())
+	{
+		return;
+	}
+
+	const FHeldPartSample FinalSample = MakeSample();
+	LocalHolder.Reset();
+	SetTicking(RemoteHolder.IsValid());
+
+	if (Part->HasAuthority())
+	{
+		HeldSample = FinalSample;
+		HeldBy = nullptr;
+		Part->UpdateMovementReplication();
+		Part->ForceNetUpdate();
+	}
+	else if (UAssemblyNetComponent* NetComponent = UAssemblyNetComponent::FindLocal(this))
+	{
+		NetComponent->ServerEndHeldPart(Part, FinalSample);
+	}
+}
+
+FHeldPartSample UHeldPartNetComponent::MakeSample()
+{
+	FHeldPartSample Sample;
+	const APartActor* Part = GetPart();
+	const AActor* Holder = LocalHolder.Get();
+	if (Part && Holder)
+	{
+		const FTransform Relative = Part->GetActorTransform().GetRelativeTransform(Holder->GetActorTransform());
+		Sample.Location = Relative.GetLocation();
+		Sample.Rotation = Relative.Rotator();
+	}
+	Sample.Sequence = NextSequence++;
+	return Sample;
+}
+
+void UHeldPartNetComponent::SendSample(float Elapsed)
+{
+	APartActor* Part = GetPart();
+	if (!Part)
+	{
+		return;
+	}
+
+	const FHeldPartSample Sample = MakeSample();
+	if (Part->HasAuthority())
+	{
+		HandleSample(Sample);
+	}
+	else if (UAssemblyNetComponent* NetComponent = UAssemblyNetComponent::FindLocal(this))
+	{
+		NetComponent->ServerUpdateHeldPart(Part, Sample);
+	}
+
+	// Payload sizes of this sample and of the FRepMovement default replication would send for the same pose
+	FNetBitWriter SampleWriter(nullptr, 256);
+	bool bSuccess = true;
+	FHeldPartSample(Sample).NetSerialize(SampleWriter, nullptr, bSuccess);
+
+	FRepMovement Movement = Part->GetReplicatedMovement();
+	Movement.Location = Part->GetActorLocation();
+	Movement.Rotation = Part->GetActorRotation();
+	Movement.LinearVelocity = Elapsed > 0.0f ? (Movement.Location - LastSentLocation) / Elapsed : FVector::ZeroVector;
+	Movement.bRepPhysics = false;
+	FNetBitWriter MovementWriter(nullptr, 1024);
+	Movement.NetSerialize(MovementWriter, nullptr, bSuccess);
+	LastSentLocation = Movement.Location;
+
+	AssemblyNetStats::RecordHeldPartSample(Elapsed, SampleWriter.GetNumBits(), MovementWriter.GetNumBits(), Part->GetNetUpdateFrequency());
+}
+
+// ================== SERVER ==================
+
+bool UHeldPartNetComponent::HandleHoldBegun(AActor* Holder)
+{
+	// First hand wins; a second grab elsewhere is not taken over
+	if (!Holder || (HeldBy && HeldBy != Holder))
+	{
+		return false;
+	}
+
+	HeldBy = Holder;
+	bHasSequence = false;
+	BeginRemoteHold(Holder);
+	if (APartActor* Part = GetPart())
+	{
+		Part->UpdateMovementReplication();
+	}
+	GetOwner()->ForceNetUpdate();
+	return true;
+}
+
+void UHeldPartNetComponent::HandleSample(const FHeldPartSample& Sample)
+{
+	APartActor* Part = GetPart();
+	if (!HeldBy || !Part)
+	{
+		return;
+	}
+
+	// Unreliable samples can arrive out of order
+	if (bHasSequence && static_cast<int8>(Sample.Sequence - LastSequence) <= 0)
+	{
+		return;
+	}
+	LastSequence = Sample.Sequence;
+	bHasSequence = true;
+
+	if (IsSampleReplicationEnabled())
+	{
+		HeldSample = Sample;
+		if (!IsLocallyHeld())
+		{
+			BufferSample(Sample);
+		}
+		return;
+	}
+
+	// Comparison path: place the server's copy and let default movement replication carry it. The holder
+	// discards that pose (APartActor::OnRep_ReplicatedMovement), the same as a skip-owner condition would.
+	Part->UpdateMovementReplication();
+	if (!IsLocallyHeld())
+	{
+		Part->SetActorTransform(Sample.ToTransform() * HeldBy->GetActorTransform());
+	}
+}
+
+void UHeldPartNetComponent::HandleHoldEnded(const FHeldPartSample& FinalSample)
+{
+	APartActor* Part = GetPart();
+	if (!HeldBy || !Part)
+	{
+		return;
+	}
+
+	HeldSample = FinalSample;
+	HeldBy = nullptr;
+	EndRemoteHold();
+	Part->UpdateMovementReplication();
+	Part->ForceNetUpdate();
+}
+
+void UHeldPartNetComponent::HandleHoldRejected()
+{
+	APartActor* Part = GetPart();
+	if (!Part || !IsLocallyHeld())
+	{
+		return;
+	}
+
+	// The server never had our hold, so there is nothing to end there and no snap to request
+	LocalHolder.Reset();
+	SetTicking(RemoteHolder.IsValid());
+	Part->HideSnapPreview();
+	Part->CurrentTargetSnapPoint = nullptr;
+	if (Part->GrabComponent && Part->GrabComponent->IsGrabbed())
+	{
+		Part->GrabComponent->TryRelease();
+	}
+
+	// The real holder's HeldBy may have arrived while we still held it; follow their samples from now on
+	OnRep_HeldBy();
+}
+
+// ================== REMOTE VIEWERS ==================
+
+void UHeldPartNetComponent::OnRep_HeldBy()
+{
+	// Our own hold coming back from the server, possibly after we let go
+	const APawn* HolderPawn = Cast<APawn>(HeldBy);
+	if (IsLocallyHeld() || (HolderPawn && HolderPawn->IsLocallyControlled()))
+	{
+		return;
+	}
+
+	if (HeldBy)
+	{
+		if (RemoteHolder.Get() != HeldBy)
+		{
+			BeginRemoteHold(HeldBy);
+		}
+	}
+	else if (RemoteHolder.IsValid())
+	{
+		EndRemoteHold();
+	}
+}
+
+void UHeldPartNetComponent::OnRep_HeldSample()
+{
+	if (RemoteHolder.IsValid() && !IsLocallyHeld())
+	{
+		BufferSample(HeldSample);
+	}
+}
+
+void UHeldPartNetComponent::BeginRemoteHold(AActor* Holder)
+{
+	APartActor* Part = GetPart();
+	if (!Part)
+	{
+		return;
+	}
+
+	RemoteHolder = Holder;
+	Samples.Reset();
+	if (UPrimitiveComponent* RootPrimitive = Cast<UPrimitiveComponent>(Part->GetRootComponent()))
+	{
+		RootPrimitive->SetSimulatePhysics(false);
+	}
+	SetTicking(true);
+}
+
+void UHeldPartNetComponent::EndRemoteHold()
+{
+	APartActor* Part = GetPart();
+	const AActor* Holder = RemoteHolder.Get();
+	RemoteHolder.Reset();
+	Samples.Reset();
+	SetTicking(IsLocallyHeld());
+	if (!Part)
+	{
+		return;
+	}
+
+	// A connect made on release has already placed and frozen the part
+	const AAssemblyActor* Assembly = Part->GetAssemblyActor();
+	if (Assembly && Assembly->GetConnectionHandles(Part).Num() > 0)
+	{
+		return;
+	}
+
+	// Land exactly where the holder let go
+	if (Holder)
+	{
+		Part->SetActorTransform(HeldSample.ToTransform() * Holder->GetActorTransform());
+	}
+	if (Part->GrabComponent && Part->GrabComponent->bSimulateOnDrop)
+	{
+		if (UPrimitiveComponent* RootPrimitive = Cast<UPrimitiveComponent>(Part->GetRootComponent()))
+		{
+			RootPrimitive->SetSimulatePhysics(true);
+		}
+	}
+}
+
+void UHeldPartNetComponent::BufferSample(const FHeldPartSample& Sample)
+{
+	if (Samples.Num() >= MaxBufferedSamples)
+	{
+		Samples.RemoveAt(0, 1, EAllowShrinking::No);
+	}
+	FTimedSample& Timed = Samples.AddDefaulted_GetRef();
+	Timed.Transform = Sample.ToTransform();
+	Timed.ReceiveTime = GetWorld()->GetTimeSeconds();
+}
+
+void UHeldPartNetComponent::ApplyInterpolatedPose()
+{
+	APartActor* Part = GetPart();
+	const AActor* Holder = RemoteHolder.Get();
+	if (!Part || !Holder || Samples.Num() == 0)
+	{
+		return;
+	}
+
+	const double RenderTime = GetWorld()->GetTimeSeconds() - CVarHeldPartInterpDelay.GetValueOnGameThread();
+	const FTimedSample& Newest = Samples.Last();
+
+	FTransform Relative = Samples[0].Transform;
+	if (Samples.Num() >= 2 && RenderTime >= Newest.ReceiveTime)
+	{
+		// Past the newest sample: carry on at the last interval's velocity, for a while
+		const FTimedSample& Previous = Samples[Samples.Num() - 2];
+		const double Interval = Newest.ReceiveTime - Previous.ReceiveTime;
+		const double Ahead = FMath::Min(RenderTime - Newest.ReceiveTime, static_cast<double>(CVarHeldPartMaxExtrapolation.GetValueOnGameThread()));
+		const float Alpha = Interval > UE_SMALL_NUMBER ? static_cast<float>(Ahead / Interval) : 0.0f;
+
+		FQuat Delta = Newest.Transform.GetRotation() * Previous.Transform.GetRotation().Inverse();
+		Delta.EnforceShortestArcWith(FQuat::Identity);
+		FVector Axis;
+		float Angle;
+		Delta.ToAxisAndAngle(Axis, Angle);
+
+		Relative.SetLocation(Newest.Transform.GetLocation() + (Newest.Transform.GetLocation() - Previous.Transform.GetLocation()) * Alpha);
+		Relative.SetRotation(FQuat(Axis, Angle * Alpha) * Newest.Transform.GetRotation());
+	}
+	else
+	{
+		for (int32 Index = Samples.Num() - 1; Index > 0; --Index)
+		{
+			const FTimedSample& Older = Samples[Index - 1];
+			const FTimedSample& Newer = Samples[Index];
+			if (RenderTime >= Older.ReceiveTime)
+			{
+				const double Interval = Newer.ReceiveTime - Older.ReceiveTime;
+				const float Alpha = Interval > UE_SMALL_NUMBER ? static_cast<float>((RenderTime - Older.ReceiveTime) / Interval) : 1.0f;
+				Relative.Blend(Older.Transform, Newer.Transform, FMath::Clamp(Alpha, 0.0f, 1.0f));
+				break;
+			}
+		}
+	}
+
+	Part->SetActorTransform(Relative * Holder->GetActorTransform());
+}
+
+// ================== TICK ==================
+
+void UHeldPartNetComponent::TickNet(float DeltaTime)
+{
+	if (IsLocallyHeld())
+	{
+		SendAccumulator += DeltaTime;
+		const float Rate = CVarHeldPartRate.GetValueOnGameThread();
+		if (Rate > 0.0f && SendAccumulator < 1.0f / Rate)
+		{
+			return;
+		}
+		const float Elapsed = SendAccumulator;
+		SendAccumulator = 0.0f;
+		SendSample(Elapsed);
+		return;
+	}
+
+	if (RemoteHolder.IsValid())
+	{
+		ApplyInterpolatedPose();
+	}
+}
+
+void UHeldPartNetComponent::SetTicking(bool bShouldTick)
+{
+	if (bShouldTick == bIsTicking)
+	{
+		return;
+	}
+	if (UAssemblyTickSubsystem* TickSubsystem = UAssemblyTickSubsystem::Get(this))
+	{
+		bIsTicking = bShouldTick;
+		if (bShouldTick)
+		{
+			TickSubsystem->RegisterHeldPartNet(this);
+		}
+		else
+		{
+			TickSubsystem->UnregisterHeldPartNet(this);
+		}
+	}
+}
@@ -0,0 +1,276 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LessonConnectionMatcher.h"
+#include "PartActor.h"
+
+void FLessonConnectionMatcher::Reset()
+{
+	Entries.Reset();
+	EntriesBySnapPair.Reset();
+	Connections.Reset();
+	Unmatched.Reset();
+	NumExpected = 0;
+	NumCorrect = 0;
+	NumOverflow = 0;
+	bIsActive = false;
+}
+
+void FLessonConnectionMatcher::Compile(const ULessonData* Lesson)
+{
+	Reset();
+	if (!Lesson)
+	{
+		return;
+	}
+
+	bIsActive = true;
+	Entries.Reserve(Lesson->ExpectedConnections.Num());
+	for (const FLessonConnection& Declaration : Lesson->ExpectedConnections)
+	{
+		if (!Declaration.PartClassA && !Declaration.PartClassB)
+		{
+			UE_LOG(LogTemp, Warning, TEXT("Lesson %s: connection %s-%s has no part class on either side, skipped"),
+				*Lesson->GetName(), *Declaration.SnapIDA.ToString(), *Declaration.SnapIDB.ToString());
+			continue;
+		}
+
+		const int32 EntryIndex = Entries.AddDefaulted();
+		FEntry& Entry = Entries[EntryIndex];
+		Entry.Declaration = Declaration;
+		Entry.Declaration.Count = FMath::Max(1, Declaration.Count);
+		NumExpected += Entry.Declaration.Count;
+
+		EntriesBySnapPair.FindOrAdd(MakeKey(Declaration.SnapIDA, Declaration.SnapIDB)).Add(EntryIndex);
+	}
+}
+
+TPair<FName, FName> FLessonConnectionMatcher::MakeKey(FName SnapIDA, FName SnapIDB)
+{
+	return SnapIDB.FastLess(SnapIDA) ? TPair<FName, FName>(SnapIDB, SnapIDA) : TPair<FName, FName>(SnapIDA, SnapIDB);
+}
+
+bool FLessonConnectionMatcher::Matches(const FLessonConnection& Declaration, const UClass* PartClassA, FName SnapIDA,
+	const UClass* PartClassB, FName SnapIDB)
+{
+	auto SideMatches = [](const TSubclassOf<APartActor>& Expected, FName ExpectedSnapID, const UClass* PartClass, FName SnapID)
+	{
+		if (ExpectedSnapID != SnapID)
+		{
+			return false;
+		}
+		// No class means the assembly base
+		const UClass* ExpectedClass = Expected.Get();
+		return ExpectedClass ? (PartClass && PartClass->IsChildOf(ExpectedClass)) : PartClass == nullptr;
+	};
+
+	return (SideMatches(Declaration.PartClassA, Declaration.SnapIDA, PartClassA, SnapIDA) &&
+			SideMatches(Declaration.PartClassB, Declaration.SnapIDB, PartClassB, SnapIDB)) ||
+		   (SideMatches(Declaration.PartClassA, Declaration.SnapIDA, PartClassB, SnapIDB) &&
+			SideMatches(Declaration.PartClassB, Declaration.SnapIDB, PartClassA, SnapIDA));
+}
+
+void FLessonConnectionMatcher::OnConnected(int32 ConnectionId, const UClass* PartClassA, FName SnapIDA,
+	const UClass* PartClassB, FName SnapIDB)
+{
+	if (!bIsActive || ConnectionId < 0)
+	{
+		return;
+	}
+
+	if (Connections.Num() <= ConnectionId)
+	{
+		Connections.SetNum(ConnectionId + 1);
+	}
+	FConnectionState& State = Connections[ConnectionId];
+	if (State.bTracked)
+	{
+		OnDisconnected(ConnectionId);
+	}
+	State = FConnectionState();
+	State.bTracked = true;
+	State.PartClassA = PartClassA;
+	State.PartClassB = PartClassB;
+	State.SnapIDA = SnapIDA;
+	State.SnapIDB = SnapIDB;
+
+	// First entry with room wins; with none free, wait on the first one that fits
+	int32 OverflowEntry = INDEX_NONE;
+	if (const TArray<int32, TInlineAllocator<1>>* Candidates = EntriesBySnapPair.Find(MakeKey(SnapIDA, SnapIDB)))
+	{
+		for (const int32 EntryIndex : *Candidates)
+		{
+			FEntry& Entry = Entries[EntryIndex];
+			if (!Matches(Entry.Declaration, PartClassA, SnapIDA, PartClassB, SnapIDB))
+			{
+				continue;
+			}
+			if (Entry.Matched.Num() < Entry.Declaration.Count)
+			{
+				Entry.Matched.Add(ConnectionId);
+				State.Entry = EntryIndex;
+				++NumCorrect;
+				return;
+			}
+			if (OverflowEntry == INDEX_NONE)
+			{
+				OverflowEntry = EntryIndex;
+			}
+		}
+	}
+
+	if (OverflowEntry != INDEX_NONE)
+	{
+		Entries[OverflowEntry].Overflow.Add(ConnectionId);
+		State.Entry = OverflowEntry;
+		State.bOverflow = true;
+		++NumOverflow;
+		return;
+	}
+
+	State.UnmatchedIndex = Unmatched.Add(ConnectionId);
+}
+
+void FLessonConnectionMatcher::OnDisconnected(int32 ConnectionId)
+{
+	if (!Connections.IsValidIndex(ConnectionId) || !Connections[ConnectionId].bTracked)
+	{
+		return;
+	}
+
+	const FConnectionState State = Connections[ConnectionId];
+	Connections[ConnectionId] = FConnectionState();
+
+	if (State.Entry == INDEX_NONE)
+	{
+		// Swap the last unmatched connection into the hole
+		Unmatched.RemoveAtSwap(State.UnmatchedIndex, 1, EAllowShrinking::No);
+		if (Unmatched.IsValidIndex(State.UnmatchedIndex))
+		{
+			Connections[Unmatched[State.UnmatchedIndex]].UnmatchedIndex = State.UnmatchedIndex;
+		}
+		return;
+	}
+
+	FEntry& Entry = Entries[State.Entry];
+	if (State.bOverflow)
+	{
+		Entry.Overflow.RemoveSwap(ConnectionId, EAllowShrinking::No);
+		--NumOverflow;
+		return;
+	}
+
+	Entry.Matched.RemoveSwap(ConnectionId, EAllowShrinking::No);
+	--NumCorrect;
+	PromoteOverflow(State.Entry);
+}
+
+void FLessonConnectionMatcher::PromoteOverflow(int32 EntryIndex)
+{
+	if (NumOverflow == 0)
+	{
+		return;
+	}
+	FEntry& Entry = Entries[EntryIndex];
+
+	// A duplicate waiting on this entry fits it by construction
+	int32 FromEntry = Entry.Overflow.Num() > 0 ? EntryIndex : INDEX_NONE;
+	int32 OverflowIndex = Entry.Overflow.Num() - 1;
+
+	// Otherwise one waiting on another entry with the same SnapIDs may fit this one as well
+	if (FromEntry == INDEX_NONE)
+	{
+		for (const int32 Candidate : EntriesBySnapPair.FindChecked(MakeKey(Entry.Declaration.SnapIDA, Entry.Declaration.SnapIDB)))
+		{
+			OverflowIndex = Entries[Candidate].Overflow.IndexOfByPredicate([this, &Entry](int32 Waiting)
+			{
+				const FConnectionState& Waiter = Connections[Waiting];
+				return Matches(Entry.Declaration, Waiter.PartClassA, Waiter.SnapIDA, Waiter.PartClassB, Waiter.SnapIDB);
+			});
+			if (OverflowIndex != INDEX_NONE)
+			{
+				FromEntry = Candidate;
+				break;
+			}
+		}
+		if (FromEntry == INDEX_NONE)
+		{
+			return;
+		}
+	}
+
+	TArray<int32>& Overflow = Entries[FromEntry].Overflow;
+	const int32 Promoted = Overflow[OverflowIndex];
+	Overflow.RemoveAtSwap(OverflowIndex, 1, EAllowShrinking::No);
+	Entry.Matched.Add(Promoted);
+	Connections[Promoted].Entry = EntryIndex;
+	Connections[Promoted].bOverflow = false;
+	--NumOverflow;
+	++NumCorrect;
+}
+
+FLessonProgress FLessonConnectionMatcher::GetProgress() const
+{
+	FLessonProgress Progress;
+	Progress.Expected = NumExpected;
+	Progress.Correct = NumCorrect;
+	Progress.Incorrect = Unmatched.Num() + NumOverflow;
+	Progress.Missing = NumExpected - NumCorrect;
+	return Progress;
+}
+
+bool FLessonConnectionMatcher::IsConnectionCorrect(int32 ConnectionId) const
+{
+	if (!Connections.IsValidIndex(ConnectionId))
+	{
+		return false;
+	}
+	const FConnectionState& State = Connections[ConnectionId];
+	return State.bTracked && State.Entry != INDEX_NONE && !State.bOverflow;
+}
+
+void FLessonConnectionMatcher::GetIncorrectConnectionIds(TArray<int32>& OutIds) const
+{
+	OutIds.Reset(Unmatched.Num() + NumOverflow);
+	OutIds.Append(Unmatched);
+	if (NumOverflow > 0)
+	{
+		for (const FEntry& Entry : Entries)
+		{
+			OutIds.Append(Entry.Overflow);
+		}
+	}
+}
+
+void FLessonConnectionMatcher::GetMissingConnections(TArray<FLessonConnection>& OutMissing) const
+{
+	OutMissing.Reset();
+	for (const FEntry& Entry : Entries)
+	{
+		const int32 Short = Entry.Declaration.Count - Entry.Matched.Num();
+		if (Short > 0)
+		{
+			FLessonConnection& Missing = OutMissing.Add_GetRef(Entry.Declaration);
+			Missing.Count = Short;
+		}
+	}
+}
+
+int32 FLessonConnectionMatcher::GetNumMatching(const FLessonConnection& Declaration) const
+{
+	if (const TArray<int32, TInlineAllocator<1>>* Candidates = EntriesBySnapPair.Find(MakeKey(Declaration.SnapIDA, Declaration.SnapIDB)))
+	{
+		for (const int32 EntryIndex : *Candidates)
+		{
+			const FLessonConnection& Entry = Entries[EntryIndex].Declaration;
+			const bool bSameOrder = Entry.PartClassA == Declaration.PartClassA && Entry.SnapIDA == Declaration.SnapIDA &&
+				Entry.PartClassB == Declaration.PartClassB && Entry.SnapIDB == Declaration.SnapIDB;
+			const bool bSwapped = Entry.PartClassA == Declaration.PartClassB && Entry.SnapIDA == Declaration.SnapIDB &&
+				Entry.PartClassB == Declaration.PartClassA && Entry.SnapIDB == Declaration.SnapIDA;
+			if (bSameOrder || bSwapped)
+			{
+				return Entries[EntryIndex].Matched.Num() + Entries[EntryIndex].Overflow.Num();
+			}
+		}
+	}
+	return INDEX_NONE;
+}
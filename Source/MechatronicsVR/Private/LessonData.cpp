@@ -0,0 +1,13 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LessonData.h"
+
+int32 ULessonData::GetNumExpectedConnections() const
+{
+	int32 Total = 0;
+	for (const FLessonConnection& Connection : ExpectedConnections)
+	{
+		Total += FMath::Max(1, Connection.Count);
+	}
+	return Total;
+}
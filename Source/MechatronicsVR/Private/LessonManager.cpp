@@ -0,0 +1,206 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LessonManager.h"
+#include "AssemblyActor.h"
+#include "AssemblyRegistrySubsystem.h"
+#include "LessonData.h"
+#include "Engine/World.h"
+
+ALessonManager::ALessonManager()
+{
+	// Steps are evaluated from assembly events only
+	PrimaryActorTick.bCanEverTick = false;
+}
+
+void ALessonManager::BeginPlay()
+{
+	Super::BeginPlay();
+
+	// The assembly may not have registered yet; start once every level actor has begun play
+	const UAssemblyRegistrySubsystem* Registry = UAssemblyRegistrySubsystem::Get(this);
+	if (Registry && Registry->HasResolvedBindings())
+	{
+		StartLesson();
+	}
+	else
+	{
+		WorldBeginPlayHandle = GetWorld()->OnWorldBeginPlay.AddUObject(this, &ALessonManager::HandleWorldBeginPlay);
+	}
+}
+
+void ALessonManager::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (WorldBeginPlayHandle.IsValid())
+	{
+		GetWorld()->OnWorldBeginPlay.Remove(WorldBeginPlayHandle);
+		WorldBeginPlayHandle.Reset();
+	}
+	UnbindAssembly();
+
+	Super::EndPlay(EndPlayReason);
+}
+
+void ALessonManager::HandleWorldBeginPlay()
+{
+	GetWorld()->OnWorldBeginPlay.Remove(WorldBeginPlayHandle);
+	WorldBeginPlayHandle.Reset();
+
+	StartLesson();
+}
+
+void ALessonManager::StartLesson()
+{
+	UnbindAssembly();
+	Steps.Reset();
+	CompiledSteps.Reset();
+	CurrentStep = INDEX_NONE;
+	NumConditionEvaluations = 0;
+	bLessonComplete = false;
+
+	if (!AssemblyActor)
+	{
+		if (const UAssemblyRegistrySubsystem* Registry = UAssemblyRegistrySubsystem::Get(this))
+		{
+			AssemblyActor = Registry->FindAssembly(AAssemblyActor::StaticClass());
+		}
+	}
+	if (!AssemblyActor)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ALessonManager %s: no assembly to run the lesson on"), *GetName());
+		return;
+	}
+
+	const ULessonData* LessonToRun = Lesson ? Lesson.Get() : AssemblyActor->Lesson.Get();
+	if (!LessonToRun)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("ALessonManager %s: no lesson set here or on %s"), *GetName(), *AssemblyActor->GetName());
+		return;
+	}
+
+	// Compile once; events then only cost the current step's predicate
+	for (ULessonStep* Step : LessonToRun->Steps)
+	{
+		if (!Step)
+		{
+			continue;
+		}
+		FCompiledStep& Compiled = CompiledSteps.AddDefaulted_GetRef();
+		Compiled.Condition = Step->CompileCondition();
+		Compiled.Events = Step->GetTriggerEvents();
+		Steps.Add(Step);
+	}
+
+	UE_LOG(LogTemp, Log, TEXT("ALessonManager %s: starting %s with %d steps"), *GetName(), *LessonToRun->GetName(), Steps.Num());
+
+	BindAssembly();
+	EnterStep(0);
+}
+
+void ALessonManager::BindAssembly()
+{
+	if (!AssemblyActor)
+	{
+		return;
+	}
+	AssemblyActor->OnAssemblyStateChanged.AddDynamic(this, &ALessonManager::HandleAssemblyStateChanged);
+	AssemblyActor->OnAssemblyChanged.AddDynamic(this, &ALessonManager::HandleAssemblyChanged);
+}
+
+void ALessonManager::UnbindAssembly()
+{
+	if (!AssemblyActor)
+	{
+		return;
+	}
+	AssemblyActor->OnAssemblyStateChanged.RemoveDynamic(this, &ALessonManager::HandleAssemblyStateChanged);
+	AssemblyActor->OnAssemblyChanged.RemoveDynamic(this, &ALessonManager::HandleAssemblyChanged);
+}
+
+void ALessonManager::EnterStep(int32 Index)
+{
+	for (; Index < CompiledSteps.Num(); ++Index)
+	{
+		CurrentStep = Index;
+		OnStepStarted.Broadcast(Index, Steps[Index]);
+
+		// A step can already be met, e.g. parts connected while an earlier step was active
+		++NumConditionEvaluations;
+		const FCompiledStep& Compiled = CompiledSteps[Index];
+		if (!Compiled.Condition || !Compiled.Condition(*AssemblyActor))
+		{
+			return;
+		}
+		OnStepCompleted.Broadcast(Index, Steps[Index]);
+	}
+
+	CurrentStep = CompiledSteps.Num();
+	bLessonComplete = true;
+	UnbindAssembly();
+
+	UE_LOG(LogTemp, Log, TEXT("ALessonManager %s: lesson complete after %d condition evaluations"), *GetName(), NumConditionEvaluations);
+	OnLessonCompleted.Broadcast();
+}
+
+void ALessonManager::AdvanceStep()
+{
+	if (!bLessonComplete && AssemblyActor && CompiledSteps.IsValidIndex(CurrentStep))
+	{
+		EnterStep(CurrentStep + 1);
+	}
+}
+
+bool ALessonManager::CheckStepCompletion()
+{
+	if (bLessonComplete || !AssemblyActor || !CompiledSteps.IsValidIndex(CurrentStep))
+	{
+		return false;
+	}
+
+	++NumConditionEvaluations;
+	const FCompiledStep& Compiled = CompiledSteps[CurrentStep];
+	if (!Compiled.Condition || !Compiled.Condition(*AssemblyActor))
+	{
+		return false;
+	}
+
+	const int32 Completed = CurrentStep;
+	OnStepCompleted.Broadcast(Completed, Steps[Completed]);
+	EnterStep(Completed + 1);
+	return true;
+}
+
+ULessonStep* ALessonManager::GetCurrentStep() const
+{
+	return Steps.IsValidIndex(CurrentStep) ? Steps[CurrentStep] : nullptr;
+}
+
+void ALessonManager::HandleEvent(ELessonStepEvent Event)
+{
+	if (CompiledSteps.IsValidIndex(CurrentStep) && EnumHasAnyFlags(CompiledSteps[CurrentStep].Events, Event))
+	{
+		CheckStepCompletion();
+	}
+}
+
+void ALessonManager::HandleAssemblyStateChanged(EAssemblyState NewState)
+{
+	HandleEvent(ELessonStepEvent::AssemblyStateChanged);
+}
+
+void ALessonManager::HandleAssemblyChanged(const FAssemblyChangeSet& Changes)
+{
+	// One evaluation per batch rather than one per connection (OnPartsConnected replays each of them)
+	ELessonStepEvent Events = ELessonStepEvent::None;
+	if (Changes.Connected.Num() > 0)
+	{
+		Events |= ELessonStepEvent::PartsConnected;
+	}
+	if (Changes.Disconnected.Num() > 0)
+	{
+		Events |= ELessonStepEvent::PartDisconnected;
+	}
+	if (Events != ELessonStepEvent::None)
+	{
+		HandleEvent(Events);
+	}
+}
@@ -0,0 +1,84 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "LessonStep.h"
+#include "PartActor.h"
+#include "SnapPointComponent.h"
+
+UAssembleStep::UAssembleStep()
+{
+	// Only a new connection can complete it
+	TriggerEvents = static_cast<int32>(ELessonStepEvent::PartsConnected);
+}
+
+FLessonStepPredicate UAssembleStep::CompileCondition() const
+{
+	const FLessonConnection Declaration = Connection;
+	const int32 Required = FMath::Max(1, Connection.Count);
+
+	return [Declaration, Required](const AAssemblyActor& Assembly)
+	{
+		// Declared by the lesson: the matcher already keeps the count
+		const int32 NumMatching = Assembly.GetLessonMatcher().GetNumMatching(Declaration);
+		if (NumMatching != INDEX_NONE)
+		{
+			return NumMatching >= Required;
+		}
+
+		int32 Found = 0;
+		for (const FPartConnection& Existing : Assembly.Connections)
+		{
+			if (FLessonConnectionMatcher::Matches(Declaration,
+				Existing.PartA ? Existing.PartA->GetClass() : nullptr, Existing.SnapPointA ? Existing.SnapPointA->SnapID : NAME_None,
+				Existing.PartB ? Existing.PartB->GetClass() : nullptr, Existing.SnapPointB ? Existing.SnapPointB->SnapID : NAME_None) &&
+				++Found >= Required)
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+}
+
+UGroundPartStep::UGroundPartStep()
+{
+	// Any connection can ground the part's sub-assembly, not just one made to the part itself
+	TriggerEvents = static_cast<int32>(ELessonStepEvent::PartsConnected);
+}
+
+FLessonStepPredicate UGroundPartStep::CompileCondition() const
+{
+	const TSubclassOf<APartActor> RequiredClass = PartClass;
+
+	return [RequiredClass](const AAssemblyActor& Assembly)
+	{
+		if (!RequiredClass)
+		{
+			return false;
+		}
+
+		const FSubAssemblyTracker& SubAssemblies = Assembly.GetSubAssemblies();
+		for (const APartActor* Part : Assembly.Parts)
+		{
+			if (Part && Part->IsA(RequiredClass) && SubAssemblies.IsGrounded(Part))
+			{
+				return true;
+			}
+		}
+		return false;
+	};
+}
+
+UAssemblyStateStep::UAssemblyStateStep()
+{
+	TriggerEvents = static_cast<int32>(ELessonStepEvent::AssemblyStateChanged);
+}
+
+FLessonStepPredicate UAssemblyStateStep::CompileCondition() const
+{
+	const EAssemblyState RequiredState = State;
+
+	return [RequiredState](const AAssemblyActor& Assembly)
+	{
+		return Assembly.AssemblyState == RequiredState;
+	};
+}
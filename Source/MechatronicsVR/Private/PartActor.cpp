@@ -4,20 +4,43 @@
 #include "MechatronicsVR/Public/PartActor.h"
 
 #include "AssemblyActor.h"
+#include "AssemblyAssetSubsystem.h"
 #include "AssemblyComponent.h"
-#include "EngineUtils.h"
+#include "AssemblyRegistrySubsystem.h"
+#include "AssemblyStats.h"
+#include "AssemblyTickSubsystem.h"
 #include "GrabComponent.h"
+#include "HeldPartNetComponent.h"
 #include "MotionControllerComponent.h"
+#include "SnapPointSubsystem.h"
+#include "SnapPreviewSubsystem.h"
 #include "SnapValidatorComponent.h"
 
 #include "Components/SphereComponent.h"
 #include "Kismet/GameplayStatics.h"
 
+#if !UE_BUILD_SHIPPING
+static TAutoConsoleVariable<bool> CVarValidateSnapTransformCache(
+	TEXT("Assembly.Debug.ValidateSnapTransformCache"),
+	false,
+	TEXT("Compare cached snap point transforms with the live component transforms in CalculateSnapTransform and warn when they differ."));
+#endif
+
+static TAutoConsoleVariable<bool> CVarOnScreenGrabMessages(
+	TEXT("Assembly.Debug.OnScreenGrabMessages"),
+	false,
+	TEXT("Print GRABBED / RELEASED on screen when a part is grabbed or released."));
+
 // Sets default values
 APartActor::APartActor()
 {
- 	// Set this actor to call Tick() every frame.  You can turn this off to improve performance if you don't need it.
-	PrimaryActorTick.bCanEverTick = true;
+ 	// Held parts are ticked by UAssemblyTickSubsystem; parts at rest have no per-frame work
+	PrimaryActorTick.bCanEverTick = false;
+
+	// Replicated so connections and requests can refer to it. Loose parts replicate their physics pose;
+	// held and snapped ones turn it off (see UpdateMovementReplication).
+	bReplicates = true;
+	SetReplicateMovement(true);
 
 	// Set root as mesh so physics can drive movement
 	Mesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("Mesh"));
@@ -26,28 +49,7 @@ APartActor::APartActor()
 	Mesh->SetCollisionEnabled(ECollisionEnabled::QueryAndPhysics);
 	Mesh->SetCollisionObjectType(ECC_PhysicsBody);
 
-
-	// Create preview mesh component
-	PreviewMesh = CreateDefaultSubobject<UStaticMeshComponent>(TEXT("PreviewMesh"));
-	PreviewMesh->SetupAttachment(RootComponent);
-	PreviewMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
-	PreviewMesh->SetVisibility(false);
-	PreviewMesh->SetCastShadow(false);
-
-
-	static ConstructorHelpers::FObjectFinder<UMaterialInterface> PreviewMaterialFinder(TEXT("/Game/M_GhostPreview.M_GhostPreview"));
-	if (PreviewMaterialFinder.Succeeded())
-	{
-		PreviewMaterial = PreviewMaterialFinder.Object;
-	}
-	else
-	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to load preview material!"));
-	}
-	
-    
 	// Configure for VR Template grabbing
-	
 	Mesh->SetCollisionResponseToAllChannels(ECR_Block);
 	// Mesh->SetCollisionResponseToChannel(ECC_Pawn, ECR_Ignore); // Don't block player movement
     
@@ -65,6 +67,9 @@ APartActor::APartActor()
 	// Attach validator
 	SnapValidator = CreateDefaultSubobject<USnapValidatorComponent>(TEXT("SnapValidator"));
 
+	// Held poses replicate through this rather than movement replication
+	HeldPartNet = CreateDefaultSubobject<UHeldPartNetComponent>(TEXT("HeldPartNet"));
+
 	// Set default preview values
 	PreviewOpacity = 0.3f;
 	PreviewColor = FLinearColor::Green;
@@ -75,29 +80,35 @@ APartActor::APartActor()
 
 USnapPointComponent* APartActor::GetBestSnapPointFor(USnapPointComponent* TargetSnapPoint) const
 {
+	ASSEMBLY_SCOPE_CYCLE_COUNTER(GetBestSnapPointFor);
+
 	if (!TargetSnapPoint)
 	{
 		return nullptr;
 	}
 
-	TArray<USnapPointComponent*> SnapPoints = Assembly->GetSnapPoints();
+	// Packed pose cache scores all of my snap points in one pass
+	if (USnapPointSubsystem* SnapPointSubsystem = USnapPointSubsystem::Get(this))
+	{
+		USnapPointComponent* BestSnapPoint = nullptr;
+		if (SnapPointSubsystem->FindBestSnapPointOnOwner(this, TargetSnapPoint, BestSnapPoint))
+		{
+			return BestSnapPoint;
+		}
+	}
+
 	USnapPointComponent* BestSnapPoint = nullptr;
 	float BestDistance = FLT_MAX;
 
-	for (USnapPointComponent* SnapPoint : SnapPoints)
+	for (USnapPointComponent* SnapPoint : GetSnapPointsView())
 	{
 		if (!SnapPoint || SnapPoint->bIsAssembled)
 		{
 			continue;
 		}
 
-		// Check if this snap point can accept the target snap point
-		if (!SnapPoint->CanAcceptPoint(TargetSnapPoint))
-		{
-			continue;
-		}
-		// Check if target can accept this snap point
-		if (!TargetSnapPoint->CanAcceptPoint(SnapPoint))
+		// Check both points accept each other
+		if (!SnapPoint->CanMutuallyAccept(TargetSnapPoint))
 		{
 			continue;
 		}
@@ -125,84 +136,229 @@ void APartActor::UpdatePreviewState()
 
 USnapPointComponent* APartActor::FindBestPreviewTarget() const
 {
-    // Get all my snap points
-    TArray<USnapPointComponent*> MySnapPoints = GetSnapPoints();
+	ASSEMBLY_SCOPE_CYCLE_COUNTER(FindBestPreviewTarget);
+
+    // Get all my snap points, a view so the nested loops below never copy
+    const TConstArrayView<TObjectPtr<USnapPointComponent>> MySnapPoints = GetSnapPointsView();
+
+	// Closest free, mutually compatible target in a candidate list (a part's view or the base array)
+	auto FindClosestTarget = [&MySnapPoints](const auto& Targets) -> USnapPointComponent*
+	{
+		USnapPointComponent* ClosestTarget = nullptr;
+		float ClosestDistance = FLT_MAX;
+		for (USnapPointComponent* TargetSnapPoint : Targets)
+		{
+			if (!TargetSnapPoint || TargetSnapPoint->bIsAssembled)
+			{
+				continue;
+			}
+
+			// Check each of my snap points for compatibility
+			for (USnapPointComponent* OtherSnapPoint : MySnapPoints)
+			{
+				if (!OtherSnapPoint || OtherSnapPoint->bIsAssembled || !OtherSnapPoint->CanMutuallyAccept(TargetSnapPoint))
+				{
+					continue;
+				}
+
+				const float Distance = FVector::Dist(OtherSnapPoint->GetComponentLocation(), TargetSnapPoint->GetComponentLocation());
+				if (Distance < ClosestDistance)
+				{
+					ClosestDistance = Distance;
+					ClosestTarget = TargetSnapPoint;
+				}
+			}
+		}
+		return ClosestTarget;
+	};
     
     // FIRST: Check if we have a specific actor we should assemble onto
     if (PartAssembledOnto && PartAssembledOnto->IsValidLowLevelFast())
     {
-        TArray<USnapPointComponent*> TargetSnapPoints = PartAssembledOnto->GetSnapPoints();
-        
-        for (USnapPointComponent* TargetSnapPoint : TargetSnapPoints)
+        if (USnapPointComponent* TargetSnapPoint = FindClosestTarget(PartAssembledOnto->GetSnapPointsView()))
         {
-            if (!TargetSnapPoint || TargetSnapPoint->bIsAssembled)
-            {
-                continue;
-            }
-            
-            // Check each of my snap points for compatibility
-            for (USnapPointComponent* OtherSnapPoint : MySnapPoints)
-            {
-                if (!OtherSnapPoint || OtherSnapPoint->bIsAssembled)
-                {
-                    continue;
-                }
-                
-                // Check bidirectional compatibility
-                if (OtherSnapPoint->CanAcceptPoint(TargetSnapPoint) && 
-                    TargetSnapPoint->CanAcceptPoint(OtherSnapPoint))
-                {
-                    // Found a compatible one - just return it!
-                    UE_LOG(LogTemp, Log, TEXT("%s: Found target on specified actor %s"), 
-                        *GetName(), *PartAssembledOnto->GetName());
-                    return TargetSnapPoint;
-                }
-            }
+            UE_LOG(LogTemp, Verbose, TEXT("%s: Found target on specified actor %s"), 
+                *GetName(), *PartAssembledOnto->GetName());
+            return TargetSnapPoint;
         }
     }
-    
-	
-		// SECOND: Try the assembly base
-    	// Check assembly's base snap points
-    	TArray<USnapPointComponent*> BaseSnapPoints = AssemblyActor->GetBaseSnapPoints();
-    	for (USnapPointComponent* BaseSnapPoint : BaseSnapPoints)
-    	{
-    		if (!BaseSnapPoint || BaseSnapPoint->bIsAssembled)
-    		{
-    			continue;
-    		}
-        
-    		// Check each of my snap points for compatibility with base
-    		for (USnapPointComponent* OtherSnapPoint : MySnapPoints)
-    		{
-    			if (!OtherSnapPoint || OtherSnapPoint->bIsAssembled)
-    			{
-    				continue;
-    			}
-            
-    			if (OtherSnapPoint->CanAcceptPoint(BaseSnapPoint) &&			BaseSnapPoint->CanAcceptPoint(OtherSnapPoint))
-    			{
-    				// Found compatible base - return it!
-    				UE_LOG(LogTemp, Log, TEXT("%s: Found base snap point %s"),				*GetName(), *BaseSnapPoint->GetName());
-    				return BaseSnapPoint;
-    			}
-    		}
-    	}
+
+	// SECOND: Try the assembly base
+	if (AssemblyActor)
+	{
+		if (USnapPointComponent* BaseSnapPoint = FindClosestTarget(AssemblyActor->GetBaseSnapPoints()))
+		{
+			UE_LOG(LogTemp, Verbose, TEXT("%s: Found base snap point %s"), *GetName(), *BaseSnapPoint->GetName());
+			return BaseSnapPoint;
+		}
+	}
+
+	// THIRD: Anything compatible within snap range, straight from the world snap index
+	if (USnapPointSubsystem* SnapPointSubsystem = USnapPointSubsystem::Get(this))
+	{
+		USnapPointComponent* ClosestSnapPoint = nullptr;
+		float ClosestDistance = FLT_MAX;
+		for (USnapPointComponent* OtherSnapPoint : MySnapPoints)
+		{
+			if (!OtherSnapPoint || OtherSnapPoint->bIsAssembled)
+			{
+				continue;
+			}
+
+			USnapPointComponent* Candidate = SnapPointSubsystem->FindClosestCompatibleSnapPoint(OtherSnapPoint, MaxSnapDistance);
+			if (!Candidate)
+			{
+				continue;
+			}
+
+			const float Distance = FVector::Dist(OtherSnapPoint->GetComponentLocation(), Candidate->GetComponentLocation());
+			if (Distance < ClosestDistance)
+			{
+				ClosestDistance = Distance;
+				ClosestSnapPoint = Candidate;
+			}
+		}
+		if (ClosestSnapPoint)
+		{
+			UE_LOG(LogTemp, Verbose, TEXT("%s: Found nearby snap point %s"), *GetName(), *ClosestSnapPoint->GetName());
+			return ClosestSnapPoint;
+		}
+	}
 	
     return nullptr;  // No compatible target found
 }
 
+float APartActor::ScorePreviewTarget(USnapPointComponent* TargetSnapPoint) const
+{
+	const USnapPointComponent* SnapPoint = GetBestSnapPointFor(TargetSnapPoint);
+	if (!SnapPoint)
+	{
+		return FLT_MAX;
+	}
+	return FVector::Dist(SnapPoint->GetComponentLocation(), TargetSnapPoint->GetComponentLocation());
+}
+
+void APartActor::ResetPreviewTracking()
+{
+	PreviewTrackingAccumulator = 0.0f;
+	bHasPreviewTrackingPose = false;
+	CurrentPreviewSourceSnapPoint = nullptr;
+}
+
+void APartActor::TickPreviewTracking(float DeltaTime)
+{
+	if (!IsAttachedToMotionController())
+	{
+		return;
+	}
+
+	// Rate limit
+	PreviewTrackingAccumulator += DeltaTime;
+	const float Interval = PreviewTrackingRate > 0.0f ? 1.0f / PreviewTrackingRate : 0.0f;
+	if (PreviewTrackingAccumulator < Interval)
+	{
+		++PreviewTrackingStats.SkippedByRate;
+		return;
+	}
+
+	// The interval is only consumed once the preview is known to be current. A part skipped by the
+	// budget keeps its accumulator and is due again next frame.
+	auto ConsumeInterval = [this, Interval]()
+	{
+		PreviewTrackingAccumulator = Interval > 0.0f ? FMath::Fmod(PreviewTrackingAccumulator, Interval) : 0.0f;
+	};
+
+	// Temporal coherence: nothing to rescore if we have not moved and the target is still free
+	const FTransform CurrentTransform = GetActorTransform();
+	const bool bTargetStillValid = !CurrentTargetSnapPoint || !CurrentTargetSnapPoint->bIsAssembled;
+	if (bHasPreviewTrackingPose && bTargetStillValid &&
+		FVector::Dist(CurrentTransform.GetLocation(), LastPreviewTrackingLocation) < PreviewMoveThreshold &&
+		FMath::RadiansToDegrees(CurrentTransform.GetRotation().AngularDistance(LastPreviewTrackingRotation)) < PreviewRotateThreshold)
+	{
+		++PreviewTrackingStats.SkippedByCoherence;
+		ConsumeInterval();
+		return;
+	}
+
+	// Shared per-frame budget across every held part
+	USnapPointSubsystem* SnapPointSubsystem = USnapPointSubsystem::Get(this);
+	if (SnapPointSubsystem && !SnapPointSubsystem->TryBeginPreviewEvaluation())
+	{
+		++PreviewTrackingStats.SkippedByBudget;
+		return;
+	}
+
+	const double StartTime = FPlatformTime::Seconds();
+	EvaluatePreviewTarget();
+	if (SnapPointSubsystem)
+	{
+		SnapPointSubsystem->EndPreviewEvaluation(FPlatformTime::Seconds() - StartTime);
+	}
+
+	LastPreviewTrackingLocation = CurrentTransform.GetLocation();
+	LastPreviewTrackingRotation = CurrentTransform.GetRotation();
+	bHasPreviewTrackingPose = true;
+	ConsumeInterval();
+	++PreviewTrackingStats.Evaluations;
+}
+
+void APartActor::EvaluatePreviewTarget()
+{
+	USnapPointComponent* NewTarget = FindBestPreviewTarget();
+
+	// Hysteresis: only leave a still valid target for one that is clearly closer
+	if (NewTarget && CurrentTargetSnapPoint && NewTarget != CurrentTargetSnapPoint && !CurrentTargetSnapPoint->bIsAssembled)
+	{
+		if (ScorePreviewTarget(NewTarget) + PreviewHysteresisDistance >= ScorePreviewTarget(CurrentTargetSnapPoint))
+		{
+			++PreviewTrackingStats.HysteresisHolds;
+			NewTarget = CurrentTargetSnapPoint;
+		}
+	}
+
+	if (!NewTarget)
+	{
+		HideSnapPreview();
+		CurrentTargetSnapPoint = nullptr;
+		CurrentPreviewSourceSnapPoint = nullptr;
+		return;
+	}
+
+	USnapPointComponent* NewSource = GetBestSnapPointFor(NewTarget);
+	if (NewTarget == CurrentTargetSnapPoint && NewSource == CurrentPreviewSourceSnapPoint && bShowingPreview)
+	{
+		return;
+	}
+
+	if (CurrentTargetSnapPoint && NewTarget != CurrentTargetSnapPoint)
+	{
+		++PreviewTrackingStats.TargetSwitches;
+	}
+	CurrentTargetSnapPoint = NewTarget;
+	CurrentPreviewSourceSnapPoint = NewSource;
+	if (NewSource)
+	{
+		ShowSnapPreviewInternal(NewSource, NewTarget);
+	}
+}
+
 bool APartActor::TrySnapToPreview()
 {
-	
-	UE_LOG(LogTemp, Warning, TEXT("TrySnapToPreview called for %s"), *GetName());
+	ASSEMBLY_SCOPE_CYCLE_COUNTER(TrySnapToPreview);
+
+	UE_LOG(LogTemp, Verbose, TEXT("TrySnapToPreview called for %s"), *GetName());
 
 	if (!CurrentTargetSnapPoint)
 	{
 		UE_LOG(LogTemp, Warning, TEXT("TrySnapToPreview: No CurrentPreviewTarget set, returning false."));
 		return false;
 	}
-	UE_LOG(LogTemp, Warning, TEXT("  - Has preview target: %s"), *CurrentTargetSnapPoint->GetName());
+	if (!AssemblyActor)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("TrySnapToPreview: %s has no AssemblyActor, returning false."), *GetName());
+		return false;
+	}
+	UE_LOG(LogTemp, Verbose, TEXT("  - Has preview target: %s"), *CurrentTargetSnapPoint->GetName());
 	// Find which of my snap points should connect
 	USnapPointComponent* SnapPoint = GetBestSnapPointFor(CurrentTargetSnapPoint);
 	if (!SnapPoint)
@@ -228,24 +384,20 @@ bool APartActor::TrySnapToPreview()
 	// Check if target is a base snap point on the assembly
 if (AssemblyActor->GetBaseSnapPoints().Contains(CurrentTargetSnapPoint))
 {
-	UE_LOG(LogTemp, Warning, TEXT("  - Target is a base snap point"));
+	UE_LOG(LogTemp, Verbose, TEXT("  - Target is a base snap point"));
 
 	//calculate and apply the snap transform
 	FTransform SnapTransform = CalculateSnapTransform(SnapPoint, CurrentTargetSnapPoint);
 	SetActorTransform(SnapTransform);
-	// Notify assembly to add me as first part
-	bool bSuccess = AssemblyActor->ConnectParts(nullptr, this, CurrentTargetSnapPoint, SnapPoint);
+	// Notify assembly to add me as first part (predicted on clients)
+	bool bSuccess = AssemblyActor->RequestConnect(nullptr, this, CurrentTargetSnapPoint, SnapPoint);
 	if (bSuccess)
 	{
 		// Disable physics since we're now connected
-		if (Mesh)
-		{
-			Mesh->SetSimulatePhysics(false);
-			Mesh->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-		}
+		SetSnappedPhysics(true);
 		HideSnapPreview();
 		CurrentTargetSnapPoint = nullptr;
-		UE_LOG(LogTemp, Warning, TEXT("  - Successfully snapped to base"));
+		UE_LOG(LogTemp, Verbose, TEXT("  - Successfully snapped to base"));
 		return true;
 	}
 }
@@ -255,23 +407,19 @@ if (AssemblyActor->GetBaseSnapPoints().Contains(CurrentTargetSnapPoint))
 		APartActor* TargetPart = Cast<APartActor>(CurrentTargetSnapPoint->GetOwner());
 		if (TargetPart)
 		{
-			UE_LOG(LogTemp, Warning, TEXT("  - Target is another part: %s"), *TargetPart->GetName());
+			UE_LOG(LogTemp, Verbose, TEXT("  - Target is another part: %s"), *TargetPart->GetName());
 			//calculate and apply the snap transform
 			FTransform SnapTransform = CalculateSnapTransform(SnapPoint, CurrentTargetSnapPoint);
 			SetActorTransform(SnapTransform);
-			// Notify assembly to connect the two parts
-			bool bSuccess = AssemblyActor->ConnectParts(this, TargetPart, SnapPoint, CurrentTargetSnapPoint);
+			// Notify assembly to connect the two parts (predicted on clients)
+			bool bSuccess = AssemblyActor->RequestConnect(this, TargetPart, SnapPoint, CurrentTargetSnapPoint);
 			if (bSuccess)
 			{
 				// Disable physics since we're now connected
-				if (Mesh)
-				{
-					Mesh->SetSimulatePhysics(false);
-					Mesh->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
-				}
+				SetSnappedPhysics(true);
 				HideSnapPreview();
 				CurrentTargetSnapPoint = nullptr;
-				UE_LOG(LogTemp, Warning, TEXT("  - Successfully snapped to part %s"), *TargetPart->GetName());
+				UE_LOG(LogTemp, Verbose, TEXT("  - Successfully snapped to part %s"), *TargetPart->GetName());
 				return true;
 			} 
 			
@@ -280,6 +428,36 @@ if (AssemblyActor->GetBaseSnapPoints().Contains(CurrentTargetSnapPoint))
 	return false;
 }
 
+void APartActor::SetSnappedPhysics(bool bSnapped)
+{
+	if (Mesh)
+	{
+		Mesh->SetSimulatePhysics(!bSnapped);
+		Mesh->SetCollisionEnabled(bSnapped ? ECollisionEnabled::QueryOnly : ECollisionEnabled::QueryAndPhysics);
+	}
+}
+
+void APartActor::UpdateMovementReplication()
+{
+	if (!HasAuthority())
+	{
+		return;
+	}
+	// Held parts keep movement replication only in the Assembly.Net.HeldPartReplication 0 comparison
+	const bool bHeld = HeldPartNet && HeldPartNet->GetHeldBy() && UHeldPartNetComponent::IsSampleReplicationEnabled();
+	const bool bConnected = AssemblyActor && AssemblyActor->GetConnectionHandles(this).Num() > 0;
+	SetReplicateMovement(!bHeld && !bConnected);
+}
+
+void APartActor::OnRep_ReplicatedMovement()
+{
+	if (HeldPartNet && HeldPartNet->IsLocallyHeld())
+	{
+		return;
+	}
+	Super::OnRep_ReplicatedMovement();
+}
+
 bool APartActor::IsAttachedToMotionController() const
 {
 	if (USceneComponent* RootComp = GetRootComponent()) 
@@ -287,12 +465,16 @@ bool APartActor::IsAttachedToMotionController() const
 		// Check if we're attached to anything
 		if (const USceneComponent* AttachParent = RootComp->GetAttachParent())
 		{
-			// Get the owner of what we're attached to
-			if (AActor* ParentActor = AttachParent->GetOwner())
+			// Only search the parent's components when the attachment changed
+			if (CachedAttachParent.Get() != AttachParent)
 			{
+				// Get the owner of what we're attached to
+				const AActor* ParentActor = AttachParent->GetOwner();
 				// Check if it has a MotionControllerComponent
-				return ParentActor->FindComponentByClass<UMotionControllerComponent>() != nullptr;
+				bCachedAttachedToMotionController = ParentActor && ParentActor->FindComponentByClass<UMotionControllerComponent>() != nullptr;
+				CachedAttachParent = AttachParent;
 			}
+			return bCachedAttachedToMotionController;
 		}
 	}
 	return false;
@@ -319,151 +501,103 @@ void APartActor::ShowSnapPreview()
 
 void APartActor::ShowSnapPreviewInternal(USnapPointComponent* SourceSnapPoint, USnapPointComponent* TargetSnapPoint)
 {
-	if (!SourceSnapPoint || !TargetSnapPoint || !Mesh || !PreviewMesh) {
+	if (!SourceSnapPoint || !TargetSnapPoint || !Mesh) {
 		UE_LOG(LogTemp, Warning, TEXT("ShowSnapPreviewInternal: Early return - SourceSnapPoint: %p, TargetSnapPoint: %p, "), SourceSnapPoint, TargetSnapPoint);
 		return;
 	}
 
-	UE_LOG(LogTemp, Log, TEXT("ShowSnapPreviewInternal: Called with SourceSnapPoint: %s, TargetSnapPoint: %s"),
-		SourceSnapPoint ? *SourceSnapPoint->GetName() : TEXT("nullptr"),
-		TargetSnapPoint ? *TargetSnapPoint->GetName() : TEXT("nullptr"));
-
-	if (Mesh->GetStaticMesh())
+	if (!Mesh->GetStaticMesh())
 	{
-		UE_LOG(LogTemp, Log, TEXT("ShowSnapPreviewInternal: Setting PreviewMesh static me+sh to %s"), *Mesh->GetStaticMesh()->GetName());
-		PreviewMesh->SetStaticMesh(Mesh->GetStaticMesh());
-		
-		// DETACH the preview mesh, so it doesn't move with the part!
-		// Completely reset the preview mesh transform
-		// Check if already detached
-		if (PreviewMesh->GetAttachParent() != nullptr)
-		{
-			// First time - detach it
-			PreviewMesh->DetachFromComponent(FDetachmentTransformRules::KeepWorldTransform);
-			UE_LOG(LogTemp, Warning, TEXT("Detaching preview mesh"));
-		}
-		else
-		{
-			UE_LOG(LogTemp, Warning, TEXT("Preview mesh already detached"));
-		}
-        
-		const FTransform SnapTransform = CalculateSnapTransform(SourceSnapPoint, TargetSnapPoint);
-        
-
-		PreviewMesh->SetWorldLocation(SnapTransform.GetLocation());
-		PreviewMesh->SetWorldRotation(SnapTransform.GetRotation());
-		PreviewMesh->SetWorldScale3D(SnapTransform.GetScale3D());
+		UE_LOG(LogTemp, Warning, TEXT("ShowSnapPreviewInternal: Mesh has no static mesh assigned!"));
+		return;
+	}
 
+	USnapPreviewSubsystem* PreviewSubsystem = USnapPreviewSubsystem::Get(this);
+	if (!PreviewSubsystem)
+	{
+		return;
+	}
 
-		if (PreviewMaterial)
+	const FName Hand = GrabComponent ? GrabComponent->GetHeldByHand() : NAME_None;
+	const FTransform SnapTransform = CalculateSnapTransform(SourceSnapPoint, TargetSnapPoint);
+	UMaterialInterface* GhostMaterial = PreviewMaterial;
+	if (!GhostMaterial)
+	{
+		if (const UAssemblyAssetSubsystem* AssetSubsystem = UAssemblyAssetSubsystem::Get(this))
 		{
-			UE_LOG(LogTemp, Log, TEXT("ShowSnapPreviewInternal: Using PreviewMaterial: %s"), *PreviewMaterial->GetName());
-			UMaterialInstanceDynamic* DynamicMaterial = UMaterialInstanceDynamic::Create(PreviewMaterial, this);
-			if (DynamicMaterial)
-			{
-				UE_LOG(LogTemp, Log, TEXT("ShowSnapPreviewInternal: Created dynamic material instance for preview."));
-				DynamicMaterial->SetScalarParameterValue(TEXT("Opacity"), PreviewOpacity);
-				DynamicMaterial->SetVectorParameterValue(TEXT("Color"), PreviewColor);
-				for (int32 i = 0; i<PreviewMesh->GetNumMaterials(); i++)
-				{
-					PreviewMesh->SetMaterial(i, DynamicMaterial);
-					UE_LOG(LogTemp, Log, TEXT("ShowSnapPreviewInternal: Set dynamic material on PreviewMesh slot %d"), i);
-				}
-			}
-			else
-			{
-				UE_LOG(LogTemp, Warning, TEXT("Failed to create dynamic material instance for preview mesh"));
-			}
+			GhostMaterial = AssetSubsystem->GetGhostPreviewMaterial();
 		}
-		else
-		{
-			UE_LOG(LogTemp, Log, TEXT("ShowSnapPreviewInternal: No PreviewMaterial, using fallback."));
-			for (int32 i = 0; i < PreviewMesh->GetNumMaterials(); i++)
-			{
-				UMaterialInterface* OriginalMaterial = Mesh->GetMaterial(i);
-				if (OriginalMaterial)
-				{
-					UE_LOG(LogTemp, Log, TEXT("ShowSnapPreviewInternal: Creating dynamic material from original material %s for slot %d"), *OriginalMaterial->GetName(), i);
-					UMaterialInstanceDynamic* DynamicMaterial = UMaterialInstanceDynamic::Create(OriginalMaterial, this);
-					if (DynamicMaterial)
-					{
-						DynamicMaterial->SetScalarParameterValue(TEXT("Opacity"), PreviewOpacity);
-						PreviewMesh->SetMaterial(i, DynamicMaterial);
-						UE_LOG(LogTemp, Log, TEXT("ShowSnapPreviewInternal: Set fallback dynamic material on PreviewMesh slot %d"), i);
-					}
-				}
-			}
-		}
-
-		PreviewMesh->SetVisibility(true);
-		bShowingPreview = true;
-		CurrentTargetSnapPoint = TargetSnapPoint;
-
-		UE_LOG(LogTemp, Log, TEXT("ShowSnapPreview: Showing preview for %s at snap point %s to target %s"), 
-		  *GetName(), 
-		  *SourceSnapPoint->GetName(), 
-		  *TargetSnapPoint->GetName());
 	}
-	else
+	if (!PreviewSubsystem->ShowGhost(this, Hand, Mesh, SnapTransform, GhostMaterial, PreviewOpacity, PreviewColor))
 	{
-		UE_LOG(LogTemp, Warning, TEXT("ShowSnapPreviewInternal: Mesh has no static mesh assigned!"));
+		UE_LOG(LogTemp, Warning, TEXT("ShowSnapPreviewInternal: No ghost available for %s"), *GetName());
+		return;
 	}
+
+	bShowingPreview = true;
+	CurrentTargetSnapPoint = TargetSnapPoint;
+	AssemblyTrace::OutputPartEvent(AssemblyTrace::EPartEvent::Preview, this, TargetSnapPoint->GetOwner());
+
+	UE_LOG(LogTemp, Verbose, TEXT("ShowSnapPreview: Showing preview for %s at snap point %s to target %s"), 
+	  *GetName(), 
+	  *SourceSnapPoint->GetName(), 
+	  *TargetSnapPoint->GetName());
 }
 
 void APartActor::HideSnapPreview()
 {
-	if (!PreviewMesh) return;
-
 	if (bShowingPreview)
 	{
-		PreviewMesh->SetVisibility(false);
 		bShowingPreview = false;
 		CurrentTargetSnapPoint = nullptr;
+		if (USnapPreviewSubsystem* PreviewSubsystem = USnapPreviewSubsystem::Get(this))
+		{
+			PreviewSubsystem->HideGhost(this);
+		}
 		UE_LOG(LogTemp, Log, TEXT("HideSnapPreview: Hiding preview for %s"), *GetName());
 	}
 }
 
 FTransform APartActor::CalculateSnapTransform(USnapPointComponent* SourceSnapPoint, USnapPointComponent* TargetSnapPoint) const
 {
+	ASSEMBLY_SCOPE_CYCLE_COUNTER(CalculateSnapTransform);
+
 	if (!SourceSnapPoint || !TargetSnapPoint)
 	{
 		return GetActorTransform();
 	}
 
-	// Make sure both are up-to-date
-	TargetSnapPoint->UpdateComponentToWorld();
-	SourceSnapPoint->UpdateComponentToWorld();
-	
-	// Get the ACTUAL world transform of target
-	const FTransform TargetSnapWorld = TargetSnapPoint->GetComponentTransform();
-    
-	// Get MY snap point's LOCAL transform
-	// Source snap RELATIVE TO *ACTOR* (not just its parent component)
-	const FTransform SourceRelToActor =
-		SourceSnapPoint->GetComponentTransform().GetRelativeTransform(GetActorTransform());
-    
-	
-    
-	// Calculate
-	const FTransform NewActorWorld = SourceRelToActor.Inverse() * TargetSnapWorld;
+	// Snap points are rigid on their actors, so both poses come from the transforms cached at registration
+	const FTransform TargetSnapWorld = TargetSnapPoint->GetSnapWorldTransform();
+
+#if !UE_BUILD_SHIPPING
+	if (CVarValidateSnapTransformCache.GetValueOnGameThread())
+	{
+		const FTransform LiveRelToActor = SourceSnapPoint->GetComponentTransform().GetRelativeTransform(GetActorTransform());
+		if (!LiveRelToActor.Equals(SourceSnapPoint->GetActorRelativeTransform(), 0.01f) ||
+			!TargetSnapPoint->GetComponentTransform().Equals(TargetSnapWorld, 0.01f))
+		{
+			UE_LOG(LogTemp, Warning, TEXT("CalculateSnapTransform: cached transform of %s or %s is stale, call RefreshCachedTransform after moving a snap point"),
+				*SourceSnapPoint->GetName(), *TargetSnapPoint->GetName());
+		}
+	}
+#endif
+
+	// Source snap relative to the actor, inverted, lands the actor so its snap point meets the target
+	const FTransform NewActorWorld = SourceSnapPoint->GetActorRelativeInverse() * TargetSnapWorld;
     
 	return NewActorWorld;
 }
 
 void APartActor::OnPartGrabbed() 
 {
-	if (*GetName()==FName("BP_Magnets_C_1"))
-	{
-		UE_LOG(LogTemp, Warning, TEXT("Debug Break on grab of Magnets"));
-	}
-	
-	UE_LOG(LogTemp, Warning, TEXT("🔥 GRABBED: %s"), *GetName());
+	AssemblyTrace::OutputPartEvent(AssemblyTrace::EPartEvent::Grab, this);
+
+	UE_LOG(LogTemp, Verbose, TEXT("🔥 GRABBED: %s"), *GetName());
 	
-	UE_LOG(LogTemp, Warning, TEXT("OnPartGrabbed - PreviewMaterial: %s"), 
-		PreviewMaterial ? TEXT("Valid") : TEXT("NULL"));
     
 	// Print to screen for easy debugging
-	if (GEngine)
+	if (GEngine && CVarOnScreenGrabMessages.GetValueOnGameThread())
 	{
 		GEngine->AddOnScreenDebugMessage(-1, 3.0f, FColor::Green, 
 			FString::Printf(TEXT("GRABBED: %s"), *GetName()));
@@ -472,21 +606,64 @@ void APartActor::OnPartGrabbed()
 	// Update preview state
 	UpdatePreviewState();
 	ShowSnapPreview();
+
+	// Keep the ghost following the hand while held
+	ResetPreviewTracking();
+	if (UAssemblyTickSubsystem* TickSubsystem = UAssemblyTickSubsystem::Get(this); TickSubsystem && bContinuousPreviewTracking)
+	{
+		TickSubsystem->RegisterHeldPart(this);
+	}
+
+	if (HeldPartNet && GrabComponent && GrabComponent->MotionControllerRef)
+	{
+		HeldPartNet->BeginLocalHold(GrabComponent->MotionControllerRef->GetOwner());
+	}
+
+	// Pulling a part off its neighbours undoes those connections; sent after the hold so the server knows whose hand it is in.
+	// Base connections stay: DisconnectParts addresses a connection by its two parts.
+	if (AssemblyActor)
+	{
+		TArray<APartActor*, TInlineAllocator<4>> Neighbours;
+		for (const FAssemblyConnectionHandle& Handle : AssemblyActor->GetConnectionHandles(this))
+		{
+			const FPartConnection* Connection = AssemblyActor->ResolveConnection(Handle);
+			if (Connection && !Connection->bIsBaseConnection)
+			{
+				Neighbours.Add(Connection->PartA == this ? Connection->PartB.Get() : Connection->PartA.Get());
+			}
+		}
+		for (APartActor* Neighbour : Neighbours)
+		{
+			AssemblyActor->RequestDisconnect(this, Neighbour);
+		}
+	}
 }
 
 void APartActor::OnPartReleased() 
 {
-	UE_LOG(LogTemp, Warning, TEXT("🚀 RELEASED: %s"), *GetName());
+	AssemblyTrace::OutputPartEvent(AssemblyTrace::EPartEvent::Release, this);
+
+	UE_LOG(LogTemp, Verbose, TEXT("🚀 RELEASED: %s"), *GetName());
     
 	// Print to screen for easy debugging
-	if (GEngine)
+	if (GEngine && CVarOnScreenGrabMessages.GetValueOnGameThread())
 	{
 		GEngine->AddOnScreenDebugMessage(-1, 3.0f, FColor::Red, 
 			FString::Printf(TEXT("RELEASED: %s"), *GetName()));
 	}
+	if (UAssemblyTickSubsystem* TickSubsystem = UAssemblyTickSubsystem::Get(this))
+	{
+		TickSubsystem->UnregisterHeldPart(this);
+	}
+	// Before any connect request, so the server releases the part before snapping it
+	if (HeldPartNet)
+	{
+		HeldPartNet->EndLocalHold();
+	}
 	TrySnapToPreview();
 	// HideSnapPreview();
 	CurrentTargetSnapPoint = nullptr;
+	CurrentPreviewSourceSnapPoint = nullptr;
 
 	
 }
@@ -496,6 +673,11 @@ const TArray<USnapPointComponent*> APartActor::GetSnapPoints() const
 	return Assembly->GetSnapPoints();
 }
 
+TConstArrayView<TObjectPtr<USnapPointComponent>> APartActor::GetSnapPointsView() const
+{
+	return Assembly ? Assembly->GetSnapPointsView() : TConstArrayView<TObjectPtr<USnapPointComponent>>();
+}
+
 
 // void APartActor::ClearSnapHighlight(APartActor* OtherPart)
 // {
@@ -519,69 +701,66 @@ void APartActor::BeginPlay()
 {
 	Super::BeginPlay();
 
-	if (PartAssembledOntoClass)
+	// PartAssembledOnto and AssemblyActor are bound by the registry once every level actor has registered
+	if (UAssemblyRegistrySubsystem* Registry = UAssemblyRegistrySubsystem::Get(this))
 	{
-		for (TActorIterator<APartActor> It(GetWorld()); It; ++It)
+		Registry->RegisterPart(this);
+	}
+}
+
+void APartActor::ResolveRegistryBindings(const UAssemblyRegistrySubsystem& Registry)
+{
+	if (PartAssembledOntoClass && !PartAssembledOnto)
+	{
+		PartAssembledOnto = Registry.FindPart(PartAssembledOntoClass, this);
+		if (PartAssembledOnto)
 		{
-			APartActor* PotentialTarget = *It;
-			if  (PotentialTarget && 
-				PotentialTarget != this &&
-				PotentialTarget->IsA(PartAssembledOntoClass))
-			{
-				PartAssembledOnto = PotentialTarget;
-				UE_LOG(LogTemp, Log, TEXT("%s: Found PartAssembledOnto: %s"), 
-					*GetName(), *PartAssembledOnto->GetName());
-				break;
-			}
+			UE_LOG(LogTemp, Log, TEXT("%s: Found PartAssembledOnto: %s"), 
+				*GetName(), *PartAssembledOnto->GetName());
 		}
-		if (!PartAssembledOnto)
+		else
 		{
 			UE_LOG(LogTemp, Warning, TEXT("%s: Could not find instance of class %s"), 
 				*GetName(), *PartAssembledOntoClass->GetName());
 		}
 	}
 
-	if (AssemblyActorClass)
+	ResolveAssemblyBinding(Registry);
+}
+
+void APartActor::ResolveAssemblyBinding(const UAssemblyRegistrySubsystem& Registry)
+{
+	// An assembly assigned with SetAssemblyActor before play is kept
+	if (AssemblyActorClass && !AssemblyActor)
 	{
-		for (TActorIterator<AAssemblyActor> It(GetWorld()); It; ++It)
+		AssemblyActor = Registry.FindAssembly(AssemblyActorClass);
+		if (AssemblyActor)
 		{
-			AAssemblyActor* PotentialAssembly = *It;
-			if  (PotentialAssembly && 
-				PotentialAssembly->IsA(AssemblyActorClass))
-			{
-				AssemblyActor = PotentialAssembly;
-				UE_LOG(LogTemp, Log, TEXT("%s: Found AssemblyActor: %s"), 
-					*GetName(), *AssemblyActor->GetName());
-				break;
-			}
+			UE_LOG(LogTemp, Log, TEXT("%s: Found AssemblyActor: %s"), 
+				*GetName(), *AssemblyActor->GetName());
 		}
-		if (!AssemblyActor)
+		else
 		{
 			UE_LOG(LogTemp, Warning, TEXT("%s: Could not find instance of class %s"), 
 				*GetName(), *AssemblyActorClass->GetName());
 		}
 	}
-	
-	
-	PreviewMaterial = LoadObject<UMaterialInterface>(nullptr, TEXT("/Game/M_GhostPreview"));
+}
 
-	  
-	if (!PreviewMaterial)
+void APartActor::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (UAssemblyRegistrySubsystem* Registry = UAssemblyRegistrySubsystem::Get(this))
 	{
-		UE_LOG(LogTemp, Error, TEXT("Failed to load preview material in BeginPlay"));
+		Registry->UnregisterPart(this);
 	}
-	else
+
+	if (UAssemblyTickSubsystem* TickSubsystem = UAssemblyTickSubsystem::Get(this))
 	{
-		UE_LOG(LogTemp, Log, TEXT("Preview material loaded: %s"), *PreviewMaterial->GetName());
+		TickSubsystem->UnregisterHeldPart(this);
 	}
-	
-}
 
-// Called every frame
-void APartActor::Tick(float DeltaTime)
-{
-	Super::Tick(DeltaTime);
+	// Hand the borrowed ghost back
+	HideSnapPreview();
 
-	
-	
+	Super::EndPlay(EndPlayReason);
 }
@@ -0,0 +1,64 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "PreviewMaterialCache.h"
+#include "Materials/MaterialInstanceDynamic.h"
+
+static int32 GNumLivePreviewMIDs = 0;
+static int32 GNumCreatedPreviewMIDs = 0;
+
+UMaterialInstanceDynamic* FPreviewMaterialCache::GetOrCreate(UMaterialInterface* Source, UObject* Outer, float Opacity, const FLinearColor* Color)
+{
+	if (!Source)
+	{
+		return nullptr;
+	}
+
+	FPreviewMaterialEntry& Entry = Entries.FindOrAdd(Source);
+	if (!Entry.MaterialInstance)
+	{
+		Entry = FPreviewMaterialEntry();
+		Entry.MaterialInstance = UMaterialInstanceDynamic::Create(Source, Outer);
+		if (!Entry.MaterialInstance)
+		{
+			Entries.Remove(Source);
+			return nullptr;
+		}
+		++GNumLivePreviewMIDs;
+		++GNumCreatedPreviewMIDs;
+	}
+
+	if (Entry.AppliedOpacity != Opacity)
+	{
+		Entry.MaterialInstance->SetScalarParameterValue(TEXT("Opacity"), Opacity);
+		Entry.AppliedOpacity = Opacity;
+	}
+	if (Color && (!Entry.bColorApplied || !Entry.AppliedColor.Equals(*Color)))
+	{
+		Entry.MaterialInstance->SetVectorParameterValue(TEXT("Color"), *Color);
+		Entry.AppliedColor = *Color;
+		Entry.bColorApplied = true;
+	}
+	return Entry.MaterialInstance;
+}
+
+void FPreviewMaterialCache::Reset()
+{
+	for (const TPair<TObjectPtr<UMaterialInterface>, FPreviewMaterialEntry>& Pair : Entries)
+	{
+		if (Pair.Value.MaterialInstance)
+		{
+			--GNumLivePreviewMIDs;
+		}
+	}
+	Entries.Reset();
+}
+
+int32 FPreviewMaterialCache::GetNumLiveInstances()
+{
+	return GNumLivePreviewMIDs;
+}
+
+int32 FPreviewMaterialCache::GetNumCreatedInstances()
+{
+	return GNumCreatedPreviewMIDs;
+}
@@ -0,0 +1,225 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SnapCompatibilityTable.h"
+#include "PartActor.h"
+#include "Algo/Unique.h"
+
+int32 FSnapCompatibilityTable::InternSnapID(FName SnapID)
+{
+	if (const int32* Existing = SnapIDIndices.Find(SnapID))
+	{
+		return *Existing;
+	}
+	const int32 Index = SnapIDs.Add(SnapID);
+	SnapIDIndices.Add(SnapID, Index);
+	bDirty = true;
+	return Index;
+}
+
+int32 FSnapCompatibilityTable::AddProfile(FName SnapID, const TArray<FName>& CompatibleSnapIDs,
+	const TArray<TSubclassOf<APartActor>>& CompatibleParts)
+{
+	// Order and duplicates in the authored arrays do not change the relation
+	FProfileKey Key;
+	Key.SnapID = SnapID;
+	Key.CompatibleSnapIDs = CompatibleSnapIDs;
+	Key.CompatibleSnapIDs.Sort(FNameLexicalLess());
+	Key.CompatibleSnapIDs.SetNum(Algo::Unique(Key.CompatibleSnapIDs));
+	for (const TSubclassOf<APartActor>& PartClass : CompatibleParts)
+	{
+		if (PartClass)
+		{
+			Key.CompatibleParts.AddUnique(PartClass.Get());
+		}
+	}
+	Key.CompatibleParts.Sort([](const UClass& A, const UClass& B) { return A.GetFName().LexicalLess(B.GetFName()); });
+
+	if (const int32* Existing = ProfileIndices.Find(Key))
+	{
+		return *Existing;
+	}
+
+	FProfile Profile;
+	Profile.SnapIDIndex = InternSnapID(SnapID);
+	for (const FName& CompatibleSnapID : Key.CompatibleSnapIDs)
+	{
+		Profile.CompatibleSnapIDIndices.Add(InternSnapID(CompatibleSnapID));
+	}
+	Profile.CompatibleParts = Key.CompatibleParts;
+	for (const UClass* PartClass : Profile.CompatibleParts)
+	{
+		AddPartClass(PartClass);
+	}
+
+	const int32 Index = Profiles.Add(MoveTemp(Profile));
+	ProfileIndices.Add(MoveTemp(Key), Index);
+	bDirty = true;
+	return Index;
+}
+
+int32 FSnapCompatibilityTable::AddPartClass(const UClass* PartClass)
+{
+	if (!PartClass)
+	{
+		return INDEX_NONE;
+	}
+	if (const int32* Existing = PartClassIndices.Find(PartClass))
+	{
+		return *Existing;
+	}
+	const int32 Index = PartClasses.Add(PartClass);
+	PartClassIndices.Add(PartClass, Index);
+	bDirty = true;
+	return Index;
+}
+
+void FSnapCompatibilityTable::Reset()
+{
+	SnapIDIndices.Empty();
+	SnapIDs.Empty();
+	ProfileIndices.Empty();
+	Profiles.Empty();
+	PartClassIndices.Empty();
+	PartClasses.Empty();
+	AcceptsSnapIDRows.Empty();
+	MutualRows.Empty();
+	PartClassRows.Empty();
+	NumAsymmetricPairs = 0;
+	NumDanglingSnapIDs = 0;
+	NumCompiledProfiles = 0;
+	NumCompiledSnapIDs = 0;
+	NumCompiledPartClasses = 0;
+	bDirty = false;
+}
+
+void FSnapCompatibilityTable::Compile()
+{
+	// Entries interned since the last compile only add rows and columns; the bits already built stay valid
+	const int32 NumProfiles = Profiles.Num();
+	const int32 FirstNewProfile = NumCompiledProfiles;
+	const int32 FirstNewSnapID = NumCompiledSnapIDs;
+	const int32 FirstNewPartClass = NumCompiledPartClasses;
+
+	AcceptsSnapIDRows.SetNum(NumProfiles);
+	PartClassRows.SetNum(NumProfiles);
+	for (int32 ProfileIndex = 0; ProfileIndex < NumProfiles; ++ProfileIndex)
+	{
+		const FProfile& Profile = Profiles[ProfileIndex];
+		const bool bNewProfile = ProfileIndex >= FirstNewProfile;
+
+		// An old profile's compatible ids were all interned with it, so new SnapID bits start clear
+		TBitArray<>& AcceptsRow = AcceptsSnapIDRows[ProfileIndex];
+		AcceptsRow.SetNum(SnapIDs.Num(), false);
+		if (bNewProfile)
+		{
+			for (const int32 SnapIDIndex : Profile.CompatibleSnapIDIndices)
+			{
+				AcceptsRow[SnapIDIndex] = true;
+			}
+		}
+
+		TBitArray<>& PartRow = PartClassRows[ProfileIndex];
+		PartRow.SetNum(PartClasses.Num(), false);
+		for (int32 ClassIndex = bNewProfile ? 0 : FirstNewPartClass; ClassIndex < PartClasses.Num(); ++ClassIndex)
+		{
+			for (const UClass* CompatiblePart : Profile.CompatibleParts)
+			{
+				if (PartClasses[ClassIndex]->IsChildOf(CompatiblePart))
+				{
+					PartRow[ClassIndex] = true;
+					break;
+				}
+			}
+		}
+	}
+
+	// Only pairs with at least one new profile need a bit
+	MutualRows.SetNum(NumProfiles);
+	for (int32 A = 0; A < NumProfiles; ++A)
+	{
+		MutualRows[A].SetNum(NumProfiles, false);
+	}
+	for (int32 A = 0; A < NumProfiles; ++A)
+	{
+		for (int32 B = FMath::Max(A, FirstNewProfile); B < NumProfiles; ++B)
+		{
+			const bool bAAcceptsB = AcceptsSnapIDRows[A][Profiles[B].SnapIDIndex];
+			const bool bBAcceptsA = AcceptsSnapIDRows[B][Profiles[A].SnapIDIndex];
+			const bool bMutual = bAAcceptsB && bBAcceptsA;
+			MutualRows[A][B] = bMutual;
+			MutualRows[B][A] = bMutual;
+
+			if (bAAcceptsB != bBAcceptsA)
+			{
+				++NumAsymmetricPairs;
+				const int32 Accepting = bAAcceptsB ? A : B;
+				const int32 Accepted = bAAcceptsB ? B : A;
+				UE_LOG(LogTemp, Warning, TEXT("FSnapCompatibilityTable: '%s' accepts '%s' but not the other way round, they can never snap"),
+					*SnapIDs[Profiles[Accepting].SnapIDIndex].ToString(), *SnapIDs[Profiles[Accepted].SnapIDIndex].ToString());
+			}
+		}
+	}
+
+	// Ids that only ever appear in a CompatibleSnapIDs list have no snap point to match. A later
+	// profile can declare an id that was dangling, so the count is redone, but each id warns once.
+	TBitArray<> Declared(false, SnapIDs.Num());
+	for (const FProfile& Profile : Profiles)
+	{
+		Declared[Profile.SnapIDIndex] = true;
+	}
+	NumDanglingSnapIDs = 0;
+	for (int32 SnapIDIndex = 0; SnapIDIndex < SnapIDs.Num(); ++SnapIDIndex)
+	{
+		if (!Declared[SnapIDIndex])
+		{
+			++NumDanglingSnapIDs;
+			if (SnapIDIndex >= FirstNewSnapID)
+			{
+				UE_LOG(LogTemp, Warning, TEXT("FSnapCompatibilityTable: '%s' is listed as compatible but no snap point declares it"),
+					*SnapIDs[SnapIDIndex].ToString());
+			}
+		}
+	}
+
+	NumCompiledProfiles = NumProfiles;
+	NumCompiledSnapIDs = SnapIDs.Num();
+	NumCompiledPartClasses = PartClasses.Num();
+	bDirty = false;
+
+	UE_LOG(LogTemp, Log, TEXT("FSnapCompatibilityTable: Compiled %d profiles (%d new), %d snap ids, %d part classes"),
+		NumProfiles, NumProfiles - FirstNewProfile, SnapIDs.Num(), PartClasses.Num());
+}
+
+bool FSnapCompatibilityTable::Accepts(int32 ProfileA, int32 ProfileB)
+{
+	CompileIfDirty();
+	return AcceptsSnapIDRows[ProfileA][Profiles[ProfileB].SnapIDIndex];
+}
+
+bool FSnapCompatibilityTable::AcceptsSnapID(int32 Profile, FName OtherSnapID)
+{
+	const int32* SnapIDIndex = SnapIDIndices.Find(OtherSnapID);
+	if (!SnapIDIndex)
+	{
+		return false;
+	}
+	CompileIfDirty();
+	return AcceptsSnapIDRows[Profile][*SnapIDIndex];
+}
+
+bool FSnapCompatibilityTable::AreMutuallyCompatible(int32 ProfileA, int32 ProfileB)
+{
+	CompileIfDirty();
+	return MutualRows[ProfileA][ProfileB];
+}
+
+TOptional<bool> FSnapCompatibilityTable::AcceptsPartClass(int32 Profile, const UClass* PartClass)
+{
+	const int32* ClassIndex = PartClassIndices.Find(PartClass);
+	if (!ClassIndex)
+	{
+		return TOptional<bool>();
+	}
+	CompileIfDirty();
+	return TOptional<bool>(PartClassRows[Profile][*ClassIndex]);
+}
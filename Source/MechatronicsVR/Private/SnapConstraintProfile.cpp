@@ -0,0 +1,19 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SnapConstraintProfile.h"
+
+FSnapConstraintProfile FSnapConstraintProfile::FromLegacyMetadata(const FString& Metadata)
+{
+	FSnapConstraintProfile Profile;
+
+	// Same keywords AAssemblyActor::ConfigureConstraintType used to search for; Contains is case-insensitive
+	if (Metadata.Contains(TEXT("hinge")) || Metadata.Contains(TEXT("rotate")) || Metadata.Contains(TEXT("shaft")))
+	{
+		Profile.JointType = EAssemblyJointType::Hinge;
+	}
+	else if (Metadata.Contains(TEXT("slide")) || Metadata.Contains(TEXT("prismatic")))
+	{
+		Profile.JointType = EAssemblyJointType::Prismatic;
+	}
+	return Profile;
+}
@@ -4,6 +4,8 @@
 #include "PartActor.h"
 
 #include "AssemblyComponent.h"
+#include "AssemblyStats.h"
+#include "SnapPointSubsystem.h"
 
 // Sets default values for this component's properties
 USnapPointComponent::USnapPointComponent()
@@ -12,23 +14,70 @@ USnapPointComponent::USnapPointComponent()
 	// off to improve performance if you don't need them.
 	PrimaryComponentTick.bCanEverTick = false;
 
+	// The detection sphere is no longer a default subobject; most snap points never use it,
+	// and a part with six snap points would otherwise carry twelve scene components
+}
+
+void USnapPointComponent::CreateDetectionSphere()
+{
+	if (SnapDetectionSphere || !GetOwner())
+	{
+		return;
+	}
+
 	//create snap detection sphere
-	SnapDetectionSphere = CreateDefaultSubobject<USphereComponent>(TEXT("SnapDetectionSphere"));
+	SnapDetectionSphere = NewObject<USphereComponent>(GetOwner(), NAME_None, RF_Transient);
 	SnapDetectionSphere->SetupAttachment(this);
 	SnapDetectionSphere->SetSphereRadius(SnapDetectionRadius);
 	SnapDetectionSphere->SetCollisionEnabled(ECollisionEnabled::QueryOnly);
 	SnapDetectionSphere->SetCollisionResponseToAllChannels(ECR_Ignore);
 	SnapDetectionSphere->SetCollisionResponseToChannel(ECC_WorldDynamic, ECR_Overlap); // For other parts
+	SnapDetectionSphere->SetGenerateOverlapEvents(true);
 
-	
-	
 	// Bind overlap events
 	SnapDetectionSphere->OnComponentBeginOverlap.AddDynamic(this, &USnapPointComponent::OnSnapDetectionBeginOverlap);
 	SnapDetectionSphere->OnComponentEndOverlap.AddDynamic(this, &USnapPointComponent::OnSnapDetectionEndOverlap);
-	// ...
+	SnapDetectionSphere->RegisterComponent();
+}
+
+void USnapPointComponent::BakeActorRelativeTransform()
+{
+	const AActor* Owner = GetOwner();
+	CachedActorRelativeTransform = Owner
+		? GetComponentTransform().GetRelativeTransform(Owner->GetActorTransform())
+		: GetRelativeTransform();
+	CachedActorRelativeInverse = CachedActorRelativeTransform.Inverse();
+	bHasCachedTransform = true;
+}
+
+FTransform USnapPointComponent::GetSnapWorldTransform() const
+{
+	const AActor* Owner = GetOwner();
+	if (!bHasCachedTransform || !Owner)
+	{
+		return GetComponentTransform();
+	}
+	return CachedActorRelativeTransform * Owner->GetActorTransform();
+}
+
+void USnapPointComponent::RefreshCachedTransform()
+{
+	// The one place a forced transform update is still warranted
+	UpdateComponentToWorld();
+	BakeActorRelativeTransform();
+
+	if (USnapPointSubsystem* SnapPointSubsystem = USnapPointSubsystem::Get(this))
+	{
+		SnapPointSubsystem->MarkOwnerDirty(GetOwner());
+	}
 }
+
 bool USnapPointComponent::CanAcceptSnapID(FName OtherSnapID) const
 {
+	if (CompatibilityTable && CompatIndex != INDEX_NONE)
+	{
+		return CompatibilityTable->AcceptsSnapID(CompatIndex, OtherSnapID);
+	}
 	return CompatibleSnapIDs.Contains(OtherSnapID);
 }
 
@@ -36,12 +85,51 @@ bool USnapPointComponent::CanAcceptSnapID(FName OtherSnapID) const
 bool USnapPointComponent::CanAcceptPoint(const USnapPointComponent* OtherSnapPoint) const
 {
 	if (!OtherSnapPoint) return false;
+	if (CompatibilityTable && CompatIndex != INDEX_NONE &&
+		OtherSnapPoint->CompatibilityTable == CompatibilityTable && OtherSnapPoint->CompatIndex != INDEX_NONE)
+	{
+		return CompatibilityTable->Accepts(CompatIndex, OtherSnapPoint->CompatIndex);
+	}
 	return CanAcceptSnapID(OtherSnapPoint->SnapID);
 }
 
+bool USnapPointComponent::CanMutuallyAccept(const USnapPointComponent* OtherSnapPoint) const
+{
+	if (!OtherSnapPoint) return false;
+	if (CompatibilityTable && CompatIndex != INDEX_NONE &&
+		OtherSnapPoint->CompatibilityTable == CompatibilityTable && OtherSnapPoint->CompatIndex != INDEX_NONE)
+	{
+		return CompatibilityTable->AreMutuallyCompatible(CompatIndex, OtherSnapPoint->CompatIndex);
+	}
+	return CanAcceptPoint(OtherSnapPoint) && OtherSnapPoint->CanAcceptPoint(this);
+}
+
+void USnapPointComponent::SetIsAssembled(bool bNewIsAssembled)
+{
+	if (bIsAssembled == bNewIsAssembled)
+	{
+		return;
+	}
+	bIsAssembled = bNewIsAssembled;
+	if (USnapPointSubsystem* SnapPointSubsystem = USnapPointSubsystem::Get(this))
+	{
+		SnapPointSubsystem->NotifySnapPointStateChanged(this);
+	}
+}
+
+void USnapPointComponent::RefreshCompatibility()
+{
+	if (USnapPointSubsystem* SnapPointSubsystem = USnapPointSubsystem::Get(this); SnapPointSubsystem && CompatibilityTable)
+	{
+		SnapPointSubsystem->RefreshCompatibility(this);
+	}
+}
+
 void USnapPointComponent::OnSnapDetectionBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor,
 	UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult)
 {
+	ASSEMBLY_SCOPE_CYCLE_COUNTER(SnapOverlapBegin);
+
 	// check if the overlapping component is another snap point
 	USnapPointComponent* OtherSnapPoint = Cast<USnapPointComponent>(OtherComp -> GetAttachParent());
 	if (!OtherSnapPoint)
@@ -94,6 +182,8 @@ void USnapPointComponent::OnSnapDetectionBeginOverlap(UPrimitiveComponent* Overl
 void USnapPointComponent::OnSnapDetectionEndOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor,
 	UPrimitiveComponent* OtherComp, int32 OtherBodyIndex)
 {
+	ASSEMBLY_SCOPE_CYCLE_COUNTER(SnapOverlapEnd);
+
 	USnapPointComponent* OtherSnapPoint = Cast<USnapPointComponent>(OtherComp->GetAttachParent());
 	if (!OtherSnapPoint)
 	{
@@ -121,6 +211,13 @@ void USnapPointComponent::OnSnapDetectionEndOverlap(UPrimitiveComponent* Overlap
 
 USnapPointComponent* USnapPointComponent::GetClosestCompatibleSnapPoint() const
 {
+	if (!bUseOverlapDetection)
+	{
+		// No overlap sphere, ask the world index instead
+		USnapPointSubsystem* SnapPointSubsystem = USnapPointSubsystem::Get(this);
+		return SnapPointSubsystem ? SnapPointSubsystem->FindClosestCompatibleSnapPoint(this, SnapDetectionRadius) : nullptr;
+	}
+
 	if (NearbySnapPoints.Num() == 0)
 	{
 		return nullptr; // No nearby snap points
@@ -173,6 +270,15 @@ void USnapPointComponent::CleanupNearbySnapPoints()
 bool USnapPointComponent::CanAcceptPart(const APartActor* Part) const
 {
 	if (!Part) return false;
+
+	if (CompatibilityTable && CompatIndex != INDEX_NONE)
+	{
+		const TOptional<bool> bAccepted = CompatibilityTable->AcceptsPartClass(CompatIndex, Part->GetClass());
+		if (bAccepted.IsSet())
+		{
+			return bAccepted.GetValue();
+		}
+	}
 	
 	// Check if the part's class is in our compatible parts list
 	for (const TSubclassOf<APartActor>& CompatiblePartClass : CompatibleParts)
@@ -185,13 +291,72 @@ bool USnapPointComponent::CanAcceptPart(const APartActor* Part) const
 	return false;
 }
 
+void USnapPointComponent::ResolveConstraintProfile()
+{
+	if (ConstraintProfileAsset)
+	{
+		ResolvedConstraintProfile = ConstraintProfileAsset->Profile;
+	}
+	else if (bUseConstraintProfile)
+	{
+		ResolvedConstraintProfile = ConstraintProfile;
+	}
+	else
+	{
+		ResolvedConstraintProfile = FSnapConstraintProfile::FromLegacyMetadata(Metadata);
+	}
+}
+
+void USnapPointComponent::MigrateMetadataToConstraintProfile()
+{
+	if (bUseConstraintProfile || ConstraintProfileAsset)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("SnapPoint %s: Already has a constraint profile, metadata not migrated"), *GetName());
+		return;
+	}
+
+	Modify();
+	ConstraintProfile = FSnapConstraintProfile::FromLegacyMetadata(Metadata);
+	bUseConstraintProfile = true;
+	ResolveConstraintProfile();
+
+	UE_LOG(LogTemp, Log, TEXT("SnapPoint %s: Migrated metadata \"%s\" to a %s constraint profile"), *GetName(), *Metadata,
+		*UEnum::GetDisplayValueAsText(ConstraintProfile.JointType).ToString());
+}
+
+void USnapPointComponent::OnRegister()
+{
+	Super::OnRegister();
+
+	ResolveConstraintProfile();
+}
+
 // Called when the game starts
 void USnapPointComponent::BeginPlay()
 {
 	Super::BeginPlay();
 
-	// ...
-	
+	BakeActorRelativeTransform();
+
+	if (bUseOverlapDetection)
+	{
+		CreateDetectionSphere();
+	}
+
+	if (USnapPointSubsystem* SnapPointSubsystem = USnapPointSubsystem::Get(this))
+	{
+		SnapPointSubsystem->RegisterSnapPoint(this);
+	}
+}
+
+void USnapPointComponent::EndPlay(const EEndPlayReason::Type EndPlayReason)
+{
+	if (USnapPointSubsystem* SnapPointSubsystem = USnapPointSubsystem::Get(this))
+	{
+		SnapPointSubsystem->UnregisterSnapPoint(this);
+	}
+
+	Super::EndPlay(EndPlayReason);
 }
 
 
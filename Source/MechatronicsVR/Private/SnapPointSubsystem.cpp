@@ -0,0 +1,462 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SnapPointSubsystem.h"
+#include "PartActor.h"
+#include "SnapPointComponent.h"
+#include "Engine/World.h"
+
+static TAutoConsoleVariable<float> CVarSnapAlignmentWeight(
+	TEXT("Assembly.SnapAlignmentWeight"),
+	5.0f,
+	TEXT("Score penalty (cm) per unit of forward misalignment when ranking snap candidates. 0 ranks by distance only."));
+
+static TAutoConsoleVariable<float> CVarPreviewFrameBudgetMs(
+	TEXT("Assembly.PreviewFrameBudgetMs"),
+	0.5f,
+	TEXT("Wall time (ms) all held parts together may spend re-scoring snap previews in one frame. 0 disables the limit."));
+
+void USnapPointSubsystem::Deinitialize()
+{
+	for (TPair<TObjectKey<AActor>, FOwnerEntry>& Pair : Owners)
+	{
+		if (USceneComponent* Root = Pair.Value.WatchedRoot.Get())
+		{
+			Root->TransformUpdated.Remove(Pair.Value.TransformUpdatedHandle);
+		}
+	}
+	Owners.Empty();
+	Cells.Empty();
+	SnapPointCells.Empty();
+	DirtyOwners.Empty();
+	CompatibilityTable.Reset();
+	PoseCache.Reset();
+	PoseRows.Empty();
+
+	Super::Deinitialize();
+}
+
+USnapPointSubsystem* USnapPointSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<USnapPointSubsystem>() : nullptr;
+}
+
+void USnapPointSubsystem::RegisterSnapPoint(USnapPointComponent* SnapPoint)
+{
+	if (!SnapPoint || SnapPointCells.Contains(SnapPoint))
+	{
+		return;
+	}
+
+	AActor* Owner = SnapPoint->GetOwner();
+	if (!Owner)
+	{
+		return;
+	}
+
+	FOwnerEntry& Entry = Owners.FindOrAdd(TObjectKey<AActor>(Owner));
+	Entry.SnapPoints.Add(SnapPoint);
+
+	// Watch the owner's root once, every snap point on it moves rigidly with it
+	if (!Entry.WatchedRoot.IsValid())
+	{
+		if (USceneComponent* Root = Owner->GetRootComponent())
+		{
+			Entry.WatchedRoot = Root;
+			Entry.TransformUpdatedHandle = Root->TransformUpdated.AddUObject(this, &USnapPointSubsystem::HandleOwnerTransformUpdated);
+		}
+	}
+
+	const FIntVector Cell = CellFor(SnapPoint->GetComponentLocation());
+	InsertIntoCell(SnapPoint, Cell);
+	SnapPointCells.Add(SnapPoint, Cell);
+	bPoseLayoutDirty = true;
+
+	if (Owner->IsA<APartActor>())
+	{
+		CompatibilityTable.AddPartClass(Owner->GetClass());
+	}
+	RefreshCompatibility(SnapPoint);
+}
+
+void USnapPointSubsystem::RefreshCompatibility(USnapPointComponent* SnapPoint)
+{
+	if (!SnapPoint)
+	{
+		return;
+	}
+	SnapPoint->CompatibilityTable = &CompatibilityTable;
+	SnapPoint->CompatIndex = CompatibilityTable.AddProfile(SnapPoint->SnapID, SnapPoint->CompatibleSnapIDs, SnapPoint->CompatibleParts);
+	MarkOwnerDirty(SnapPoint->GetOwner());
+}
+
+void USnapPointSubsystem::UnregisterSnapPoint(USnapPointComponent* SnapPoint)
+{
+	FIntVector Cell;
+	if (!SnapPoint || !SnapPointCells.RemoveAndCopyValue(SnapPoint, Cell))
+	{
+		return;
+	}
+	RemoveFromCell(SnapPoint, Cell);
+	bPoseLayoutDirty = true;
+	SnapPoint->CompatibilityTable = nullptr;
+	SnapPoint->CompatIndex = INDEX_NONE;
+
+	const TObjectKey<AActor> OwnerKey(SnapPoint->GetOwner());
+	if (FOwnerEntry* Entry = Owners.Find(OwnerKey))
+	{
+		Entry->SnapPoints.RemoveSwap(SnapPoint);
+		if (Entry->SnapPoints.Num() == 0)
+		{
+			if (USceneComponent* Root = Entry->WatchedRoot.Get())
+			{
+				Root->TransformUpdated.Remove(Entry->TransformUpdatedHandle);
+			}
+			Owners.Remove(OwnerKey);
+			DirtyOwners.RemoveSwap(OwnerKey);
+		}
+	}
+}
+
+void USnapPointSubsystem::MarkOwnerDirty(const AActor* Owner)
+{
+	const TObjectKey<AActor> OwnerKey(Owner);
+	if (FOwnerEntry* Entry = Owners.Find(OwnerKey))
+	{
+		if (!Entry->bDirty)
+		{
+			Entry->bDirty = true;
+			DirtyOwners.Add(OwnerKey);
+		}
+	}
+}
+
+void USnapPointSubsystem::HandleOwnerTransformUpdated(USceneComponent* UpdatedComponent,
+	EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport)
+{
+	if (UpdatedComponent)
+	{
+		MarkOwnerDirty(UpdatedComponent->GetOwner());
+	}
+}
+
+FIntVector USnapPointSubsystem::CellFor(const FVector& Location) const
+{
+	const double InvCellSize = 1.0 / CellSize;
+	return FIntVector(
+		FMath::FloorToInt32(Location.X * InvCellSize),
+		FMath::FloorToInt32(Location.Y * InvCellSize),
+		FMath::FloorToInt32(Location.Z * InvCellSize));
+}
+
+void USnapPointSubsystem::InsertIntoCell(USnapPointComponent* SnapPoint, const FIntVector& Cell)
+{
+	Cells.FindOrAdd(Cell).Add(SnapPoint);
+}
+
+void USnapPointSubsystem::RemoveFromCell(USnapPointComponent* SnapPoint, const FIntVector& Cell)
+{
+	if (TArray<USnapPointComponent*>* Bucket = Cells.Find(Cell))
+	{
+		Bucket->RemoveSwap(SnapPoint);
+		if (Bucket->Num() == 0)
+		{
+			Cells.Remove(Cell);
+		}
+	}
+}
+
+void USnapPointSubsystem::FlushDirtyOwners()
+{
+	// Every query flushes first, so the level's snap points have all registered by the first compile;
+	// later spawns only add their own rows
+	CompatibilityTable.CompileIfDirty();
+
+	for (const TObjectKey<AActor>& OwnerKey : DirtyOwners)
+	{
+		FOwnerEntry* Entry = Owners.Find(OwnerKey);
+		if (!Entry)
+		{
+			continue;
+		}
+		Entry->bDirty = false;
+
+		if (!bPoseLayoutDirty && Entry->PoseRowBegin != INDEX_NONE)
+		{
+			PoseCache.RefreshBlock(Entry->PoseRowBegin, Entry->SnapPoints.Num());
+		}
+
+		for (USnapPointComponent* SnapPoint : Entry->SnapPoints)
+		{
+			FIntVector& CurrentCell = SnapPointCells.FindChecked(SnapPoint);
+			const FIntVector NewCell = CellFor(SnapPoint->GetComponentLocation());
+			if (NewCell != CurrentCell)
+			{
+				RemoveFromCell(SnapPoint, CurrentCell);
+				InsertIntoCell(SnapPoint, NewCell);
+				CurrentCell = NewCell;
+			}
+		}
+	}
+	DirtyOwners.Reset();
+}
+
+void USnapPointSubsystem::RebuildIndex()
+{
+	Cells.Reset();
+	for (TPair<const USnapPointComponent*, FIntVector>& Pair : SnapPointCells)
+	{
+		USnapPointComponent* SnapPoint = const_cast<USnapPointComponent*>(Pair.Key);
+		Pair.Value = CellFor(SnapPoint->GetComponentLocation());
+		InsertIntoCell(SnapPoint, Pair.Value);
+	}
+	for (TPair<TObjectKey<AActor>, FOwnerEntry>& Pair : Owners)
+	{
+		Pair.Value.bDirty = false;
+	}
+	DirtyOwners.Reset();
+}
+
+void USnapPointSubsystem::SetCellSize(float NewCellSize)
+{
+	if (NewCellSize <= KINDA_SMALL_NUMBER || FMath::IsNearlyEqual(NewCellSize, CellSize))
+	{
+		return;
+	}
+	CellSize = NewCellSize;
+	RebuildIndex();
+}
+
+void USnapPointSubsystem::QueryCompatibleSnapPoints(const FVector& Location, float Radius,
+	const USnapPointComponent* Source, TArray<USnapPointComponent*>& OutSnapPoints)
+{
+	OutSnapPoints.Reset();
+	if (Radius <= 0.0f)
+	{
+		return;
+	}
+
+	FlushDirtyOwners();
+
+	const AActor* SourceOwner = Source ? Source->GetOwner() : nullptr;
+	const FIntVector MinCell = CellFor(Location - FVector(Radius));
+	const FIntVector MaxCell = CellFor(Location + FVector(Radius));
+	const double RadiusSquared = FMath::Square(static_cast<double>(Radius));
+
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				const TArray<USnapPointComponent*>* Bucket = Cells.Find(FIntVector(X, Y, Z));
+				if (!Bucket)
+				{
+					continue;
+				}
+
+				for (USnapPointComponent* Candidate : *Bucket)
+				{
+					if (Candidate == Source || Candidate->bIsAssembled)
+					{
+						continue;
+					}
+					if (SourceOwner && Candidate->GetOwner() == SourceOwner)
+					{
+						continue;
+					}
+					if (FVector::DistSquared(Candidate->GetComponentLocation(), Location) > RadiusSquared)
+					{
+						continue;
+					}
+					if (Source && !Source->CanMutuallyAccept(Candidate))
+					{
+						continue;
+					}
+					OutSnapPoints.Add(Candidate);
+				}
+			}
+		}
+	}
+}
+
+void USnapPointSubsystem::EnsurePoseCacheLayout()
+{
+	if (!bPoseLayoutDirty)
+	{
+		return;
+	}
+
+	// Lay every owner's snap points out as one contiguous block
+	PoseCache.Reset();
+	PoseRows.Reset();
+	for (TPair<TObjectKey<AActor>, FOwnerEntry>& Pair : Owners)
+	{
+		FOwnerEntry& Entry = Pair.Value;
+		Entry.PoseRowBegin = PoseCache.AddBlock(Entry.SnapPoints);
+		for (int32 Index = 0; Index < Entry.SnapPoints.Num(); ++Index)
+		{
+			PoseRows.Add(Entry.SnapPoints[Index], Entry.PoseRowBegin + Index);
+		}
+	}
+	bPoseLayoutDirty = false;
+}
+
+FSnapPoseQuery USnapPointSubsystem::MakePoseQuery(const USnapPointComponent* Source, float Radius) const
+{
+	FSnapPoseQuery Query;
+	const FTransform& SourceTransform = Source->GetComponentTransform();
+	Query.Location = SourceTransform.GetLocation();
+	Query.Forward = SourceTransform.GetUnitAxis(EAxis::X);
+	Query.MaxDistance = Radius;
+	Query.AlignmentWeight = CVarSnapAlignmentWeight.GetValueOnGameThread();
+	Query.CompatIndex = Source->GetCompatIndex();
+	Query.CompatibilityTable = Source->CompatibilityTable;
+	return Query;
+}
+
+bool USnapPointSubsystem::GatherPoseBlocks(const FVector& Location, float Radius, const AActor* IgnoreOwner)
+{
+	PoseBlockScratch.Reset();
+
+	// A radius spanning more cells than are occupied is cheaper to answer by scoring every row
+	const double CellSpan = 2.0 * Radius / CellSize + 1.0;
+	if (CellSpan * CellSpan * CellSpan > Cells.Num())
+	{
+		return false;
+	}
+
+	// Owners with a snap point within Radius; each contributes its whole contiguous block
+	const FIntVector MinCell = CellFor(Location - FVector(Radius));
+	const FIntVector MaxCell = CellFor(Location + FVector(Radius));
+	const double RadiusSquared = FMath::Square(static_cast<double>(Radius));
+	for (int32 X = MinCell.X; X <= MaxCell.X; ++X)
+	{
+		for (int32 Y = MinCell.Y; Y <= MaxCell.Y; ++Y)
+		{
+			for (int32 Z = MinCell.Z; Z <= MaxCell.Z; ++Z)
+			{
+				const TArray<USnapPointComponent*>* Bucket = Cells.Find(FIntVector(X, Y, Z));
+				if (!Bucket)
+				{
+					continue;
+				}
+
+				for (const USnapPointComponent* Candidate : *Bucket)
+				{
+					const AActor* CandidateOwner = Candidate->GetOwner();
+					if (CandidateOwner == IgnoreOwner || Candidate->bIsAssembled ||
+						FVector::DistSquared(Candidate->GetComponentLocation(), Location) > RadiusSquared)
+					{
+						continue;
+					}
+
+					const FOwnerEntry* Entry = Owners.Find(TObjectKey<AActor>(CandidateOwner));
+					if (Entry && Entry->PoseRowBegin != INDEX_NONE &&
+						!PoseBlockScratch.ContainsByPredicate([Entry](const FSnapPoseBlock& Block) { return Block.FirstRow == Entry->PoseRowBegin; }))
+					{
+						PoseBlockScratch.Add(FSnapPoseBlock{ Entry->PoseRowBegin, Entry->SnapPoints.Num() });
+					}
+				}
+			}
+		}
+	}
+	return true;
+}
+
+void USnapPointSubsystem::FindBestSnapCandidates(const USnapPointComponent* Source, float Radius, int32 K,
+	TArray<FSnapPoseCandidate>& OutBest)
+{
+	OutBest.Reset();
+	if (!Source || Source->bIsAssembled || Radius <= 0.0f)
+	{
+		return;
+	}
+
+	EnsurePoseCacheLayout();
+	FlushDirtyOwners();
+
+	FSnapPoseQuery Query = MakePoseQuery(Source, Radius);
+	Query.IgnoreOwner = Source->GetOwner();
+
+	const bool bLocalBlocks = GatherPoseBlocks(Query.Location, Radius, Query.IgnoreOwner);
+	if (!bLocalBlocks)
+	{
+		PoseBlockScratch.Reset();
+		PoseBlockScratch.Add(FSnapPoseBlock{ 0, PoseCache.Num() });
+	}
+
+	if (Query.CompatIndex == INDEX_NONE)
+	{
+		// Not interned yet, score every nearby row and check compatibility the slow way
+		int32 NumNearbyRows = 0;
+		for (const FSnapPoseBlock& Block : PoseBlockScratch)
+		{
+			NumNearbyRows += Block.NumRows;
+		}
+		PoseCache.FindBestK(Query, PoseBlockScratch, NumNearbyRows, OutBest);
+		OutBest.RemoveAll([Source](const FSnapPoseCandidate& Candidate) { return !Source->CanMutuallyAccept(Candidate.SnapPoint); });
+		OutBest.SetNum(FMath::Min(OutBest.Num(), K));
+		return;
+	}
+	PoseCache.FindBestK(Query, PoseBlockScratch, K, OutBest);
+}
+
+USnapPointComponent* USnapPointSubsystem::FindClosestCompatibleSnapPoint(const USnapPointComponent* Source, float Radius)
+{
+	FindBestSnapCandidates(Source, Radius, 1, CandidateScratch);
+	return CandidateScratch.Num() > 0 ? CandidateScratch[0].SnapPoint : nullptr;
+}
+
+bool USnapPointSubsystem::FindBestSnapPointOnOwner(const AActor* Owner, const USnapPointComponent* Target,
+	USnapPointComponent*& OutSnapPoint)
+{
+	OutSnapPoint = nullptr;
+	if (!Owner || !Target || Target->GetCompatIndex() == INDEX_NONE)
+	{
+		return false;
+	}
+
+	EnsurePoseCacheLayout();
+	FlushDirtyOwners();
+
+	const FOwnerEntry* Entry = Owners.Find(TObjectKey<AActor>(Owner));
+	if (!Entry || Entry->PoseRowBegin == INDEX_NONE)
+	{
+		return false;
+	}
+
+	const FSnapPoseQuery Query = MakePoseQuery(Target, FLT_MAX);
+	PoseCache.FindBestK(Query, Entry->PoseRowBegin, Entry->SnapPoints.Num(), 1, CandidateScratch);
+	OutSnapPoint = CandidateScratch.Num() > 0 ? CandidateScratch[0].SnapPoint : nullptr;
+	return true;
+}
+
+void USnapPointSubsystem::NotifySnapPointStateChanged(const USnapPointComponent* SnapPoint)
+{
+	if (bPoseLayoutDirty || !SnapPoint)
+	{
+		return;
+	}
+	if (const int32* Row = PoseRows.Find(SnapPoint))
+	{
+		PoseCache.SetRowFree(*Row, !SnapPoint->bIsAssembled);
+	}
+}
+
+bool USnapPointSubsystem::TryBeginPreviewEvaluation()
+{
+	if (PreviewBudgetFrame != GFrameCounter)
+	{
+		PreviewBudgetFrame = GFrameCounter;
+		PreviewBudgetSpentSeconds = 0.0;
+	}
+
+	const float BudgetMs = CVarPreviewFrameBudgetMs.GetValueOnGameThread();
+	return BudgetMs <= 0.0f || PreviewBudgetSpentSeconds * 1000.0 < BudgetMs;
+}
+
+void USnapPointSubsystem::EndPreviewEvaluation(double ElapsedSeconds)
+{
+	PreviewBudgetSpentSeconds += ElapsedSeconds;
+}
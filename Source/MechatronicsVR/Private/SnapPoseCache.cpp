@@ -0,0 +1,187 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SnapPoseCache.h"
+#include "SnapCompatibilityTable.h"
+#include "SnapPointComponent.h"
+#include "Math/VectorRegister.h"
+
+void FSnapPoseCache::Reset()
+{
+	PosX.Reset();
+	PosY.Reset();
+	PosZ.Reset();
+	FwdX.Reset();
+	FwdY.Reset();
+	FwdZ.Reset();
+	Penalty.Reset();
+	CompatIndices.Reset();
+	Owners.Reset();
+	SnapPoints.Reset();
+	NumRows = 0;
+}
+
+void FSnapPoseCache::PadTo(int32 NewNumRows)
+{
+	PosX.SetNumZeroed(NewNumRows);
+	PosY.SetNumZeroed(NewNumRows);
+	PosZ.SetNumZeroed(NewNumRows);
+	FwdX.SetNumZeroed(NewNumRows);
+	FwdY.SetNumZeroed(NewNumRows);
+	FwdZ.SetNumZeroed(NewNumRows);
+	CompatIndices.SetNumZeroed(NewNumRows);
+	Owners.SetNumZeroed(NewNumRows);
+	SnapPoints.SetNumZeroed(NewNumRows);
+
+	const int32 OldNumRows = Penalty.Num();
+	Penalty.SetNumUninitialized(NewNumRows);
+	for (int32 Row = OldNumRows; Row < NewNumRows; ++Row)
+	{
+		Penalty[Row] = TNumericLimits<float>::Max();
+		CompatIndices[Row] = INDEX_NONE;
+	}
+	NumRows = NewNumRows;
+}
+
+int32 FSnapPoseCache::AddBlock(TConstArrayView<USnapPointComponent*> BlockSnapPoints)
+{
+	// Blocks start on a lane boundary so they can be scored with aligned loads
+	const int32 FirstRow = NumRows;
+	PadTo(FirstRow + Align(BlockSnapPoints.Num(), Lanes));
+
+	for (int32 Index = 0; Index < BlockSnapPoints.Num(); ++Index)
+	{
+		SnapPoints[FirstRow + Index] = BlockSnapPoints[Index];
+	}
+	RefreshBlock(FirstRow, BlockSnapPoints.Num());
+	return FirstRow;
+}
+
+void FSnapPoseCache::RefreshBlock(int32 FirstRow, int32 NumBlockRows)
+{
+	for (int32 Row = FirstRow; Row < FirstRow + NumBlockRows; ++Row)
+	{
+		const USnapPointComponent* SnapPoint = SnapPoints[Row];
+		if (!SnapPoint)
+		{
+			continue;
+		}
+
+		const FTransform& WorldTransform = SnapPoint->GetComponentTransform();
+		const FVector Location = WorldTransform.GetLocation();
+		const FVector Forward = WorldTransform.GetUnitAxis(EAxis::X);
+		PosX[Row] = static_cast<float>(Location.X);
+		PosY[Row] = static_cast<float>(Location.Y);
+		PosZ[Row] = static_cast<float>(Location.Z);
+		FwdX[Row] = static_cast<float>(Forward.X);
+		FwdY[Row] = static_cast<float>(Forward.Y);
+		FwdZ[Row] = static_cast<float>(Forward.Z);
+		Penalty[Row] = SnapPoint->bIsAssembled ? TNumericLimits<float>::Max() : 0.0f;
+		CompatIndices[Row] = SnapPoint->GetCompatIndex();
+		Owners[Row] = SnapPoint->GetOwner();
+	}
+}
+
+void FSnapPoseCache::SetRowFree(int32 Row, bool bFree)
+{
+	if (SnapPoints.IsValidIndex(Row) && SnapPoints[Row])
+	{
+		Penalty[Row] = bFree ? 0.0f : TNumericLimits<float>::Max();
+	}
+}
+
+void FSnapPoseCache::FindBestK(const FSnapPoseQuery& Query, int32 FirstRow, int32 NumQueryRows, int32 K,
+	TArray<FSnapPoseCandidate>& OutBest)
+{
+	OutBest.Reset();
+	if (K <= 0 || NumQueryRows <= 0)
+	{
+		return;
+	}
+	Scores.SetNumUninitialized(NumRows, EAllowShrinking::No);
+	ScoreBlock(Query, FirstRow, NumQueryRows, K, OutBest);
+}
+
+void FSnapPoseCache::FindBestK(const FSnapPoseQuery& Query, TConstArrayView<FSnapPoseBlock> Blocks, int32 K,
+	TArray<FSnapPoseCandidate>& OutBest)
+{
+	OutBest.Reset();
+	if (K <= 0)
+	{
+		return;
+	}
+	Scores.SetNumUninitialized(NumRows, EAllowShrinking::No);
+	for (const FSnapPoseBlock& Block : Blocks)
+	{
+		if (Block.NumRows > 0)
+		{
+			ScoreBlock(Query, Block.FirstRow, Block.NumRows, K, OutBest);
+		}
+	}
+}
+
+void FSnapPoseCache::ScoreBlock(const FSnapPoseQuery& Query, int32 FirstRow, int32 NumBlockRows, int32 K,
+	TArray<FSnapPoseCandidate>& OutBest)
+{
+	check(FirstRow % Lanes == 0);
+	const int32 EndRow = FMath::Min(FirstRow + Align(NumBlockRows, Lanes), NumRows);
+
+	// Vector pass: score = distance + weight * (1 - dot(forward, query forward)) + penalty
+	const VectorRegister4Float QueryX = VectorSetFloat1(static_cast<float>(Query.Location.X));
+	const VectorRegister4Float QueryY = VectorSetFloat1(static_cast<float>(Query.Location.Y));
+	const VectorRegister4Float QueryZ = VectorSetFloat1(static_cast<float>(Query.Location.Z));
+	const VectorRegister4Float QueryFwdX = VectorSetFloat1(static_cast<float>(Query.Forward.X));
+	const VectorRegister4Float QueryFwdY = VectorSetFloat1(static_cast<float>(Query.Forward.Y));
+	const VectorRegister4Float QueryFwdZ = VectorSetFloat1(static_cast<float>(Query.Forward.Z));
+	const VectorRegister4Float Weight = VectorSetFloat1(Query.AlignmentWeight);
+	const VectorRegister4Float One = VectorSetFloat1(1.0f);
+	const VectorRegister4Float Epsilon = VectorSetFloat1(UE_SMALL_NUMBER);
+	const VectorRegister4Float MaxDistance = VectorSetFloat1(Query.MaxDistance);
+	const VectorRegister4Float Rejected = VectorSetFloat1(TNumericLimits<float>::Max());
+
+	for (int32 Row = FirstRow; Row < EndRow; Row += Lanes)
+	{
+		const VectorRegister4Float DX = VectorSubtract(VectorLoadAligned(&PosX[Row]), QueryX);
+		const VectorRegister4Float DY = VectorSubtract(VectorLoadAligned(&PosY[Row]), QueryY);
+		const VectorRegister4Float DZ = VectorSubtract(VectorLoadAligned(&PosZ[Row]), QueryZ);
+		const VectorRegister4Float DistSquared = VectorMultiplyAdd(DZ, DZ, VectorMultiplyAdd(DY, DY, VectorMultiply(DX, DX)));
+		const VectorRegister4Float Distance = VectorMultiply(DistSquared, VectorReciprocalSqrt(VectorAdd(DistSquared, Epsilon)));
+
+		const VectorRegister4Float Dot = VectorMultiplyAdd(VectorLoadAligned(&FwdZ[Row]), QueryFwdZ,
+			VectorMultiplyAdd(VectorLoadAligned(&FwdY[Row]), QueryFwdY, VectorMultiply(VectorLoadAligned(&FwdX[Row]), QueryFwdX)));
+
+		VectorRegister4Float Score = VectorMultiplyAdd(Weight, VectorSubtract(One, Dot), Distance);
+		Score = VectorAdd(Score, VectorLoadAligned(&Penalty[Row]));
+		Score = VectorSelect(VectorCompareGT(Distance, MaxDistance), Rejected, Score);
+		VectorStoreAligned(Score, &Scores[Row]);
+	}
+
+	// Scalar pass: keep a sorted top K, checking owner and compatibility only for rows that would make it
+	for (int32 Row = FirstRow; Row < EndRow; ++Row)
+	{
+		const float Score = Scores[Row];
+		if (Score >= TNumericLimits<float>::Max() || (OutBest.Num() == K && Score >= OutBest.Last().Score))
+		{
+			continue;
+		}
+		if (Query.IgnoreOwner && Owners[Row] == Query.IgnoreOwner)
+		{
+			continue;
+		}
+		if (Query.CompatibilityTable && Query.CompatIndex != INDEX_NONE &&
+			(CompatIndices[Row] == INDEX_NONE || !Query.CompatibilityTable->AreMutuallyCompatible(Query.CompatIndex, CompatIndices[Row])))
+		{
+			continue;
+		}
+
+		int32 InsertAt = OutBest.Num();
+		while (InsertAt > 0 && OutBest[InsertAt - 1].Score > Score)
+		{
+			--InsertAt;
+		}
+		if (OutBest.Num() == K)
+		{
+			OutBest.Pop(EAllowShrinking::No);
+		}
+		OutBest.Insert(FSnapPoseCandidate{ SnapPoints[Row], Score }, InsertAt);
+	}
+}
@@ -0,0 +1,204 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SnapPreviewSubsystem.h"
+#include "PartActor.h"
+#include "Components/StaticMeshComponent.h"
+#include "Engine/World.h"
+
+static TAutoConsoleVariable<int32> CVarGhostsPerHand(
+	TEXT("Assembly.Preview.GhostsPerHand"),
+	1,
+	TEXT("Ghost previews one hand may show at once. A further preview from the same hand takes back its oldest ghost."));
+
+void USnapPreviewSubsystem::Deinitialize()
+{
+	for (FSnapPreviewGhost& Ghost : Ghosts)
+	{
+		Ghost.MaterialCache.Reset();
+	}
+	Ghosts.Empty();
+
+	if (GhostOwner)
+	{
+		GhostOwner->Destroy();
+		GhostOwner = nullptr;
+	}
+
+	Super::Deinitialize();
+}
+
+USnapPreviewSubsystem* USnapPreviewSubsystem::Get(const UObject* WorldContextObject)
+{
+	const UWorld* World = WorldContextObject ? WorldContextObject->GetWorld() : nullptr;
+	return World ? World->GetSubsystem<USnapPreviewSubsystem>() : nullptr;
+}
+
+int32 USnapPreviewSubsystem::GetNumActiveGhosts() const
+{
+	int32 NumActive = 0;
+	for (const FSnapPreviewGhost& Ghost : Ghosts)
+	{
+		NumActive += Ghost.User.IsValid() ? 1 : 0;
+	}
+	return NumActive;
+}
+
+bool USnapPreviewSubsystem::ShowGhost(APartActor* Part, FName Hand, const UStaticMeshComponent* SourceMesh, const FTransform& Transform,
+	UMaterialInterface* OverrideMaterial, float Opacity, const FLinearColor& Color)
+{
+	if (!Part || !SourceMesh || !SourceMesh->GetStaticMesh())
+	{
+		return false;
+	}
+
+	const int32 GhostIndex = AcquireGhost(Part, Hand);
+	if (GhostIndex == INDEX_NONE)
+	{
+		return false;
+	}
+	FSnapPreviewGhost& Ghost = Ghosts[GhostIndex];
+	UStaticMeshComponent* GhostMesh = Ghost.Mesh;
+
+	// Only re-assign what changed, SetStaticMesh and SetMaterial both dirty the render state
+	if (GhostMesh->GetStaticMesh() != SourceMesh->GetStaticMesh())
+	{
+		GhostMesh->SetStaticMesh(SourceMesh->GetStaticMesh());
+	}
+	GhostMesh->SetWorldTransform(Transform);
+
+	for (int32 i = 0; i < GhostMesh->GetNumMaterials(); i++)
+	{
+		UMaterialInstanceDynamic* DynamicMaterial = OverrideMaterial
+			? Ghost.MaterialCache.GetOrCreate(OverrideMaterial, GhostOwner, Opacity, &Color)
+			: Ghost.MaterialCache.GetOrCreate(SourceMesh->GetMaterial(i), GhostOwner, Opacity, nullptr);
+		if (DynamicMaterial && GhostMesh->GetMaterial(i) != DynamicMaterial)
+		{
+			GhostMesh->SetMaterial(i, DynamicMaterial);
+		}
+	}
+
+	GhostMesh->SetVisibility(true);
+	return true;
+}
+
+void USnapPreviewSubsystem::HideGhost(APartActor* Part)
+{
+	const int32 GhostIndex = FindGhost(Part);
+	if (GhostIndex == INDEX_NONE)
+	{
+		return;
+	}
+
+	FSnapPreviewGhost& Ghost = Ghosts[GhostIndex];
+	if (Ghost.Mesh)
+	{
+		Ghost.Mesh->SetVisibility(false);
+	}
+	Ghost.User = nullptr;
+	Ghost.Hand = NAME_None;
+}
+
+int32 USnapPreviewSubsystem::FindGhost(const APartActor* Part) const
+{
+	if (!Part)
+	{
+		return INDEX_NONE;
+	}
+	return Ghosts.IndexOfByPredicate([Part](const FSnapPreviewGhost& Ghost)
+	{
+		return Ghost.User.Get() == Part;
+	});
+}
+
+int32 USnapPreviewSubsystem::AcquireGhost(APartActor* Part, FName Hand)
+{
+	int32 GhostIndex = FindGhost(Part);
+	if (GhostIndex != INDEX_NONE)
+	{
+		// The part may have changed hands since it borrowed the ghost
+		Ghosts[GhostIndex].Hand = Hand;
+		return GhostIndex;
+	}
+
+	// Take back this hand's oldest ghost once it has used up its share
+	if (Hand != NAME_None)
+	{
+		int32 NumInHand = 0;
+		int32 OldestIndex = INDEX_NONE;
+		for (int32 Index = 0; Index < Ghosts.Num(); ++Index)
+		{
+			const FSnapPreviewGhost& Ghost = Ghosts[Index];
+			if (Ghost.User.IsValid() && Ghost.Hand == Hand)
+			{
+				++NumInHand;
+				if (OldestIndex == INDEX_NONE || Ghost.AcquireSerial < Ghosts[OldestIndex].AcquireSerial)
+				{
+					OldestIndex = Index;
+				}
+			}
+		}
+		if (OldestIndex != INDEX_NONE && NumInHand >= FMath::Max(1, CVarGhostsPerHand.GetValueOnGameThread()))
+		{
+			// Let the previous user clear its own preview state, which returns the ghost to the pool
+			APartActor* PreviousUser = Ghosts[OldestIndex].User.Get();
+			PreviousUser->HideSnapPreview();
+			HideGhost(PreviousUser);
+		}
+	}
+
+	GhostIndex = Ghosts.IndexOfByPredicate([](const FSnapPreviewGhost& Ghost)
+	{
+		return !Ghost.User.IsValid() && Ghost.Mesh;
+	});
+	if (GhostIndex == INDEX_NONE)
+	{
+		GhostIndex = CreateGhost();
+		if (GhostIndex == INDEX_NONE)
+		{
+			return INDEX_NONE;
+		}
+	}
+
+	FSnapPreviewGhost& Ghost = Ghosts[GhostIndex];
+	Ghost.User = Part;
+	Ghost.Hand = Hand;
+	Ghost.AcquireSerial = ++NextAcquireSerial;
+	return GhostIndex;
+}
+
+int32 USnapPreviewSubsystem::CreateGhost()
+{
+	UWorld* World = GetWorld();
+	if (!World)
+	{
+		return INDEX_NONE;
+	}
+
+	if (!GhostOwner)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.Name = TEXT("SnapPreviewGhosts");
+		SpawnParams.NameMode = FActorSpawnParameters::ESpawnActorNameMode::Requested;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		GhostOwner = World->SpawnActor<AActor>(AActor::StaticClass(), FTransform::Identity, SpawnParams);
+		if (!GhostOwner)
+		{
+			return INDEX_NONE;
+		}
+	}
+
+	UStaticMeshComponent* GhostMesh = NewObject<UStaticMeshComponent>(GhostOwner, NAME_None, RF_Transient);
+	GhostMesh->SetMobility(EComponentMobility::Movable);
+	GhostMesh->SetCollisionEnabled(ECollisionEnabled::NoCollision);
+	GhostMesh->SetCastShadow(false);
+	GhostMesh->SetVisibility(false);
+	if (!GhostOwner->GetRootComponent())
+	{
+		GhostOwner->SetRootComponent(GhostMesh);
+	}
+	GhostMesh->RegisterComponent();
+
+	FSnapPreviewGhost& Ghost = Ghosts.AddDefaulted_GetRef();
+	Ghost.Mesh = GhostMesh;
+	return Ghosts.Num() - 1;
+}
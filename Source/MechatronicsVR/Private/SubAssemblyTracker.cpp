@@ -0,0 +1,292 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "SubAssemblyTracker.h"
+
+FSubAssemblyTracker::FSubAssemblyTracker()
+{
+	Reset();
+}
+
+void FSubAssemblyTracker::Reset()
+{
+	PartNodes.Reset();
+	NodeParts.Reset();
+	Parent.Reset();
+	Size.Reset();
+	Next.Reset();
+	FreeNodes.Reset();
+	VisitStamp.Reset();
+	VisitSide.Reset();
+	SearchStamp = 0;
+
+	// Node 0 is the base
+	NodeParts.Add(nullptr);
+	Parent.Add(GroundNode);
+	Size.Add(1);
+	Next.Add(GroundNode);
+	VisitStamp.Add(0);
+	VisitSide.Add(0);
+	NumSets = 1;
+}
+
+void FSubAssemblyTracker::AddPart(APartActor* Part)
+{
+	FindOrAddNode(Part);
+}
+
+void FSubAssemblyTracker::RemovePart(const APartActor* Part)
+{
+	const int32 Node = Part ? FindNode(Part) : INDEX_NONE;
+	if (Node == INDEX_NONE)
+	{
+		return;
+	}
+	if (Size[FindRoot(Node)] != 1)
+	{
+		UE_LOG(LogTemp, Warning, TEXT("FSubAssemblyTracker::RemovePart: Part is still connected, disconnect it first"));
+		return;
+	}
+
+	PartNodes.Remove(Part);
+	NodeParts[Node] = nullptr;
+	FreeNodes.Add(Node);
+	--NumSets;
+}
+
+void FSubAssemblyTracker::Connect(APartActor* PartA, APartActor* PartB)
+{
+	const int32 NodeA = FindOrAddNode(PartA);
+	const int32 NodeB = FindOrAddNode(PartB);
+	Union(NodeA, NodeB);
+}
+
+void FSubAssemblyTracker::Disconnect(APartActor* PartA, APartActor* PartB, FGetNeighbors GetNeighbors)
+{
+	const int32 NodeA = FindNode(PartA);
+	const int32 NodeB = FindNode(PartB);
+	if (NodeA == INDEX_NONE || NodeB == INDEX_NONE || NodeA == NodeB || FindRoot(NodeA) != FindRoot(NodeB))
+	{
+		return;
+	}
+
+	if (++SearchStamp == 0)
+	{
+		FMemory::Memzero(VisitStamp.GetData(), VisitStamp.Num() * sizeof(uint32));
+		SearchStamp = 1;
+	}
+
+	// Grow one search from each endpoint, a node at a time, until they meet or one runs dry.
+	// Scratch lives on the frame stack and is popped when Mark goes out of scope.
+	FMemMark Mark(FMemStack::Get());
+	TArray<int32, TMemStackAllocator<>> Queues[2];
+	int32 Heads[2] = { 0, 0 };
+	Queues[0].Add(NodeA);
+	Queues[1].Add(NodeB);
+	VisitStamp[NodeA] = VisitStamp[NodeB] = SearchStamp;
+	VisitSide[NodeA] = 0;
+	VisitSide[NodeB] = 1;
+
+	FNeighborArray Neighbors;
+	int32 SplitSide = INDEX_NONE;
+	while (SplitSide == INDEX_NONE)
+	{
+		for (int32 Side = 0; Side < 2; ++Side)
+		{
+			if (Heads[Side] == Queues[Side].Num())
+			{
+				SplitSide = Side;
+				break;
+			}
+
+			const int32 Node = Queues[Side][Heads[Side]++];
+			Neighbors.Reset();
+			GetNeighbors(NodeParts[Node], Neighbors);
+			for (APartActor* Neighbor : Neighbors)
+			{
+				const int32 NeighborNode = FindNode(Neighbor);
+				if (NeighborNode == INDEX_NONE)
+				{
+					continue;
+				}
+				if (VisitStamp[NeighborNode] == SearchStamp)
+				{
+					if (VisitSide[NeighborNode] != Side)
+					{
+						// Still connected another way
+						return;
+					}
+					continue;
+				}
+				VisitStamp[NeighborNode] = SearchStamp;
+				VisitSide[NeighborNode] = static_cast<uint8>(Side);
+				Queues[Side].Add(NeighborNode);
+			}
+		}
+	}
+
+	// The exhausted search holds the whole split-off side; relabel the old component
+	TArray<int32, TMemStackAllocator<>> Remaining;
+	int32 Node = NodeA;
+	do
+	{
+		if (VisitStamp[Node] != SearchStamp || VisitSide[Node] != SplitSide)
+		{
+			Remaining.Add(Node);
+		}
+		Node = Next[Node];
+	}
+	while (Node != NodeA);
+
+	MakeSet(Queues[SplitSide]);
+	MakeSet(Remaining);
+	++NumSets;
+}
+
+int32 FSubAssemblyTracker::GetComponentId(const APartActor* Part) const
+{
+	const int32 Node = FindNode(Part);
+	return Node != INDEX_NONE ? FindRoot(Node) : INDEX_NONE;
+}
+
+bool FSubAssemblyTracker::IsGrounded(const APartActor* Part) const
+{
+	const int32 Node = FindNode(Part);
+	return Node != INDEX_NONE && FindRoot(Node) == FindRoot(GroundNode);
+}
+
+bool FSubAssemblyTracker::AreConnected(const APartActor* PartA, const APartActor* PartB) const
+{
+	const int32 NodeA = FindNode(PartA);
+	const int32 NodeB = FindNode(PartB);
+	return NodeA != INDEX_NONE && NodeB != INDEX_NONE && FindRoot(NodeA) == FindRoot(NodeB);
+}
+
+int32 FSubAssemblyTracker::GetComponentSize(const APartActor* Part) const
+{
+	const int32 Node = FindNode(Part);
+	if (Node == INDEX_NONE)
+	{
+		return 0;
+	}
+	const int32 Root = FindRoot(Node);
+	// The base node is not a part
+	return Root == FindRoot(GroundNode) ? Size[Root] - 1 : Size[Root];
+}
+
+void FSubAssemblyTracker::GetComponentMembers(const APartActor* Part, TArray<APartActor*>& OutMembers) const
+{
+	OutMembers.Reset();
+	const int32 Start = FindNode(Part);
+	if (Start == INDEX_NONE)
+	{
+		return;
+	}
+
+	OutMembers.Reserve(Size[FindRoot(Start)]);
+	int32 Node = Start;
+	do
+	{
+		if (NodeParts[Node])
+		{
+			OutMembers.Add(NodeParts[Node]);
+		}
+		Node = Next[Node];
+	}
+	while (Node != Start);
+}
+
+int32 FSubAssemblyTracker::GetNumComponents() const
+{
+	// A base with nothing on it is not a sub-assembly
+	return Size[FindRoot(GroundNode)] == 1 ? NumSets - 1 : NumSets;
+}
+
+int32 FSubAssemblyTracker::FindNode(const APartActor* Part) const
+{
+	if (!Part)
+	{
+		return GroundNode;
+	}
+	const int32* Node = PartNodes.Find(Part);
+	return Node ? *Node : INDEX_NONE;
+}
+
+int32 FSubAssemblyTracker::FindOrAddNode(APartActor* Part)
+{
+	const int32 Existing = FindNode(Part);
+	if (Existing != INDEX_NONE)
+	{
+		return Existing;
+	}
+
+	int32 Node;
+	if (FreeNodes.Num() > 0)
+	{
+		Node = FreeNodes.Pop(EAllowShrinking::No);
+	}
+	else
+	{
+		Node = NodeParts.AddDefaulted();
+		Parent.AddDefaulted();
+		Size.AddDefaulted();
+		Next.AddDefaulted();
+		VisitStamp.AddZeroed();
+		VisitSide.AddZeroed();
+	}
+
+	NodeParts[Node] = Part;
+	Parent[Node] = Node;
+	Size[Node] = 1;
+	Next[Node] = Node;
+	PartNodes.Add(Part, Node);
+	++NumSets;
+	return Node;
+}
+
+int32 FSubAssemblyTracker::FindRoot(int32 Node) const
+{
+	// Path halving
+	while (Parent[Node] != Node)
+	{
+		Parent[Node] = Parent[Parent[Node]];
+		Node = Parent[Node];
+	}
+	return Node;
+}
+
+void FSubAssemblyTracker::Union(int32 NodeA, int32 NodeB)
+{
+	int32 RootA = FindRoot(NodeA);
+	int32 RootB = FindRoot(NodeB);
+	if (RootA == RootB)
+	{
+		return;
+	}
+
+	if (Size[RootA] < Size[RootB])
+	{
+		Swap(RootA, RootB);
+	}
+	Parent[RootB] = RootA;
+	Size[RootA] += Size[RootB];
+
+	// Swapping one successor from each circular list joins them into one
+	Swap(Next[NodeA], Next[NodeB]);
+	--NumSets;
+}
+
+void FSubAssemblyTracker::MakeSet(TConstArrayView<int32> Nodes)
+{
+	if (Nodes.Num() == 0)
+	{
+		return;
+	}
+
+	const int32 Root = Nodes[0];
+	for (int32 Index = 0; Index < Nodes.Num(); ++Index)
+	{
+		Parent[Nodes[Index]] = Root;
+		Next[Nodes[Index]] = Nodes[(Index + 1) % Nodes.Num()];
+	}
+	Size[Root] = Nodes.Num();
+}
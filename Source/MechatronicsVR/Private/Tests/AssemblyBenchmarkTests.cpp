@@ -0,0 +1,116 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AssemblyBenchmark.h"
+#include "AssemblyActor.h"
+#include "AssemblyAllocationCounter.h"
+#include "AssemblyTestHelpers.h"
+#include "Algo/Find.h"
+#include "Misc/AutomationTest.h"
+#include "Misc/CommandLine.h"
+#include "Misc/Parse.h"
+#include "Misc/Paths.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace AssemblyBenchmarkTests
+{
+	struct FScenario
+	{
+		const TCHAR* Name;
+		const TCHAR* Args;
+	};
+
+	/** Each runs the whole benchmark once; Args are the Assembly.Benchmark console arguments */
+	static const FScenario Scenarios[] =
+	{
+		{ TEXT("Small"), TEXT("Parts=50 SnapPoints=4 Iterations=200") },
+		{ TEXT("Default"), TEXT("Parts=200 SnapPoints=6 Iterations=1000") },
+		{ TEXT("Dense"), TEXT("Parts=200 SnapPoints=12 Iterations=1000 Spacing=10") },
+		{ TEXT("Large"), TEXT("Parts=1000 SnapPoints=6 Iterations=1000") },
+	};
+}
+
+IMPLEMENT_COMPLEX_AUTOMATION_TEST(FAssemblyBenchmarkTest, "Assembly.Benchmark",
+	EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+void FAssemblyBenchmarkTest::GetTests(TArray<FString>& OutBeautifiedNames, TArray<FString>& OutTestCommands) const
+{
+	for (const AssemblyBenchmarkTests::FScenario& Scenario : AssemblyBenchmarkTests::Scenarios)
+	{
+		OutBeautifiedNames.Add(Scenario.Name);
+		OutTestCommands.Add(Scenario.Args);
+	}
+}
+
+bool FAssemblyBenchmarkTest::RunTest(const FString& Parameters)
+{
+	UWorld* World = AssemblyTests::FindGameWorld();
+	if (!TestNotNull(TEXT("Game world (run with -game)"), World))
+	{
+		return false;
+	}
+
+	TArray<FString> Args;
+	Parameters.ParseIntoArrayWS(Args);
+	FAssemblyBenchmarkConfig Config;
+	Config.ParseArgs(Args);
+
+	FAssemblyBenchmark Benchmark(World, Config);
+	if (!TestTrue(TEXT("Benchmark setup spawned"), Benchmark.Run()))
+	{
+		return false;
+	}
+
+	const FAssemblyBenchmarkCheckpoints& Checkpoints = Benchmark.GetCheckpoints();
+	const int32 NumLinks = Config.NumParts - 1;
+	TestEqual(TEXT("Parts spawned"), Checkpoints.NumParts, Config.NumParts);
+
+	TestEqual(TEXT("Connections after connecting the chain"), Checkpoints.ConnectionsAfterConnect, NumLinks);
+	TestEqual(TEXT("Sub-assemblies after connecting the chain"), Checkpoints.SubAssembliesAfterConnect, 1);
+	TestTrue(TEXT("Solved after connecting the chain"), Checkpoints.StateAfterConnect == EAssemblyState::FullyAssembled);
+
+	TestEqual(TEXT("Connections after disconnecting every link"), Checkpoints.ConnectionsAfterDisconnect, 0);
+	TestEqual(TEXT("Sub-assemblies after disconnecting every link"), Checkpoints.SubAssembliesAfterDisconnect, Config.NumParts);
+	TestTrue(TEXT("Not solved after disconnecting every link"), Checkpoints.StateAfterDisconnect == EAssemblyState::PartiallyAssembled);
+
+	TestEqual(TEXT("Parts after removing every part"), Checkpoints.PartsAfterRemove, 0);
+	TestTrue(TEXT("Empty after removing every part"), Checkpoints.StateAfterRemove == EAssemblyState::Empty);
+
+	TestEqual(TEXT("Measured cases"), Benchmark.GetResults().Num(), 7);
+	for (const FAssemblyBenchmarkResult& Result : Benchmark.GetResults())
+	{
+		TestTrue(FString::Printf(TEXT("%s took samples"), *Result.Name), Result.Samples > 0);
+	}
+
+	// Once warm, holding a part and snapping it must not touch the heap
+	const FAssemblyBenchmarkResult* Cycle = Benchmark.GetResults().FindByPredicate(
+		[](const FAssemblyBenchmarkResult& Result) { return Result.Name == TEXT("GrabPreviewSnap"); });
+	if (TestNotNull(TEXT("Grab, preview and snap cycle measured"), Cycle))
+	{
+		// A sample that finds no target returns early, so zero allocations only counts if every sample snapped
+		TestEqual(TEXT("Grab, preview and snap samples that snapped"), Checkpoints.SnapCycleSnaps, Config.Iterations);
+
+		if (FParse::Param(FCommandLine::Get(), TEXT("AssemblyAllocCounter")))
+		{
+			if (TestTrue(TEXT("Allocation counter installed for -AssemblyAllocCounter"), FAssemblyAllocationCounter::IsEnabled()))
+			{
+				TestEqual(TEXT("Heap allocations in the grab, preview and snap cycle"), Cycle->Allocations, static_cast<int64>(0));
+			}
+		}
+		else
+		{
+			AddInfo(TEXT("Run with -AssemblyAllocCounter to check that the grab, preview and snap cycle does not allocate"));
+		}
+	}
+
+	// One file per scenario, so runs that start within the same second do not overwrite each other
+	const AssemblyBenchmarkTests::FScenario* Scenario = Algo::FindByPredicate(AssemblyBenchmarkTests::Scenarios,
+		[&Parameters](const AssemblyBenchmarkTests::FScenario& Candidate) { return Parameters == Candidate.Args; });
+	const FString OutputPath = FPaths::ProjectSavedDir() / TEXT("Benchmarks") / FString::Printf(TEXT("Assembly-%s-%s.json"),
+		Scenario ? Scenario->Name : TEXT("Custom"), *FDateTime::UtcNow().ToString());
+	TestTrue(TEXT("Results written as JSON"), Benchmark.WriteJson(OutputPath));
+	AddInfo(FString::Printf(TEXT("Assembly.Benchmark: wrote %s"), *OutputPath));
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
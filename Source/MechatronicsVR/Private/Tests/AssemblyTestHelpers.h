@@ -0,0 +1,32 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/Engine.h"
+#include "Engine/World.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace AssemblyTests
+{
+	/** The game world the tests spawn into; they are ClientContext only, so this is the -game world */
+	inline UWorld* FindGameWorld()
+	{
+		if (!GEngine)
+		{
+			return nullptr;
+		}
+		for (const FWorldContext& Context : GEngine->GetWorldContexts())
+		{
+			UWorld* World = Context.World();
+			if (World && World->IsGameWorld())
+			{
+				return World;
+			}
+		}
+		return nullptr;
+	}
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
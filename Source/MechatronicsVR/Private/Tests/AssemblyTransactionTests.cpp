@@ -0,0 +1,118 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#include "AssemblyTransaction.h"
+#include "AssemblyActor.h"
+#include "AssemblyComponent.h"
+#include "AssemblyTestHelpers.h"
+#include "PartActor.h"
+#include "SnapPointComponent.h"
+#include "Misc/AutomationTest.h"
+
+#if WITH_DEV_AUTOMATION_TESTS
+
+namespace AssemblyTransactionTests
+{
+	static const FName PlugID(TEXT("Test.Plug"));
+	static const FName SocketID(TEXT("Test.Socket"));
+
+	/** A non-simulating part with a plug (index 0) and a socket (index 1) */
+	static APartActor* SpawnPart(UWorld* World, AAssemblyActor* Assembly, const FVector& Location)
+	{
+		FActorSpawnParameters SpawnParams;
+		SpawnParams.ObjectFlags |= RF_Transient;
+		SpawnParams.SpawnCollisionHandlingOverride = ESpawnActorCollisionHandlingMethod::AlwaysSpawn;
+		APartActor* Part = World->SpawnActor<APartActor>(APartActor::StaticClass(), FTransform(Location), SpawnParams);
+		if (!Part)
+		{
+			return nullptr;
+		}
+		Part->Mesh->SetSimulatePhysics(false);
+		Part->SetAssemblyActor(Assembly);
+
+		for (const bool bPlug : { true, false })
+		{
+			USnapPointComponent* SnapPoint = NewObject<USnapPointComponent>(Part, NAME_None, RF_Transient);
+			SnapPoint->SnapID = bPlug ? PlugID : SocketID;
+			SnapPoint->CompatibleSnapIDs.Add(bPlug ? SocketID : PlugID);
+			SnapPoint->SetupAttachment(Part->Assembly);
+			SnapPoint->SetRelativeLocation(FVector(bPlug ? 5.0f : -5.0f, 0.0f, 0.0f));
+			Part->AddInstanceComponent(SnapPoint);
+			SnapPoint->RegisterComponent();
+		}
+		Part->Assembly->RegisterSnapPoints();
+		Assembly->AddPart(Part);
+		return Part;
+	}
+
+	static USnapPointComponent* Plug(const APartActor* Part) { return Part->GetSnapPointsView()[0]; }
+	static USnapPointComponent* Socket(const APartActor* Part) { return Part->GetSnapPointsView()[1]; }
+}
+
+IMPLEMENT_SIMPLE_AUTOMATION_TEST(FAssemblyTransactionRollbackTest, "Assembly.Transaction.RollbackOnApplyFailure",
+	EAutomationTestFlags::ClientContext | EAutomationTestFlags::ProductFilter)
+
+bool FAssemblyTransactionRollbackTest::RunTest(const FString& Parameters)
+{
+	using namespace AssemblyTransactionTests;
+
+	UWorld* World = AssemblyTests::FindGameWorld();
+	if (!TestNotNull(TEXT("Game world (run with -game)"), World))
+	{
+		return false;
+	}
+
+	FActorSpawnParameters SpawnParams;
+	SpawnParams.ObjectFlags |= RF_Transient;
+	AAssemblyActor* Assembly = World->SpawnActor<AAssemblyActor>(AAssemblyActor::StaticClass(), FTransform::Identity, SpawnParams);
+	if (!TestNotNull(TEXT("Assembly spawned"), Assembly))
+	{
+		return false;
+	}
+	TArray<APartActor*, TInlineAllocator<3>> Parts;
+	for (int32 Index = 0; Index < 3; ++Index)
+	{
+		if (APartActor* Part = SpawnPart(World, Assembly, FVector(Index * 30.0f, 0.0f, 100.0f)))
+		{
+			Parts.Add(Part);
+		}
+	}
+
+	if (TestEqual(TEXT("Parts spawned"), Parts.Num(), 3) &&
+		TestTrue(TEXT("Initial connection"), Assembly->ConnectParts(Parts[0], Parts[1], Plug(Parts[0]), Socket(Parts[1]))))
+	{
+		// Move part 1 from part 0 to part 2, then fail the last step after the first two have applied
+		AddExpectedError(TEXT("failed to apply after validating"), EAutomationExpectedErrorFlags::Contains, 1);
+		FAssemblyTransaction Transaction(*Assembly);
+		Transaction.Disconnect(Parts[0], Parts[1]);
+		Transaction.Connect(Parts[1], Parts[2], Plug(Parts[1]), Socket(Parts[2]));
+		Transaction.Connect(Parts[2], Parts[0], Plug(Parts[2]), Socket(Parts[0]));
+		Transaction.SetFailOperationForTesting(2);
+		TestFalse(TEXT("Commit reports the failure"), Transaction.Commit());
+
+		TestEqual(TEXT("Connections after the failed commit"), Assembly->Connections.Num(), 1);
+		const FPartConnection* Restored = Assembly->FindConnectionPtr(Parts[0], Parts[1]);
+		if (TestNotNull(TEXT("Part 0 and part 1 connected again"), Restored))
+		{
+			TestTrue(TEXT("Restored connection uses the original snap points"),
+				Restored->SnapPointA == Plug(Parts[0]) && Restored->SnapPointB == Socket(Parts[1]));
+		}
+		TestFalse(TEXT("Part 1 and part 2 not connected"), Assembly->ArePartsConnected(Parts[1], Parts[2]));
+		TestFalse(TEXT("Part 2 and part 0 not connected"), Assembly->ArePartsConnected(Parts[2], Parts[0]));
+
+		TestTrue(TEXT("Part 0 plug assembled"), Plug(Parts[0])->bIsAssembled);
+		TestTrue(TEXT("Part 1 socket assembled"), Socket(Parts[1])->bIsAssembled);
+		TestFalse(TEXT("Part 1 plug free"), Plug(Parts[1])->bIsAssembled);
+		TestFalse(TEXT("Part 2 socket free"), Socket(Parts[2])->bIsAssembled);
+		TestFalse(TEXT("Part 2 plug free"), Plug(Parts[2])->bIsAssembled);
+		TestFalse(TEXT("Part 0 socket free"), Socket(Parts[0])->bIsAssembled);
+	}
+
+	for (APartActor* Part : Parts)
+	{
+		Part->Destroy();
+	}
+	Assembly->Destroy();
+	return true;
+}
+
+#endif // WITH_DEV_AUTOMATION_TESTS
@@ -5,11 +5,18 @@
 #include "CoreMinimal.h"
 #include "GameFramework/Actor.h"
 #include "PhysicsEngine/PhysicsConstraintComponent.h"
+#include "AssemblyReplication.h"
+#include "LessonConnectionMatcher.h"
+#include "SnapConstraintProfile.h"
+#include "SubAssemblyTracker.h"
 #include "AssemblyActor.generated.h"
 
 class UAssemblyComponent;
 class USnapPointComponent;
 class APartActor;
+class UStaticMesh;
+class AGameModeBase;
+class APlayerController;
 
 UENUM(BlueprintType)
 enum class EAssemblyState : uint8
@@ -20,6 +27,35 @@ enum class EAssemblyState : uint8
 	
 };
 
+/**
+ * Stable reference to a connection. The generation is bumped whenever a slot is reused,
+ * so a handle to a removed connection never resolves to a newer one.
+ */
+USTRUCT(BlueprintType)
+struct FAssemblyConnectionHandle
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Part Connection")
+	int32 Index = INDEX_NONE;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Part Connection")
+	int32 Generation = 0;
+
+	bool IsValid() const { return Index != INDEX_NONE; }
+
+	bool operator==(const FAssemblyConnectionHandle& Other) const
+	{
+		return Index == Other.Index && Generation == Other.Generation;
+	}
+	bool operator!=(const FAssemblyConnectionHandle& Other) const { return !(*this == Other); }
+
+	friend uint32 GetTypeHash(const FAssemblyConnectionHandle& Handle)
+	{
+		return HashCombineFast(GetTypeHash(Handle.Index), GetTypeHash(Handle.Generation));
+	}
+};
+
 USTRUCT(BlueprintType)
 struct FPartConnection
 {
@@ -47,6 +83,14 @@ struct FPartConnection
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Part Connection")
 	bool bIsBaseConnection;
 
+	/** Fixed connection realised by welding the parts into one rigid body instead of a constraint */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Part Connection")
+	bool bIsWelded = false;
+
+	/** Handle assigned by the owning assembly */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Part Connection")
+	FAssemblyConnectionHandle Handle;
+
 	FPartConnection()
 	{
 		PartA = nullptr;
@@ -59,12 +103,67 @@ struct FPartConnection
 	}
 };
 
+/** Physics constraint pool counters */
+USTRUCT(BlueprintType)
+struct FConstraintPoolStats
+{
+	GENERATED_BODY()
+
+	/** Acquires served from the free list */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Assembly|Constraints")
+	int32 Hits = 0;
+
+	/** Acquires that had to create a component (a hitch if it happens on snap) */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Assembly|Constraints")
+	int32 Misses = 0;
+
+	/** Components created up front by PrewarmConstraintPool */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Assembly|Constraints")
+	int32 Prewarmed = 0;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Assembly|Constraints")
+	int32 Releases = 0;
+
+	/** Components currently bound to a connection */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Assembly|Constraints")
+	int32 Active = 0;
+
+	/** Components waiting in the pool */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Assembly|Constraints")
+	int32 Free = 0;
+};
+
+/** Net connection changes reported once per change batch */
+USTRUCT(BlueprintType)
+struct FAssemblyChangeSet
+{
+	GENERATED_BODY()
+
+	/** Connections that exist now and did not before the batch */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Assembly")
+	TArray<FPartConnection> Connected;
+
+	/** Connections that existed before the batch and are gone now */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Assembly")
+	TArray<FPartConnection> Disconnected;
+
+	bool IsEmpty() const { return Connected.Num() == 0 && Disconnected.Num() == 0; }
+};
+
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAssemblyStateChanged, EAssemblyState, NewState);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnPartsConnected, APartActor*, PartA, APartActor*, PartB);
 DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnPartDisconnected, APartActor*, PartA, APartActor*, PartB);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_OneParam(FOnAssemblyChanged, const FAssemblyChangeSet&, Changes);
 
 
 
+/**
+ * Owns the connection graph of one assembly.
+ *
+ * In multiplayer the server is authoritative. Connections replicate through ReplicatedConnections,
+ * a fast array of snap point pairs; clients rebuild everything else locally. Clients go through
+ * RequestConnect, which snaps immediately and asks the server, and undo the snap if it says no.
+ */
 UCLASS()
 class MECHATRONICSVR_API AAssemblyActor : public AActor
 {
@@ -78,9 +177,12 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	virtual void PostInitProperties() override;
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
 
 	/** Snap points that belong directly to the assembly (for base connections) */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Assembly")
@@ -100,7 +202,7 @@ public:
     
 	/** Get all base snap points on this assembly */
 	UFUNCTION(BlueprintCallable, Category = "Assembly")
-	TArray<USnapPointComponent*> GetBaseSnapPoints() const { return BaseSnapPoints; }
+	const TArray<USnapPointComponent*>& GetBaseSnapPoints() const { return BaseSnapPoints; }
     
 
     
@@ -114,7 +216,7 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Assembly")
 	TArray<TObjectPtr<APartActor>> Parts;
 
-	/** Current connections between parts */
+	/** Current connections between parts. Dense and unordered; go through ConnectParts/DisconnectParts to change it. */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Assembly")
 	TArray<FPartConnection> Connections;
 
@@ -122,6 +224,13 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Assembly")
 	EAssemblyState AssemblyState;
 
+	/**
+	 * Connection graph a correct assembly has. With a lesson, progress and IsFullyAssembled score
+	 * connections against it; without one they fall back to ExpectedPartCount and ExpectedConnectionCount.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Assembly|Lesson")
+	TObjectPtr<ULessonData> Lesson;
+
 	/** Expected number of parts for full assembly */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Assembly")
 	int32 ExpectedPartCount = 8;
@@ -130,6 +239,32 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Assembly")
 	int32 ExpectedConnectionCount = 7;
 
+	/** Meshes of the parts this lesson uses, streamed in before interaction is enabled (with Lesson->PartMeshes) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Assembly|Assets")
+	TArray<TSoftObjectPtr<UStaticMesh>> LessonPartMeshes;
+
+	/** Join connected parts with physics constraints. Off: parts are only attached, as before. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Assembly|Constraints")
+	bool bUsePhysicsConstraints = false;
+
+	/**
+	 * With physics constraints on, fixed connections weld the parts into one rigid body instead of
+	 * adding a locked joint. Hinge and prismatic connections stay joints, between welded groups.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Assembly|Constraints")
+	bool bWeldFixedConnections = true;
+
+	/** Create ExpectedConnectionCount constraint components at BeginPlay so snapping never allocates */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Assembly|Constraints")
+	bool bPrewarmConstraintPool = true;
+
+	/** Make sure at least Count constraint components exist, bound or free */
+	UFUNCTION(BlueprintCallable, Category = "Assembly|Constraints")
+	void PrewarmConstraintPool(int32 Count);
+
+	UFUNCTION(BlueprintCallable, Category = "Assembly|Constraints")
+	FConstraintPoolStats GetConstraintPoolStats() const;
+
 	// ================== ASSEMBLY FUNCTIONS ==================
 	/** Add a part to the assembly */
 	UFUNCTION(BlueprintCallable, Category = "Assembly")
@@ -156,6 +291,30 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Assembly")
 	float GetAssemblyProgress() const;
 
+	// ================== LESSON ==================
+
+	/** Switch lessons, rescoring the existing connections once */
+	UFUNCTION(BlueprintCallable, Category = "Assembly|Lesson")
+	void SetLesson(ULessonData* NewLesson);
+
+	/** Correct, incorrect and missing connection counts, O(1). All zero without a lesson. */
+	UFUNCTION(BlueprintCallable, Category = "Assembly|Lesson")
+	FLessonProgress GetLessonProgress() const { return LessonMatcher.GetProgress(); }
+
+	/** Does the connection fill one of the lesson's expected connections? */
+	UFUNCTION(BlueprintCallable, Category = "Assembly|Lesson")
+	bool IsConnectionCorrect(FAssemblyConnectionHandle Handle) const;
+
+	/** Connections the lesson does not ask for */
+	UFUNCTION(BlueprintCallable, Category = "Assembly|Lesson")
+	TArray<FAssemblyConnectionHandle> GetIncorrectConnections() const;
+
+	/** Expected connections not made yet, Count set to how many are missing */
+	UFUNCTION(BlueprintCallable, Category = "Assembly|Lesson")
+	TArray<FLessonConnection> GetMissingConnections() const;
+
+	const FLessonConnectionMatcher& GetLessonMatcher() const { return LessonMatcher; }
+
 	/** Update assembly state based on current connections */
 	UFUNCTION(BlueprintCallable, Category = "Assembly")
 	void UpdateAssemblyState();
@@ -175,8 +334,118 @@ public:
 	/** Get all parts connected to a specific part */
 	UFUNCTION(BlueprintCallable, Category = "Assembly")
 	TArray<APartActor*> GetConnectedParts(APartActor* Part) const;
+
+	/** Handle of the connection between two parts, invalid if none */
+	UFUNCTION(BlueprintCallable, Category = "Assembly")
+	FAssemblyConnectionHandle FindConnectionHandle(APartActor* PartA, APartActor* PartB) const;
+
+	/** Copy out the connection a handle refers to. False if the handle is stale. */
+	UFUNCTION(BlueprintCallable, Category = "Assembly")
+	bool GetConnectionByHandle(FAssemblyConnectionHandle Handle, FPartConnection& OutConnection) const;
+
+	/** Remove a connection by handle, including base connections */
+	UFUNCTION(BlueprintCallable, Category = "Assembly")
+	bool DisconnectConnection(FAssemblyConnectionHandle Handle);
+
+	/** Connection a handle refers to, nullptr if stale. Valid until the next connect or disconnect. */
+	const FPartConnection* ResolveConnection(FAssemblyConnectionHandle Handle) const;
+
+	/** Connection between two parts without copying, nullptr if none */
+	const FPartConnection* FindConnectionPtr(const APartActor* PartA, const APartActor* PartB) const;
+
+	/** Handle of the connection mating these two snap points, invalid if none */
+	FAssemblyConnectionHandle FindConnectionBySnapPoints(const USnapPointComponent* SnapPointA, const USnapPointComponent* SnapPointB) const;
+
+	/** Handles of every connection touching Part (nullptr gives the base connections), O(1) */
+	TConstArrayView<FAssemblyConnectionHandle> GetConnectionHandles(const APartActor* Part) const;
+
+	// ================== SUB-ASSEMBLIES ==================
+
+	/** Id of the group of parts connected to Part, INDEX_NONE if not in this assembly. Ids can change on connect or disconnect. */
+	UFUNCTION(BlueprintCallable, Category = "Assembly|Sub-Assemblies")
+	int32 GetSubAssemblyId(APartActor* Part) const;
+
+	/** Is Part connected to the base, directly or through other parts? */
+	UFUNCTION(BlueprintCallable, Category = "Assembly|Sub-Assemblies")
+	bool IsPartGrounded(APartActor* Part) const;
+
+	/** Are two parts connected, directly or through other parts? */
+	UFUNCTION(BlueprintCallable, Category = "Assembly|Sub-Assemblies")
+	bool AreInSameSubAssembly(APartActor* PartA, APartActor* PartB) const;
+
+	/** Every part in Part's sub-assembly, including Part */
+	UFUNCTION(BlueprintCallable, Category = "Assembly|Sub-Assemblies")
+	TArray<APartActor*> GetSubAssemblyParts(APartActor* Part) const;
+
+	/** Number of separate groups of parts */
+	UFUNCTION(BlueprintCallable, Category = "Assembly|Sub-Assemblies")
+	int32 GetNumSubAssemblies() const { return SubAssemblies.GetNumComponents(); }
+
+	const FSubAssemblyTracker& GetSubAssemblies() const { return SubAssemblies; }
+
+	/** Parts welded into the same rigid body as Part, including Part */
+	UFUNCTION(BlueprintCallable, Category = "Assembly|Sub-Assemblies")
+	TArray<APartActor*> GetWeldedParts(APartActor* Part) const;
+
+	/** Rigid bodies the assembly's parts simulate as (each weld group counts once) */
+	UFUNCTION(BlueprintCallable, Category = "Assembly|Sub-Assemblies")
+	int32 GetNumRigidBodies() const;
 	
 
+	// ================== CHANGE BATCHES ==================
+
+	/**
+	 * Start batching changes. Until the matching EndChangeBatch, connects and disconnects still apply
+	 * immediately but the assembly state is recomputed once at the end. OnPartsConnected and
+	 * OnPartDisconnected are held back and replayed in order when the batch ends, followed by one
+	 * OnAssemblyChanged with the net changes.
+	 * Batches nest; only the outermost EndChangeBatch flushes. See FAssemblyTransaction for
+	 * validating a set of changes together before applying any of them.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Assembly")
+	void BeginChangeBatch();
+
+	UFUNCTION(BlueprintCallable, Category = "Assembly")
+	void EndChangeBatch();
+
+	UFUNCTION(BlueprintCallable, Category = "Assembly")
+	bool IsInChangeBatch() const { return ChangeBatchDepth > 0; }
+
+	// ================== NETWORKING ==================
+
+	/**
+	 * Connect two snap points from gameplay code. On the server (or standalone) this is ConnectParts.
+	 * On a client the connection is made locally straight away as a prediction and sent to the server;
+	 * the server's replicated connection later confirms it, or a rejection disconnects it again.
+	 * The moved part is PartA, or PartB when PartA is the base, as in APartActor::TrySnapToPreview.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Assembly|Network")
+	bool RequestConnect(APartActor* PartA, APartActor* PartB,
+		USnapPointComponent* SnapPointA, USnapPointComponent* SnapPointB);
+
+	/**
+	 * Disconnect two parts on the server. Not predicted; the client sees it when it replicates.
+	 * APartActor::OnPartGrabbed calls this to lift a held part off its neighbours.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Assembly|Network")
+	bool RequestDisconnect(APartActor* PartA, APartActor* PartB);
+
+	/** Server: validate Requester's connect, move the mover into place and connect. Refused if another player holds either part. */
+	bool HandleConnectRequest(APartActor* PartA, APartActor* PartB,
+		USnapPointComponent* SnapPointA, USnapPointComponent* SnapPointB, const AActor* Requester);
+
+	/** Server: validate Requester's disconnect and apply it. Refused on the same grounds as HandleConnectRequest. */
+	bool HandleDisconnectRequest(APartActor* PartA, APartActor* PartB, const AActor* Requester);
+
+	/** Client: the server refused a predicted connect; undo it */
+	void HandleConnectRejected(int32 PredictionId);
+
+	/** Client: a connection arrived from the server; apply it, or adopt the matching prediction */
+	void HandleReplicatedConnectionAdded(FReplicatedPartConnection& Item);
+
+	/** Client: the server removed a connection */
+	void HandleReplicatedConnectionRemoved(const FReplicatedPartConnection& Item);
+
 	// ================== EVENTS ==================
 	UPROPERTY(BlueprintAssignable, Category = "Assembly Events")
 	FOnAssemblyStateChanged OnAssemblyStateChanged;
@@ -187,11 +456,22 @@ public:
 	UPROPERTY(BlueprintAssignable, Category = "Assembly Events")
 	FOnPartDisconnected OnPartDisconnected;
 
+	/** Fired once per change batch (a lone connect or disconnect is a batch of one) */
+	UPROPERTY(BlueprintAssignable, Category = "Assembly Events")
+	FOnAssemblyChanged OnAssemblyChanged;
+
 protected:
 	// ================== INTERNAL FUNCTIONS ==================
 	UPhysicsConstraintComponent* CreateConstraintBetweenParts(APartActor* PartA, USnapPointComponent* SnapPointA,
 															  APartActor* PadtB, USnapPointComponent* SnapPointB);
 
+	/**
+	 * Profile a pair of snap points joins with: a hinge on either side wins, then a slide, then fixed.
+	 * OutAxisSource is the snap point whose local space the profile axis is in.
+	 */
+	const FSnapConstraintProfile& ResolveConstraintProfile(const USnapPointComponent* SnapPointA, const USnapPointComponent* SnapPointB,
+		const USnapPointComponent*& OutAxisSource) const;
+
 	/** Determine constraint type between two parts */
 	void ConfigureConstraintType(UPhysicsConstraintComponent* Constraint, 
 		USnapPointComponent* SnapPointA, USnapPointComponent* SnapPointB);
@@ -201,13 +481,148 @@ protected:
 	USnapPointComponent* PartSnapPoint,
 	USnapPointComponent* BaseSnapPoint);
 
-	/** CLean up broken constraints */
+	/** CLean up broken constraints. Run by UAssemblyTickSubsystem after an invalidation, not every frame. */
 	void CleanupInvalidConstraints();
+
+	/** Ask UAssemblyTickSubsystem to run CleanupInvalidConstraints on its next tick */
+	void RequestCleanup();
+
+	/** Add to Parts and watch for the part being destroyed */
+	void TrackPart(APartActor* Part);
+
+	UFUNCTION()
+	void HandlePartDestroyed(AActor* DestroyedActor);
+
+	UFUNCTION()
+	void HandleConstraintBroken(int32 ConstraintIndex);
+
+	/** Take a registered, unbound constraint from the pool, creating one on a miss */
+	UPhysicsConstraintComponent* AcquireConstraint();
+
+	/** Break the joint and return the component to the pool */
+	void ReleaseConstraint(UPhysicsConstraintComponent* Constraint);
 	
 private:
+	friend class UAssemblyTickSubsystem;
+
+	struct FConnectionSlot
+	{
+		int32 DenseIndex = INDEX_NONE;
+		int32 Generation = 0;
+	};
+
+	/** Store a new connection, index it by both parts and return its handle */
+	FAssemblyConnectionHandle AddConnectionRecord(FPartConnection&& Connection);
+
+	/** Drop a connection record from the dense array and the adjacency lists */
+	void RemoveConnectionRecord(FAssemblyConnectionHandle Handle);
+
+	void AddAdjacency(const APartActor* Part, FAssemblyConnectionHandle Handle);
+	void RemoveAdjacency(const APartActor* Part, FAssemblyConnectionHandle Handle);
+
+	/** Server: whether Requester may change a connection of A and B; false if there is no requester or another player holds either part */
+	bool CanRequesterChange(const APartActor* PartA, const APartActor* PartB, const AActor* Requester, const TCHAR* Context) const;
+
+	/** Server: a connection of A and B changed, so they may have become loose or snapped */
+	void UpdatePartMovementReplication(APartActor* PartA, APartActor* PartB) const;
+
+	/** Place the mover with CalculateSnapTransform and connect, putting it back if the connect fails */
+	bool ApplyConnection(APartActor* PartA, APartActor* PartB,
+		USnapPointComponent* SnapPointA, USnapPointComponent* SnapPointB);
+
+
+	/** Server: mirror connection records into ReplicatedConnections */
+	bool ShouldReplicateConnections() const;
+	void AddReplicatedConnection(const FPartConnection& Connection);
+	void RemoveReplicatedConnection(FAssemblyConnectionHandle Handle);
+
+	/** Client: apply items that arrived before BeginPlay */
+	void ApplyPendingReplicatedConnections();
+
+	/** Server: give a joining player a UAssemblyNetComponent */
+	void HandlePostLogin(AGameModeBase* GameMode, APlayerController* NewPlayer);
+
+	struct FPredictedConnect
+	{
+		int32 Id = 0;
+		FAssemblyConnectionHandle Handle;
+	};
+
+	/** Disconnect a predicted connection and let its mover fall again */
+	void UndoPrediction(const FPredictedConnect& Prediction);
+
+	/** Recompute state now, or at the end of the current batch */
+	void RequestStateUpdate();
+
+	/** Send the batched state update and change set */
+	void FlushChangeBatch();
+
 	/** Internal constraint storage for cleanup */
 	UPROPERTY()
 	TArray<TObjectPtr<UPhysicsConstraintComponent>> PhysicalConstraints;
+
+	/** Unbound constraint components ready for reuse */
+	UPROPERTY()
+	TArray<TObjectPtr<UPhysicsConstraintComponent>> FreeConstraints;
+
+	UPhysicsConstraintComponent* CreatePooledConstraint();
+
+	FConstraintPoolStats ConstraintPoolStats;
+
+	/** Handle index -> position in Connections */
+	TArray<FConnectionSlot> ConnectionSlots;
+	TArray<int32> FreeConnectionSlots;
+
+	/**
+	 * Per-part connection handles, so queries cost O(degree). Base connections are under nullptr.
+	 * A part keeps its (possibly empty) list until RemovePart, so reconnecting reuses its capacity.
+	 */
+	TMap<const APartActor*, TArray<FAssemblyConnectionHandle>> PartAdjacency;
+
+	/** Connected components of the connection graph, kept in step by Add/RemoveConnectionRecord */
+	FSubAssemblyTracker SubAssemblies;
+
+	/** Scores connections against Lesson as they are added and removed */
+	FLessonConnectionMatcher LessonMatcher;
+
+	/** Connected components over welded connections only: one per rigid body */
+	FSubAssemblyTracker WeldGroups;
+
+	/** Weld every part in Part's weld group to one root body and detach anything no longer in it */
+	void RebuildWeldGroup(APartActor* Part);
+
+	int32 ChangeBatchDepth = 0;
+	bool bPendingStateUpdate = false;
+
+	/** Connections added during the batch, resolved when it ends */
+	TArray<FAssemblyConnectionHandle> PendingConnected;
+	TArray<FPartConnection> PendingDisconnected;
+
+	/** Buffer for the change set's Connected list, lent to it by each flush and taken back after */
+	TArray<FPartConnection> ChangeSetConnected;
+
+	struct FPendingPartEvent
+	{
+		APartActor* PartA = nullptr;
+		APartActor* PartB = nullptr;
+		bool bConnected = false;
+	};
+
+	/** OnPartsConnected and OnPartDisconnected calls held back until the batch ends */
+	TArray<FPendingPartEvent> PendingPartEvents;
+
+	/** Connections as replicated to clients. Written on the server only. */
+	UPROPERTY(Replicated)
+	FReplicatedConnectionArray ReplicatedConnections;
+
+	/** Server: connection handle index -> position in ReplicatedConnections.Items */
+	TArray<int32> ReplicatedItemBySlot;
+
+	/** Client: connects sent to the server and not yet confirmed or rejected */
+	TArray<FPredictedConnect> PredictedConnects;
+	int32 NextPredictionId = 0;
+
+	FDelegateHandle PostLoginHandle;
 	
 
 };
@@ -0,0 +1,42 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+/**
+ * Counts heap allocations made on the current thread while an FAssemblyAllocationScope is open.
+ *
+ * Counting wraps GMalloc in a forwarding proxy, so it is opt-in: run with -AssemblyAllocCounter
+ * (non-shipping builds only). The game module installs the proxy at startup and removes it at
+ * shutdown. Without the flag scopes report 0 and IsEnabled returns false, so callers asserting
+ * "no allocations" should check IsEnabled first.
+ */
+class MECHATRONICSVR_API FAssemblyAllocationCounter
+{
+public:
+	/** Wrap GMalloc in the counting proxy if the command line asked for it. Game thread, module startup. */
+	static void Install();
+
+	/** Put the original allocator back. Game thread, module shutdown. */
+	static void Uninstall();
+
+	static bool IsEnabled();
+
+	/** Allocations counted on this thread since startup, while any scope was open */
+	static uint64 GetThreadCount();
+};
+
+/** Opens a counting window on the current thread; nests */
+class MECHATRONICSVR_API FAssemblyAllocationScope
+{
+public:
+	FAssemblyAllocationScope();
+	~FAssemblyAllocationScope();
+
+	/** Heap allocations made on this thread since the scope opened */
+	uint64 GetNumAllocations() const;
+
+private:
+	uint64 StartCount = 0;
+};
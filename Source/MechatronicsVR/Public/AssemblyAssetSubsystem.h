@@ -0,0 +1,90 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/StreamableManager.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AssemblyAssetSubsystem.generated.h"
+
+class UMaterialInterface;
+class UHapticFeedbackEffect_Base;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnAssemblyInteractionReady);
+
+/**
+ * Resolves the interaction assets every part shares, once per level.
+ *
+ * The ghost material and the default grab haptic are configured here (DefaultGame.ini,
+ * [/Script/MechatronicsVR.AssemblyAssetSubsystem]) instead of being loaded by every part. Assemblies
+ * add the part meshes their lesson uses with RequestPreload during BeginPlay. Once the world has
+ * begun play everything is streamed in one async batch, and interaction stays disabled until it has
+ * landed (Assembly.Assets.BlockInteractionUntilLoaded). Time to interactive is measured from
+ * subsystem creation, which is when the level starts loading.
+ */
+UCLASS(Config = Game)
+class MECHATRONICSVR_API UAssemblyAssetSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Material for snap preview ghosts when a part does not set its own */
+	UPROPERTY(Config, EditAnywhere, Category = "Assets")
+	TSoftObjectPtr<UMaterialInterface> GhostPreviewMaterial = TSoftObjectPtr<UMaterialInterface>(FSoftObjectPath(TEXT("/Game/M_GhostPreview.M_GhostPreview")));
+
+	/** Haptic played on grab when the grab component does not set its own */
+	UPROPERTY(Config, EditAnywhere, Category = "Assets")
+	TSoftObjectPtr<UHapticFeedbackEffect_Base> GrabHapticEffect;
+
+	/** Ghost material, nullptr until the preload has landed or if it failed to load */
+	UFUNCTION(BlueprintCallable, Category = "Assets")
+	UMaterialInterface* GetGhostPreviewMaterial() const { return GhostPreviewMaterial.Get(); }
+
+	UFUNCTION(BlueprintCallable, Category = "Assets")
+	UHapticFeedbackEffect_Base* GetGrabHapticEffect() const { return GrabHapticEffect.Get(); }
+
+	/** Stream Assets in before interaction is enabled (called from AAssemblyActor::BeginPlay) */
+	void RequestPreload(TConstArrayView<FSoftObjectPath> Assets);
+
+	/** False while a preload is in flight and Assembly.Assets.BlockInteractionUntilLoaded is set */
+	UFUNCTION(BlueprintCallable, Category = "Assets")
+	bool IsInteractionEnabled() const;
+
+	/** Seconds from level load to the first moment interaction was enabled, negative until then */
+	UFUNCTION(BlueprintCallable, Category = "Assets")
+	float GetTimeToInteractive() const { return TimeToInteractive; }
+
+	/** Fired once, when interaction is first enabled */
+	UPROPERTY(BlueprintAssignable, Category = "Assets")
+	FOnAssemblyInteractionReady OnInteractionReady;
+
+	/** Convenience accessor, returns nullptr if the world has no subsystem */
+	static UAssemblyAssetSubsystem* Get(const UObject* WorldContextObject);
+
+private:
+	void HandleWorldBeginPlay();
+
+	/** Start one async load for everything queued so far */
+	void StartPreload();
+
+	void HandlePreloadComplete(int32 NumAssets, double PreloadStartTime);
+
+	/** Record time to interactive the first time nothing is left in flight */
+	void MarkInteractive();
+
+	FStreamableManager StreamableManager;
+
+	/** Keep the preloaded assets resident for the level */
+	TArray<TSharedPtr<FStreamableHandle>> PreloadHandles;
+
+	/** Queued until the world has begun play, so the level's requests share one batch */
+	TArray<FSoftObjectPath> PendingAssets;
+
+	int32 NumPreloadsInFlight = 0;
+	double LevelStartTime = 0.0;
+	float TimeToInteractive = -1.0f;
+	bool bHasBegunPlay = false;
+};
@@ -0,0 +1,134 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "UObject/StrongObjectPtr.h"
+
+class UWorld;
+class APartActor;
+class AAssemblyActor;
+class ULessonData;
+class USnapPointComponent;
+enum class EAssemblyState : uint8;
+
+/** Size of the synthetic setup the benchmark spawns */
+struct MECHATRONICSVR_API FAssemblyBenchmarkConfig
+{
+	int32 NumParts = 200;
+
+	/** At least 2: even snap points are plugs, odd ones sockets */
+	int32 SnapPointsPerPart = 6;
+
+	/** Samples per query case; connect, disconnect and remove take one sample per chain link */
+	int32 Iterations = 1000;
+
+	int32 Seed = 1;
+
+	/** Grid spacing between parts, cm. Small enough that neighbours are inside snap range. */
+	float Spacing = 30.0f;
+
+	/** Parse "Parts=500 SnapPoints=8 Iterations=2000 Seed=3 Spacing=20" */
+	void ParseArgs(const TArray<FString>& Args);
+};
+
+/** Latency distribution of one benchmarked call */
+struct MECHATRONICSVR_API FAssemblyBenchmarkResult
+{
+	FString Name;
+	int32 Samples = 0;
+	double TotalMs = 0.0;
+	double MeanUs = 0.0;
+	double P50Us = 0.0;
+	double P90Us = 0.0;
+	double P99Us = 0.0;
+	double MaxUs = 0.0;
+	double OpsPerSecond = 0.0;
+
+	/** Heap allocations made by the calls, -1 unless run with -AssemblyAllocCounter */
+	int64 Allocations = -1;
+};
+
+/** What the assembly looked like after each phase, so a run can be checked as well as timed */
+struct MECHATRONICSVR_API FAssemblyBenchmarkCheckpoints
+{
+	int32 NumParts = 0;
+
+	/** Timed GrabPreviewSnap samples that found a target and snapped onto it; the rest measured nothing */
+	int32 SnapCycleSnaps = INDEX_NONE;
+
+	/** After ConnectParts has linked every part into one chain */
+	int32 ConnectionsAfterConnect = INDEX_NONE;
+	int32 SubAssembliesAfterConnect = INDEX_NONE;
+	EAssemblyState StateAfterConnect = {};
+
+	/** After DisconnectParts has undone every link */
+	int32 ConnectionsAfterDisconnect = INDEX_NONE;
+	int32 SubAssembliesAfterDisconnect = INDEX_NONE;
+	EAssemblyState StateAfterDisconnect = {};
+
+	/** After RemovePart has taken every part out */
+	int32 PartsAfterRemove = INDEX_NONE;
+	EAssemblyState StateAfterRemove = {};
+};
+
+/**
+ * Headless throughput and latency benchmark for the snap and assembly pipeline.
+ *
+ * Spawns NumParts synthetic parts with SnapPointsPerPart snap points and one assembly actor whose
+ * lesson is the full chain, then times FindBestPreviewTarget, GetBestSnapPointFor, a whole
+ * preview-snap-release cycle, ConnectParts, GetConnectedParts, DisconnectParts and RemovePart call
+ * by call. The automation tests in
+ * Tests/AssemblyBenchmarkTests.cpp run it per scenario and check its checkpoints:
+ *
+ *   UnrealEditor-Cmd MechatronicsVR.uproject <Map> -game -nullrhi -unattended
+ *       -ExecCmds="Automation RunTests Assembly; quit"
+ *
+ * "Assembly.Benchmark Parts=1000 SnapPoints=6" runs a single configuration from the console.
+ * Results are written as JSON to Saved/Benchmarks so runs can be compared between releases.
+ */
+class MECHATRONICSVR_API FAssemblyBenchmark
+{
+public:
+	FAssemblyBenchmark(UWorld* InWorld, const FAssemblyBenchmarkConfig& InConfig);
+
+	/** Destroys everything the benchmark spawned */
+	~FAssemblyBenchmark();
+
+	/** Spawn the setup and run every case. False if the world cannot spawn actors. */
+	bool Run();
+
+	const TArray<FAssemblyBenchmarkResult>& GetResults() const { return Results; }
+
+	const FAssemblyBenchmarkCheckpoints& GetCheckpoints() const { return Checkpoints; }
+
+	FString ToJson() const;
+
+	/** Write ToJson to Path, or to Saved/Benchmarks/Assembly-<timestamp>.json if Path is empty */
+	bool WriteJson(const FString& Path, FString* OutWrittenPath = nullptr) const;
+
+private:
+	bool SpawnSetup();
+	void DestroySetup();
+
+	/** Link part I's first plug to part I+1's first socket, for every part in order */
+	void ConnectChain();
+
+	/** Time Func(SampleIndex) once per sample and record the distribution under Name */
+	template <typename FuncType>
+	void Measure(const TCHAR* Name, int32 NumSamples, FuncType&& Func);
+
+	UWorld* World = nullptr;
+	FAssemblyBenchmarkConfig Config;
+	FRandomStream Random;
+
+	TWeakObjectPtr<AAssemblyActor> Assembly;
+	TArray<TWeakObjectPtr<APartActor>> Parts;
+
+	/** Expects every chain link, so a connected chain is a solved assembly */
+	TStrongObjectPtr<ULessonData> Lesson;
+
+	TArray<FAssemblyBenchmarkResult> Results;
+	FAssemblyBenchmarkCheckpoints Checkpoints;
+	FDateTime StartTime;
+};
@@ -7,6 +7,7 @@
 #include "AssemblyComponent.generated.h"
 
 class USnapPointComponent;
+
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class MECHATRONICSVR_API UAssemblyComponent : public USceneComponent
 {
@@ -20,14 +21,21 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category="Assembly")
 	TArray<TObjectPtr<USnapPointComponent>> SnapPoints;
 
-	/** Refresh SnapPoints list by scanning children */
+	/** Refresh SnapPoints list by scanning children, baking each snap point's actor-relative transform */
 	UFUNCTION(BlueprintCallable, Category = "Assembly")
 	void RegisterSnapPoints();
 
-	/** Return all snap points on this part */
+	/** Re-bake every snap point's actor-relative transform after moving them on the part at runtime */
+	UFUNCTION(BlueprintCallable, Category = "Assembly")
+	void RefreshSnapTransforms();
+
+	/** Return all snap points on this part. Copies; C++ should use GetSnapPointsView. */
 	UFUNCTION(BlueprintCallable, Category = "Assembly")
 	TArray<USnapPointComponent*> GetSnapPoints() const;
 
+	/** Non-owning view of the snap points; nulls are filtered out by RegisterSnapPoints */
+	TConstArrayView<TObjectPtr<USnapPointComponent>> GetSnapPointsView() const { return SnapPoints; }
+
 	//snap point debug
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category="Assembly|Debug")
 	bool bShowSnapPointDebug = false;
@@ -0,0 +1,66 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "HeldPartNetComponent.h"
+#include "AssemblyNetComponent.generated.h"
+
+class AAssemblyActor;
+class APartActor;
+class APlayerController;
+class USnapPointComponent;
+
+/**
+ * Carries a player's assembly requests to the server.
+ *
+ * Parts and assemblies are owned by the server, so a client cannot call server RPCs on them. The
+ * assembly adds one of these to every player controller on the server and it replicates to the
+ * owning client, which sends its connect and disconnect requests through it. The server answers a
+ * connect by replicating the connection, or with ClientRejectConnect so the client can undo its
+ * prediction. Held-part samples (see UHeldPartNetComponent) travel through it the same way, and a
+ * grab of a part someone else already holds is answered with ClientRejectHold.
+ */
+UCLASS(ClassGroup=(Custom))
+class MECHATRONICSVR_API UAssemblyNetComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UAssemblyNetComponent();
+
+	/** Component on the first local player controller, nullptr if it has not replicated yet */
+	static UAssemblyNetComponent* FindLocal(const UObject* WorldContextObject);
+
+	/** Server only: the controller's component, added if missing */
+	static UAssemblyNetComponent* FindOrAdd(APlayerController* PlayerController);
+
+	/** Connect two snap points on the server; see AAssemblyActor::RequestConnect */
+	UFUNCTION(Server, Reliable)
+	void ServerRequestConnect(AAssemblyActor* Assembly, APartActor* PartA, APartActor* PartB,
+		USnapPointComponent* SnapPointA, USnapPointComponent* SnapPointB, int32 PredictionId);
+
+	UFUNCTION(Server, Reliable)
+	void ServerRequestDisconnect(AAssemblyActor* Assembly, APartActor* PartA, APartActor* PartB);
+
+	/** This player grabbed Part */
+	UFUNCTION(Server, Reliable)
+	void ServerBeginHeldPart(APartActor* Part);
+
+	/** Latest pose of a part this player holds; a lost one is superseded by the next */
+	UFUNCTION(Server, Unreliable)
+	void ServerUpdateHeldPart(APartActor* Part, FHeldPartSample Sample);
+
+	/** This player let go of Part at FinalSample */
+	UFUNCTION(Server, Reliable)
+	void ServerEndHeldPart(APartActor* Part, FHeldPartSample FinalSample);
+
+	/** The server refused a predicted connect */
+	UFUNCTION(Client, Reliable)
+	void ClientRejectConnect(AAssemblyActor* Assembly, int32 PredictionId);
+
+	/** The server refused a grab because another player already holds Part */
+	UFUNCTION(Client, Reliable)
+	void ClientRejectHold(APartActor* Part);
+};
@@ -0,0 +1,71 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AssemblyNetTestSubsystem.generated.h"
+
+class APartActor;
+
+/**
+ * Turns a lesson level into a multi-client replication test. Only exists when the server is started
+ * with -AssemblyNetTest, so normal play and PIE sessions are untouched.
+ *
+ * Before any player spawns, the server adds NumPlayerStarts player starts on a ring facing its centre.
+ * In front of each start it places a part to pick up, so every player has one to hold (held-part
+ * samples), and it drops a stack of parts in the middle that tumble and can be knocked over (loose
+ * movement replication). Compare the two with Assembly.Net.HeldPartReplication and Assembly.Net.Stats.
+ * Settings live in DefaultGame.ini, [/Script/MechatronicsVR.AssemblyNetTestSubsystem]; launch steps
+ * are in Private/Tests/README.md.
+ */
+UCLASS(Config = Game)
+class MECHATRONICSVR_API UAssemblyNetTestSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual bool ShouldCreateSubsystem(UObject* Outer) const override;
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Parts placed for the test, cycled through in order */
+	UPROPERTY(Config, EditAnywhere, Category = "Net Test")
+	TArray<TSoftClassPtr<APartActor>> PartClasses = {
+		TSoftClassPtr<APartActor>(FSoftObjectPath(TEXT("/Game/Bllueprint/PartActors/BP_DCTopShell.BP_DCTopShell_C"))),
+		TSoftClassPtr<APartActor>(FSoftObjectPath(TEXT("/Game/Bllueprint/PartActors/BP_DCBottomShell.BP_DCBottomShell_C")))
+	};
+
+	UPROPERTY(Config, EditAnywhere, Category = "Net Test")
+	FVector Center = FVector(0.0f, 0.0f, 0.0f);
+
+	UPROPERTY(Config, EditAnywhere, Category = "Net Test", meta = (ClampMin = "1"))
+	int32 NumPlayerStarts = 4;
+
+	/** Distance of the player starts from Center, cm */
+	UPROPERTY(Config, EditAnywhere, Category = "Net Test")
+	float PlayerStartRadius = 250.0f;
+
+	/** How far in front of its start each player's part is placed, and how high, cm */
+	UPROPERTY(Config, EditAnywhere, Category = "Net Test")
+	float HeldPartDistance = 70.0f;
+
+	UPROPERTY(Config, EditAnywhere, Category = "Net Test")
+	float HeldPartHeight = 100.0f;
+
+	/** Parts stacked over Center and left to fall */
+	UPROPERTY(Config, EditAnywhere, Category = "Net Test", meta = (ClampMin = "0"))
+	int32 NumLooseParts = 6;
+
+	/** Vertical gap between stacked loose parts, cm */
+	UPROPERTY(Config, EditAnywhere, Category = "Net Test")
+	float LoosePartSpacing = 30.0f;
+
+private:
+	/** Runs after the level's actors are initialized and before the first player spawns */
+	void HandleActorsInitialized(const FActorsInitializedParams& Params);
+
+	APartActor* SpawnPart(int32 Index, const FTransform& Transform);
+
+	FDelegateHandle ActorsInitializedHandle;
+};
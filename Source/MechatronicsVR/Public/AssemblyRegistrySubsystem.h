@@ -0,0 +1,100 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AssemblyRegistrySubsystem.generated.h"
+
+class APartActor;
+class AAssemblyActor;
+
+/**
+ * World-level index of every part and assembly actor, keyed by class.
+ *
+ * Parts and assemblies register from BeginPlay. Parts that need another actor (PartAssembledOntoClass,
+ * AssemblyActorClass) are bound in one deferred pass once the world has begun play, so every actor
+ * placed in the level is already registered and no part scans the world. When several instances
+ * match a class the one with the lowest name wins, so the binding does not depend on load order.
+ * Each class bucket is kept sorted by name, so a lookup costs one step per registered class rather
+ * than one per actor. Parts spawned after that pass are bound as soon as they register, and an
+ * assembly spawned after it is bound to every registered part still waiting for one of its class.
+ */
+UCLASS()
+class MECHATRONICSVR_API UAssemblyRegistrySubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Initialize(FSubsystemCollectionBase& Collection) override;
+	virtual void Deinitialize() override;
+
+	/** Index a part and queue it for binding (called from APartActor::BeginPlay) */
+	void RegisterPart(APartActor* Part);
+
+	/** Drop a part from the index (called from APartActor::EndPlay) */
+	void UnregisterPart(APartActor* Part);
+
+	/** Index an assembly and bind parts still waiting for one (called from AAssemblyActor::BeginPlay) */
+	void RegisterAssembly(AAssemblyActor* Assembly);
+
+	/** Drop an assembly from the index (called from AAssemblyActor::EndPlay) */
+	void UnregisterAssembly(AAssemblyActor* Assembly);
+
+	/** Registered part of Class or a subclass with the lowest name, ignoring Ignore */
+	UFUNCTION(BlueprintCallable, Category = "Assembly")
+	APartActor* FindPart(TSubclassOf<APartActor> Class, const APartActor* Ignore = nullptr) const;
+
+	/** Registered assembly of Class or a subclass with the lowest name */
+	UFUNCTION(BlueprintCallable, Category = "Assembly")
+	AAssemblyActor* FindAssembly(TSubclassOf<AAssemblyActor> Class) const;
+
+	/** Every registered part of Class or a subclass, in no particular order */
+	void GetParts(TSubclassOf<APartActor> Class, TArray<APartActor*>& OutParts) const;
+
+	UFUNCTION(BlueprintCallable, Category = "Assembly")
+	int32 GetNumParts() const { return NumParts; }
+
+	/** True once the deferred binding pass has run */
+	bool HasResolvedBindings() const { return bHasResolvedBindings; }
+
+	/** Convenience accessor, returns nullptr if the world has no subsystem */
+	static UAssemblyRegistrySubsystem* Get(const UObject* WorldContextObject);
+
+private:
+	/** Bucket entry; the name is cached so the sort order survives the actor going stale */
+	template <typename ActorType>
+	struct TEntry
+	{
+		FName Name;
+		TWeakObjectPtr<ActorType> Actor;
+	};
+
+	template <typename ActorType>
+	using TClassIndex = TMap<const UClass*, TArray<TEntry<ActorType>>>;
+
+	/** Insert Actor into its class bucket by name; false if it was already there */
+	template <typename ActorType>
+	static bool AddToIndex(TClassIndex<ActorType>& Index, ActorType* Actor);
+
+	template <typename ActorType>
+	static bool RemoveFromIndex(TClassIndex<ActorType>& Index, ActorType* Actor);
+
+	/** Lowest named live actor of Class or a subclass other than Ignore */
+	template <typename ActorType>
+	static ActorType* FindLowestNamed(const TClassIndex<ActorType>& Index, const UClass* Class, const AActor* Ignore);
+
+	void HandleWorldBeginPlay();
+
+	/** Bind every part queued before the world began play */
+	void ResolvePendingParts();
+
+	TClassIndex<APartActor> PartsByClass;
+	TClassIndex<AAssemblyActor> AssembliesByClass;
+
+	/** Parts registered before the binding pass, in registration order */
+	TArray<TWeakObjectPtr<APartActor>> PendingParts;
+
+	int32 NumParts = 0;
+	bool bHasResolvedBindings = false;
+};
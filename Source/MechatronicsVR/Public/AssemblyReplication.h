@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Net/Serialization/FastArraySerializer.h"
+#include "AssemblyReplication.generated.h"
+
+class AAssemblyActor;
+class APartActor;
+class USnapPointComponent;
+
+/**
+ * One connection as the server sends it: the two parts and the two snap points that are mated.
+ *
+ * Only the identities travel. bIsAssembled, the connection handle, constraints and the moved part's
+ * pose are derived on the client: the mover (PartA, or PartB when PartA is the base) is placed with
+ * CalculateSnapTransform and the connection is then made locally with ConnectParts, as on the server.
+ */
+USTRUCT()
+struct FReplicatedPartConnection : public FFastArraySerializerItem
+{
+	GENERATED_BODY()
+
+	/** nullptr on the base side of a base connection */
+	UPROPERTY()
+	TObjectPtr<APartActor> PartA;
+
+	UPROPERTY()
+	TObjectPtr<APartActor> PartB;
+
+	UPROPERTY()
+	TObjectPtr<USnapPointComponent> SnapPointA;
+
+	UPROPERTY()
+	TObjectPtr<USnapPointComponent> SnapPointB;
+
+	/** Handle of the local connection this item created or adopted. Never replicated. */
+	int32 LocalHandleIndex = INDEX_NONE;
+	int32 LocalHandleGeneration = 0;
+
+	/** Arrived before its parts could be resolved; applied from PostReplicatedChange */
+	bool bPendingApply = false;
+
+	void PostReplicatedAdd(const struct FReplicatedConnectionArray& InArraySerializer);
+	void PostReplicatedChange(const struct FReplicatedConnectionArray& InArraySerializer);
+	void PreReplicatedRemove(const struct FReplicatedConnectionArray& InArraySerializer);
+
+	/** The four object references and nothing else */
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FReplicatedPartConnection> : public TStructOpsTypeTraitsBase2<FReplicatedPartConnection>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+/** The assembly's connections as a fast array, so a connect or disconnect sends only that item */
+USTRUCT()
+struct FReplicatedConnectionArray : public FFastArraySerializer
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	TArray<FReplicatedPartConnection> Items;
+
+	/** Assembly the items are applied to on clients; set by AAssemblyActor::PostInitProperties, never saved */
+	UPROPERTY(NotReplicated, Transient)
+	TObjectPtr<AAssemblyActor> Owner;
+
+	bool NetDeltaSerialize(FNetDeltaSerializeInfo& DeltaParms);
+};
+
+template<>
+struct TStructOpsTypeTraits<FReplicatedConnectionArray> : public TStructOpsTypeTraitsBase2<FReplicatedConnectionArray>
+{
+	enum
+	{
+		WithNetDeltaSerializer = true,
+	};
+};
+
+/**
+ * Bandwidth counters for assembly replication, summed over every assembly on this machine.
+ * "Assembly.Net.Stats" prints them and "Assembly.Net.ResetStats" clears them. They are also
+ * recorded as CSV stats in the Assembly category.
+ */
+namespace AssemblyNetStats
+{
+	/** A connection delta the server wrote: its size and how many connection items it carried */
+	MECHATRONICSVR_API void RecordConnectionDelta(int64 NumBits, int32 NumItems);
+
+	/** A client's connect request: predicted locally, and later rejected or not */
+	MECHATRONICSVR_API void RecordConnectRequest();
+	MECHATRONICSVR_API void RecordConnectRejected();
+
+	/** A grab the server refused because another player already held the part */
+	MECHATRONICSVR_API void RecordHoldRejected();
+
+	/**
+	 * A held-part sample sent Elapsed seconds after the previous one: its payload size, and the
+	 * payload default movement replication would have sent for the same pose at NetUpdateFrequency
+	 */
+	MECHATRONICSVR_API void RecordHeldPartSample(float Elapsed, int64 SampleBits, int64 MovementBits, float NetUpdateFrequency);
+
+	MECHATRONICSVR_API void Reset();
+}
@@ -0,0 +1,60 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "ProfilingDebugging/CpuProfilerTrace.h"
+#include "ProfilingDebugging/CsvProfiler.h"
+#include "Stats/Stats.h"
+#include "Trace/Trace.h"
+
+/**
+ * Profiling hooks for the snap and assembly pipeline.
+ *
+ * "stat Assembly" shows the cycle counters, -csvCategories=Assembly records them with the per-frame
+ * counters in CSV captures, and -trace=default,Assembly adds the Assembly channel to Insights: CPU
+ * scopes for the same functions plus an Assembly.PartEvent for every grab, release, preview, snap
+ * and disconnect.
+ */
+
+DECLARE_STATS_GROUP(TEXT("Assembly"), STATGROUP_Assembly, STATCAT_Advanced);
+
+DECLARE_CYCLE_STAT_EXTERN(TEXT("FindBestPreviewTarget"), STAT_Assembly_FindBestPreviewTarget, STATGROUP_Assembly, MECHATRONICSVR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("GetBestSnapPointFor"), STAT_Assembly_GetBestSnapPointFor, STATGROUP_Assembly, MECHATRONICSVR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("CalculateSnapTransform"), STAT_Assembly_CalculateSnapTransform, STATGROUP_Assembly, MECHATRONICSVR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("TrySnapToPreview"), STAT_Assembly_TrySnapToPreview, STATGROUP_Assembly, MECHATRONICSVR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("ConnectParts"), STAT_Assembly_ConnectParts, STATGROUP_Assembly, MECHATRONICSVR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("DisconnectParts"), STAT_Assembly_DisconnectParts, STATGROUP_Assembly, MECHATRONICSVR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("UpdateAssemblyState"), STAT_Assembly_UpdateAssemblyState, STATGROUP_Assembly, MECHATRONICSVR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SnapOverlapBegin"), STAT_Assembly_SnapOverlapBegin, STATGROUP_Assembly, MECHATRONICSVR_API);
+DECLARE_CYCLE_STAT_EXTERN(TEXT("SnapOverlapEnd"), STAT_Assembly_SnapOverlapEnd, STATGROUP_Assembly, MECHATRONICSVR_API);
+
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Held Parts"), STAT_Assembly_HeldParts, STATGROUP_Assembly, MECHATRONICSVR_API);
+DECLARE_DWORD_COUNTER_STAT_EXTERN(TEXT("Connections"), STAT_Assembly_Connections, STATGROUP_Assembly, MECHATRONICSVR_API);
+
+UE_TRACE_CHANNEL_EXTERN(AssemblyChannel, MECHATRONICSVR_API);
+
+CSV_DECLARE_CATEGORY_MODULE_EXTERN(MECHATRONICSVR_API, Assembly);
+
+/** Cycle counter, CSV timer and Insights CPU scope on the Assembly channel, all named Name */
+#define ASSEMBLY_SCOPE_CYCLE_COUNTER(Name) \
+	SCOPE_CYCLE_COUNTER(STAT_Assembly_##Name); \
+	CSV_SCOPED_TIMING_STAT(Assembly, Name); \
+	TRACE_CPUPROFILER_EVENT_SCOPE_ON_CHANNEL(Assembly_##Name, AssemblyChannel)
+
+class AActor;
+
+namespace AssemblyTrace
+{
+	enum class EPartEvent : uint8
+	{
+		Grab,
+		Release,
+		Preview,
+		Snap,
+		Disconnect
+	};
+
+	/** Emit an Assembly.PartEvent and bump the matching per-frame CSV counter. Other may be nullptr (the base). */
+	MECHATRONICSVR_API void OutputPartEvent(EPartEvent Event, const AActor* Part, const AActor* Other = nullptr);
+}
@@ -0,0 +1,141 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "AssemblyStressGenerator.generated.h"
+
+class APartActor;
+class AAssemblyActor;
+class USnapPointComponent;
+
+/** How generated parts are meant to connect */
+UENUM(BlueprintType)
+enum class EAssemblyStressTopology : uint8
+{
+	/** Every part hangs off one parent, BranchingFactor children each */
+	Tree	UMETA(DisplayName = "Tree"),
+	/** A random spanning tree plus ExtraEdgeRatio extra connections, so parts close loops */
+	Graph	UMETA(DisplayName = "Graph")
+};
+
+/** One generated connection, child plug into parent socket */
+USTRUCT()
+struct FAssemblyStressEdge
+{
+	GENERATED_BODY()
+
+	UPROPERTY(VisibleAnywhere, Category = "Stress")
+	TObjectPtr<APartActor> Parent = nullptr;
+
+	UPROPERTY(VisibleAnywhere, Category = "Stress")
+	TObjectPtr<APartActor> Child = nullptr;
+
+	UPROPERTY(VisibleAnywhere, Category = "Stress")
+	TObjectPtr<USnapPointComponent> ParentSnapPoint = nullptr;
+
+	UPROPERTY(VisibleAnywhere, Category = "Stress")
+	TObjectPtr<USnapPointComponent> ChildSnapPoint = nullptr;
+};
+
+/**
+ * Generates synthetic assemblies for scale testing.
+ *
+ * Place it in a level and press Generate to lay out NumParts parts (saved with the level), or run
+ * Assembly.GenerateStress at runtime. Each part is given a random kind, and every connection gets a
+ * SnapID / CompatibleSnapIDs pair named after the two kinds, so the compatibility table grows the
+ * way real content does. The root part is wired to the assembly's base snap point. The same Seed
+ * always produces the same assembly. With bConnectOnBeginPlay the generated connections are made
+ * once play starts, and the time spent spawning, registering and connecting is logged.
+ */
+UCLASS()
+class MECHATRONICSVR_API AAssemblyStressGenerator : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	AAssemblyStressGenerator();
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stress")
+	int32 Seed = 1;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stress", meta = (ClampMin = "1"))
+	int32 NumParts = 1000;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stress")
+	EAssemblyStressTopology Topology = EAssemblyStressTopology::Tree;
+
+	/** Children per part in a tree */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stress", meta = (ClampMin = "1", EditCondition = "Topology == EAssemblyStressTopology::Tree"))
+	int32 BranchingFactor = 3;
+
+	/** Extra connections per part on top of the spanning tree, each between two parts not already paired */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stress", meta = (ClampMin = "0", EditCondition = "Topology == EAssemblyStressTopology::Graph"))
+	float ExtraEdgeRatio = 0.2f;
+
+	/** Distinct part kinds; each pair of kinds gets its own SnapIDs */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stress", meta = (ClampMin = "1"))
+	int32 NumPartKinds = 8;
+
+	/** Part classes to spawn, picked by kind. APartActor when empty. */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stress")
+	TArray<TSubclassOf<APartActor>> PartClasses;
+
+	/** Unused snap points added to each part, so queries also see incompatible candidates */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stress", meta = (ClampMin = "0"))
+	int32 DecoySnapPointsPerPart = 2;
+
+	/** Grid spacing between generated parts, cm */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stress", meta = (ClampMin = "1"))
+	float Spacing = 40.0f;
+
+	/**
+	 * Give every generated snap point an overlap sphere (USnapPointComponent::bUseOverlapDetection),
+	 * to measure the overlap-event cost against the default USnapPointSubsystem queries
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stress")
+	bool bUseOverlapDetection = false;
+
+	/** Make the generated connections when play starts; otherwise parts are left loose to snap by hand */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Stress")
+	bool bConnectOnBeginPlay = true;
+
+	/** Clear anything generated before and lay out a new assembly */
+	UFUNCTION(CallInEditor, BlueprintCallable, Category = "Stress")
+	void Generate();
+
+	/** Destroy every generated part and the generated assembly */
+	UFUNCTION(CallInEditor, BlueprintCallable, Category = "Stress")
+	void ClearGenerated();
+
+	/** Make every generated connection in one change batch */
+	UFUNCTION(BlueprintCallable, Category = "Stress")
+	void ConnectGenerated();
+
+	UFUNCTION(BlueprintCallable, Category = "Stress")
+	AAssemblyActor* GetGeneratedAssembly() const { return Assembly; }
+
+	/** Parse "Parts=10000 Seed=7 Topology=Graph Kinds=16 Branching=3 ExtraEdges=0.2 Decoys=2 Spacing=40 Overlap=0 Connect=1" */
+	void ApplyArgs(const TArray<FString>& Args);
+
+protected:
+	virtual void BeginPlay() override;
+
+private:
+	/** New snap point on Part, kept on the generated part's snap point list */
+	USnapPointComponent* AddSnapPoint(APartActor* Part, FName SnapID, FName CompatibleSnapID, int32 SlotIndex);
+
+	UPROPERTY(VisibleAnywhere, Category = "Stress|Generated")
+	TObjectPtr<AAssemblyActor> Assembly = nullptr;
+
+	UPROPERTY(VisibleAnywhere, Category = "Stress|Generated")
+	TArray<TObjectPtr<APartActor>> GeneratedParts;
+
+	UPROPERTY(VisibleAnywhere, Category = "Stress|Generated")
+	TArray<FAssemblyStressEdge> Edges;
+
+	/** Connection from the root part to the assembly base */
+	UPROPERTY(VisibleAnywhere, Category = "Stress|Generated")
+	TObjectPtr<USnapPointComponent> RootSnapPoint = nullptr;
+};
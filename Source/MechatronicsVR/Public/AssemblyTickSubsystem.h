@@ -0,0 +1,68 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "AssemblyTickSubsystem.generated.h"
+
+class APartActor;
+class AAssemblyActor;
+class UHeldPartNetComponent;
+
+/**
+ * Owns the per-frame assembly work so parts, grab components and assemblies never tick themselves.
+ *
+ * Held parts are the only parts with per-frame work (snap preview tracking). They register here
+ * while grabbed and are ticked at Assembly.Tick.HeldPartRate. Assemblies no longer sweep their
+ * connections every frame: a destroyed part or a broken constraint marks the assembly dirty and
+ * it is cleaned up once on the next tick. Assembly.Tick.CleanupSweepInterval adds an optional
+ * periodic sweep as a safety net. Held-part replication (UHeldPartNetComponent) runs here every
+ * frame while a part is held on any machine, and applies its own send rate.
+ */
+UCLASS()
+class MECHATRONICSVR_API UAssemblyTickSubsystem : public UTickableWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+	virtual void Tick(float DeltaTime) override;
+	virtual TStatId GetStatId() const override;
+
+	/** Start ticking a part's held work (called on grab) */
+	void RegisterHeldPart(APartActor* Part);
+
+	/** Stop ticking a part (called on release and EndPlay) */
+	void UnregisterHeldPart(APartActor* Part);
+
+	/** Send or interpolate a held part's pose every frame until unregistered */
+	void RegisterHeldPartNet(UHeldPartNetComponent* Component);
+	void UnregisterHeldPartNet(UHeldPartNetComponent* Component);
+
+	/** Include an assembly in the periodic cleanup sweep */
+	void RegisterAssembly(AAssemblyActor* Assembly);
+	void UnregisterAssembly(AAssemblyActor* Assembly);
+
+	/** Something an assembly references was invalidated; clean it up on the next tick */
+	void MarkAssemblyDirty(AAssemblyActor* Assembly);
+
+	UFUNCTION(BlueprintCallable, Category = "Assembly")
+	int32 GetNumHeldParts() const { return HeldParts.Num(); }
+
+	/** Convenience accessor, returns nullptr if the world has no subsystem */
+	static UAssemblyTickSubsystem* Get(const UObject* WorldContextObject);
+
+private:
+	void TickHeldParts(float DeltaTime);
+	void TickAssemblyCleanup(float DeltaTime);
+	void TickHeldPartNet(float DeltaTime);
+
+	TArray<TWeakObjectPtr<APartActor>> HeldParts;
+	TArray<TWeakObjectPtr<UHeldPartNetComponent>> HeldPartNet;
+	TArray<TWeakObjectPtr<AAssemblyActor>> Assemblies;
+	TArray<TWeakObjectPtr<AAssemblyActor>> DirtyAssemblies;
+
+	float HeldPartAccumulator = 0.0f;
+	float CleanupSweepAccumulator = 0.0f;
+};
@@ -0,0 +1,96 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssemblyActor.h"
+
+class APartActor;
+class USnapPointComponent;
+
+/**
+ * A set of connects and disconnects that is validated as a whole before any of it is applied.
+ *
+ * Operations are queued and checked in order against the assembly as it would be after the
+ * earlier ones, so a batch may free a snap point and reuse it, or disconnect a pair it connected.
+ * If anything fails, nothing is applied. Otherwise everything is applied inside one change batch:
+ * one state update and one OnAssemblyChanged. Should an operation that validated still fail to
+ * apply, the ones before it are undone in reverse order; a connection restored that way keeps its
+ * parts and snap points but gets a new handle.
+ *
+ *	{
+ *		FAssemblyTransaction Transaction(*Assembly);
+ *		Transaction.Disconnect(Shaft, Rotor);
+ *		Transaction.Connect(Shaft, Housing, ShaftSnap, HousingSnap);
+ *	}	// commits here unless Commit or Cancel was called
+ */
+class MECHATRONICSVR_API FAssemblyTransaction
+{
+public:
+	explicit FAssemblyTransaction(AAssemblyActor& InAssembly);
+	~FAssemblyTransaction();
+
+	FAssemblyTransaction(const FAssemblyTransaction&) = delete;
+	FAssemblyTransaction& operator=(const FAssemblyTransaction&) = delete;
+
+	/** Queue AAssemblyActor::ConnectParts */
+	void Connect(APartActor* PartA, APartActor* PartB, USnapPointComponent* SnapPointA, USnapPointComponent* SnapPointB);
+
+	/** Queue AAssemblyActor::DisconnectParts */
+	void Disconnect(APartActor* PartA, APartActor* PartB);
+
+	/** Queue AAssemblyActor::DisconnectConnection */
+	void Disconnect(FAssemblyConnectionHandle Handle);
+
+	/** Validate and apply everything queued. Returns false, leaving the assembly as it was, if any operation fails. */
+	bool Commit();
+
+	/** Drop everything queued */
+	void Cancel();
+
+	int32 Num() const { return Operations.Num(); }
+
+#if WITH_DEV_AUTOMATION_TESTS
+	/** Make the operation at Index fail to apply after validation, to exercise the rollback */
+	void SetFailOperationForTesting(int32 Index) { FailOperationForTesting = Index; }
+#endif
+
+private:
+	enum class EOperation : uint8
+	{
+		Connect,
+		DisconnectParts,
+		DisconnectHandle
+	};
+
+	struct FOperation
+	{
+		EOperation Type = EOperation::Connect;
+		APartActor* PartA = nullptr;
+		APartActor* PartB = nullptr;
+		USnapPointComponent* SnapPointA = nullptr;
+		USnapPointComponent* SnapPointB = nullptr;
+		FAssemblyConnectionHandle Handle;
+	};
+
+	/** What an applied operation did, so Commit can undo it */
+	struct FApplied
+	{
+		bool bConnected = false;
+		FPartConnection Connection;
+	};
+
+	/** Check every operation against the assembly as earlier operations would leave it */
+	bool Validate() const;
+
+	/** Apply one operation, recording how to undo it in OutApplied */
+	bool Apply(const FOperation& Operation, FApplied& OutApplied);
+
+	AAssemblyActor& Assembly;
+	TArray<FOperation> Operations;
+	bool bDone = false;
+
+#if WITH_DEV_AUTOMATION_TESTS
+	int32 FailOperationForTesting = INDEX_NONE;
+#endif
+};
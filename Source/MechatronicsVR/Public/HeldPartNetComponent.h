@@ -0,0 +1,155 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Components/ActorComponent.h"
+#include "HeldPartNetComponent.generated.h"
+
+class APartActor;
+
+/**
+ * Pose of a held part relative to the actor holding it (the VR pawn that owns the motion
+ * controller). Serialized quantized: location to 1 mm, rotation to 16 bits per axis.
+ */
+USTRUCT()
+struct FHeldPartSample
+{
+	GENERATED_BODY()
+
+	UPROPERTY()
+	FVector Location = FVector::ZeroVector;
+
+	UPROPERTY()
+	FRotator Rotation = FRotator::ZeroRotator;
+
+	/** Wraps; lets the server drop samples that arrive out of order */
+	UPROPERTY()
+	uint8 Sequence = 0;
+
+	FTransform ToTransform() const { return FTransform(Rotation, Location); }
+
+	bool NetSerialize(FArchive& Ar, class UPackageMap* Map, bool& bOutSuccess);
+};
+
+template<>
+struct TStructOpsTypeTraits<FHeldPartSample> : public TStructOpsTypeTraitsBase2<FHeldPartSample>
+{
+	enum
+	{
+		WithNetSerializer = true,
+	};
+};
+
+/**
+ * Replicates a part's pose while someone holds it.
+ *
+ * The machine holding the part samples its pose relative to the holder at Assembly.Net.HeldPartRate
+ * and sends it to the server (through UAssemblyNetComponent from a client). The server replicates
+ * the latest sample and who holds the part. Everyone else keeps the last few samples and places
+ * the part Assembly.Net.HeldPartInterpDelay behind the newest one, interpolating between samples
+ * and extrapolating for up to Assembly.Net.HeldPartMaxExtrapolation when they stop arriving.
+ * Movement replication is off while a part is held unless Assembly.Net.HeldPartReplication is 0,
+ * which sends held poses through default actor movement replication instead, for comparison; the
+ * holder ignores that replicated pose so the server's older copy never pulls the part from its hand.
+ * Assembly.Net.Stats reports both costs. Does nothing in standalone games.
+ */
+UCLASS(ClassGroup=(Custom))
+class MECHATRONICSVR_API UHeldPartNetComponent : public UActorComponent
+{
+	GENERATED_BODY()
+
+public:
+	UHeldPartNetComponent();
+
+	virtual void GetLifetimeReplicatedProps(TArray<FLifetimeProperty>& OutLifetimeProps) const override;
+
+	/** The part was grabbed on this machine; Holder owns the motion controller */
+	void BeginLocalHold(AActor* Holder);
+
+	/** The part was released on this machine. Sends the final pose. */
+	void EndLocalHold();
+
+	/** Server: Holder started holding the part. False if someone else already holds it. */
+	bool HandleHoldBegun(AActor* Holder);
+
+	/** Holder: the server gave the part to someone else first; drop it without snapping */
+	void HandleHoldRejected();
+
+	/** Server: a new sample from the holder */
+	void HandleSample(const FHeldPartSample& Sample);
+
+	/** Server: the holder let go at FinalSample */
+	void HandleHoldEnded(const FHeldPartSample& FinalSample);
+
+	/** Send (holder) or interpolate (everyone else). Run every frame by UAssemblyTickSubsystem while needed. */
+	void TickNet(float DeltaTime);
+
+	/** False when Assembly.Net.HeldPartReplication is 0 and held parts use movement replication instead */
+	static bool IsSampleReplicationEnabled();
+
+	/** Actor holding the part, nullptr when it is not held */
+	AActor* GetHeldBy() const { return HeldBy; }
+
+	bool IsLocallyHeld() const { return LocalHolder.IsValid(); }
+
+protected:
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	struct FTimedSample
+	{
+		FTransform Transform;
+		double ReceiveTime = 0.0;
+	};
+
+	static constexpr int32 MaxBufferedSamples = 4;
+
+	APartActor* GetPart() const;
+
+	FHeldPartSample MakeSample();
+	void SendSample(float Elapsed);
+
+	/** Remember a sample to interpolate towards */
+	void BufferSample(const FHeldPartSample& Sample);
+
+	/** Place the part at the interpolated or extrapolated pose for now */
+	void ApplyInterpolatedPose();
+
+	/** Remote hold started or ended on this machine */
+	void BeginRemoteHold(AActor* Holder);
+	void EndRemoteHold();
+
+	void SetTicking(bool bShouldTick);
+
+	UFUNCTION()
+	void OnRep_HeldBy();
+
+	UFUNCTION()
+	void OnRep_HeldSample();
+
+	UPROPERTY(ReplicatedUsing = OnRep_HeldBy)
+	TObjectPtr<AActor> HeldBy;
+
+	UPROPERTY(ReplicatedUsing = OnRep_HeldSample)
+	FHeldPartSample HeldSample;
+
+	/** Holder while held on this machine */
+	TWeakObjectPtr<AActor> LocalHolder;
+
+	/** Holder while held elsewhere, kept to place the final pose after HeldBy clears */
+	TWeakObjectPtr<AActor> RemoteHolder;
+
+	TArray<FTimedSample, TInlineAllocator<MaxBufferedSamples>> Samples;
+
+	/** Holder: world location at the last send, for the velocity default movement would carry */
+	FVector LastSentLocation = FVector::ZeroVector;
+	float SendAccumulator = 0.0f;
+	uint8 NextSequence = 0;
+
+	/** Server: newest sequence accepted this hold */
+	uint8 LastSequence = 0;
+	bool bHasSequence = false;
+
+	bool bIsTicking = false;
+};
@@ -0,0 +1,101 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "LessonData.h"
+
+/**
+ * Incremental scoring of an assembly's connections against a lesson's expected connection graph.
+ *
+ * Expected connections are compiled into a table keyed by their unordered SnapID pair, so a new
+ * connection is classified by looking at the few entries that share its SnapIDs and checking the
+ * part classes. Each entry fills up to its Count; further matches wait on the entry's overflow list
+ * and count as incorrect until a correct one is removed, when a waiting match is promoted: one from
+ * the same entry, or else one waiting on another entry with the same SnapIDs that also fits. Connect and
+ * disconnect are O(1) for any realistic lesson, and the counts are always current.
+ *
+ * Connections are identified by a caller-chosen id that is unique among live connections (the
+ * assembly uses its connection handle index), so lookups are array indexing.
+ */
+class MECHATRONICSVR_API FLessonConnectionMatcher
+{
+public:
+	/** Build the table for Lesson and forget every connection. Inactive when Lesson is null. */
+	void Compile(const ULessonData* Lesson);
+
+	void Reset();
+
+	bool IsActive() const { return bIsActive; }
+
+	/** Score a new connection. A null class is the assembly base. */
+	void OnConnected(int32 ConnectionId, const UClass* PartClassA, FName SnapIDA, const UClass* PartClassB, FName SnapIDB);
+
+	/** Forget a connection, promoting a waiting match if it filled an entry */
+	void OnDisconnected(int32 ConnectionId);
+
+	FLessonProgress GetProgress() const;
+
+	/** Does the connection fill an expected slot? */
+	bool IsConnectionCorrect(int32 ConnectionId) const;
+
+	/** Ids of connections that are tracked but not correct */
+	void GetIncorrectConnectionIds(TArray<int32>& OutIds) const;
+
+	/** Expected connections still short, with Count set to how many are missing */
+	void GetMissingConnections(TArray<FLessonConnection>& OutMissing) const;
+
+	/** Live connections matching Declaration, duplicates included. INDEX_NONE if the lesson does not declare it. */
+	int32 GetNumMatching(const FLessonConnection& Declaration) const;
+
+	/** Does Declaration describe a connection between these two sides, in either order? */
+	static bool Matches(const FLessonConnection& Declaration, const UClass* PartClassA, FName SnapIDA,
+		const UClass* PartClassB, FName SnapIDB);
+
+private:
+	struct FEntry
+	{
+		FLessonConnection Declaration;
+
+		/** Connections filling this entry, at most Declaration.Count */
+		TArray<int32, TInlineAllocator<2>> Matched;
+
+		/** Further matches, incorrect until a slot frees up */
+		TArray<int32> Overflow;
+	};
+
+	struct FConnectionState
+	{
+		bool bTracked = false;
+		int32 Entry = INDEX_NONE;
+		bool bOverflow = false;
+
+		/** Position in Unmatched when Entry is INDEX_NONE */
+		int32 UnmatchedIndex = INDEX_NONE;
+
+		/** The sides as connected, to re-match an overflow connection against other entries */
+		const UClass* PartClassA = nullptr;
+		const UClass* PartClassB = nullptr;
+		FName SnapIDA;
+		FName SnapIDB;
+	};
+
+	static TPair<FName, FName> MakeKey(FName SnapIDA, FName SnapIDB);
+
+	/** Entry has a free slot: fill it with a waiting match that fits it, if there is one */
+	void PromoteOverflow(int32 EntryIndex);
+
+	TArray<FEntry> Entries;
+	TMap<TPair<FName, FName>, TArray<int32, TInlineAllocator<1>>> EntriesBySnapPair;
+
+	/** Indexed by connection id */
+	TArray<FConnectionState> Connections;
+
+	/** Connections no entry describes */
+	TArray<int32> Unmatched;
+
+	int32 NumExpected = 0;
+	int32 NumCorrect = 0;
+	int32 NumOverflow = 0;
+	bool bIsActive = false;
+};
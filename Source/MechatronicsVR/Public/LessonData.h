@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "LessonData.generated.h"
+
+class APartActor;
+class UStaticMesh;
+class ULessonStep;
+
+/** One connection the lesson expects: a snap point on one part class mated to a snap point on another */
+USTRUCT(BlueprintType)
+struct FLessonConnection
+{
+	GENERATED_BODY()
+
+	/** Part class on one side (subclasses match) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Lesson")
+	TSubclassOf<APartActor> PartClassA;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Lesson")
+	FName SnapIDA;
+
+	/** Part class on the other side; leave empty for the assembly base */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Lesson")
+	TSubclassOf<APartActor> PartClassB;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Lesson")
+	FName SnapIDB;
+
+	/** How many times this connection is made (four identical screws are one entry with Count 4) */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Lesson", meta = (ClampMin = "1"))
+	int32 Count = 1;
+
+	/** Shown to the student when the connection is missing */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Lesson")
+	FText Description;
+};
+
+/** Correct, incorrect and missing connections against a lesson */
+USTRUCT(BlueprintType)
+struct FLessonProgress
+{
+	GENERATED_BODY()
+
+	/** Connections the lesson expects, Counts included */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Lesson")
+	int32 Expected = 0;
+
+	/** Connections that fill an expected slot */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Lesson")
+	int32 Correct = 0;
+
+	/** Connections the lesson does not ask for, or more of one than it asks for */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Lesson")
+	int32 Incorrect = 0;
+
+	/** Expected connections not made yet */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Lesson")
+	int32 Missing = 0;
+};
+
+/**
+ * Lesson configuration (DA_Lesson_XX): the connection graph a correct assembly has.
+ *
+ * Connections are declared by part class and SnapID pair, so any instance of the right part snapped
+ * to the right snap point counts, whichever way round it was connected.
+ */
+UCLASS(BlueprintType)
+class MECHATRONICSVR_API ULessonData : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Lesson")
+	FText Title;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Lesson")
+	TArray<FLessonConnection> ExpectedConnections;
+
+	/** Steps ALessonManager walks the student through, in order */
+	UPROPERTY(EditAnywhere, Instanced, BlueprintReadOnly, Category = "Lesson")
+	TArray<TObjectPtr<ULessonStep>> Steps;
+
+	/** Meshes of the lesson's parts, streamed in before interaction is enabled */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Lesson|Assets")
+	TArray<TSoftObjectPtr<UStaticMesh>> PartMeshes;
+
+	/** Sum of every entry's Count */
+	UFUNCTION(BlueprintCallable, Category = "Lesson")
+	int32 GetNumExpectedConnections() const;
+};
@@ -0,0 +1,114 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "GameFramework/Actor.h"
+#include "LessonStep.h"
+#include "LessonManager.generated.h"
+
+class AAssemblyActor;
+class ULessonData;
+
+DECLARE_DYNAMIC_MULTICAST_DELEGATE_TwoParams(FOnLessonStepChanged, int32, StepIndex, ULessonStep*, Step);
+DECLARE_DYNAMIC_MULTICAST_DELEGATE(FOnLessonCompleted);
+
+/**
+ * Runs a lesson's steps against one assembly.
+ *
+ * Placed once per lesson level. When play starts it compiles every step's condition into a native
+ * predicate and subscribes to the assembly's OnAssemblyChanged, which reports every connect and
+ * disconnect once per change batch, and OnAssemblyStateChanged.
+ * The current step is only evaluated when an event it declares fires, and a step that is already
+ * met when it starts completes straight away. The manager never ticks.
+ */
+UCLASS()
+class MECHATRONICSVR_API ALessonManager : public AActor
+{
+	GENERATED_BODY()
+
+public:
+	ALessonManager();
+
+	/** Assembly the lesson is built on; the first assembly in the level when unset */
+	UPROPERTY(EditInstanceOnly, BlueprintReadOnly, Category = "Lesson")
+	TObjectPtr<AAssemblyActor> AssemblyActor;
+
+	/** Lesson to run; the assembly's lesson when unset */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Lesson")
+	TObjectPtr<ULessonData> Lesson;
+
+	/** Start from the first step. Called automatically once the level has begun play. */
+	UFUNCTION(BlueprintCallable, Category = "Lesson")
+	void StartLesson();
+
+	/** Move to the next step whether or not the current one is complete */
+	UFUNCTION(BlueprintCallable, Category = "Lesson")
+	void AdvanceStep();
+
+	/** Evaluate the current step now and advance if it is complete */
+	UFUNCTION(BlueprintCallable, Category = "Lesson")
+	bool CheckStepCompletion();
+
+	UFUNCTION(BlueprintCallable, Category = "Lesson")
+	int32 GetCurrentStepIndex() const { return CurrentStep; }
+
+	UFUNCTION(BlueprintCallable, Category = "Lesson")
+	ULessonStep* GetCurrentStep() const;
+
+	UFUNCTION(BlueprintCallable, Category = "Lesson")
+	bool IsLessonComplete() const { return bLessonComplete; }
+
+	/** Condition evaluations since the lesson started, to confirm nothing is polled */
+	UFUNCTION(BlueprintCallable, Category = "Lesson")
+	int32 GetNumConditionEvaluations() const { return NumConditionEvaluations; }
+
+	UPROPERTY(BlueprintAssignable, Category = "Lesson Events")
+	FOnLessonStepChanged OnStepStarted;
+
+	UPROPERTY(BlueprintAssignable, Category = "Lesson Events")
+	FOnLessonStepChanged OnStepCompleted;
+
+	UPROPERTY(BlueprintAssignable, Category = "Lesson Events")
+	FOnLessonCompleted OnLessonCompleted;
+
+protected:
+	virtual void BeginPlay() override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
+private:
+	struct FCompiledStep
+	{
+		FLessonStepPredicate Condition;
+		ELessonStepEvent Events = ELessonStepEvent::None;
+	};
+
+	void HandleWorldBeginPlay();
+
+	void BindAssembly();
+	void UnbindAssembly();
+
+	/** Evaluate the current step if it listens for Event */
+	void HandleEvent(ELessonStepEvent Event);
+
+	/** Enter Index, completing any steps that are already met */
+	void EnterStep(int32 Index);
+
+	UFUNCTION()
+	void HandleAssemblyStateChanged(EAssemblyState NewState);
+
+	UFUNCTION()
+	void HandleAssemblyChanged(const FAssemblyChangeSet& Changes);
+
+	/** Steps of the lesson being run, kept alive while it runs */
+	UPROPERTY()
+	TArray<TObjectPtr<ULessonStep>> Steps;
+
+	TArray<FCompiledStep> CompiledSteps;
+
+	FDelegateHandle WorldBeginPlayHandle;
+
+	int32 CurrentStep = INDEX_NONE;
+	int32 NumConditionEvaluations = 0;
+	bool bLessonComplete = false;
+};
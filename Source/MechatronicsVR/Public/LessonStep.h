@@ -0,0 +1,95 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "AssemblyActor.h"
+#include "LessonData.h"
+#include "UObject/Object.h"
+#include "LessonStep.generated.h"
+
+/** Assembly events a step's completion can depend on */
+UENUM(BlueprintType, meta = (Bitflags, UseEnumValuesAsMaskValuesInEditor = "true"))
+enum class ELessonStepEvent : uint8
+{
+	None					= 0 UMETA(Hidden),
+	PartsConnected			= 1 << 0,
+	PartDisconnected		= 1 << 1,
+	AssemblyStateChanged	= 1 << 2
+};
+ENUM_CLASS_FLAGS(ELessonStepEvent);
+
+/** Step completion test, evaluated against the assembly when one of the step's events fires */
+using FLessonStepPredicate = TFunction<bool(const AAssemblyActor& Assembly)>;
+
+/**
+ * One step of a lesson (ULessonData::Steps), run by ALessonManager.
+ *
+ * A step declares the assembly events that can complete it and compiles its condition into a native
+ * predicate once, when the lesson starts. The manager only evaluates the current step, and only when
+ * one of its events fires, so nothing runs per frame.
+ */
+UCLASS(Abstract, EditInlineNew, DefaultToInstanced, BlueprintType)
+class MECHATRONICSVR_API ULessonStep : public UObject
+{
+	GENERATED_BODY()
+
+public:
+	/** Shown to the student while the step is active */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Lesson Step", meta = (MultiLine = true))
+	FText Instruction;
+
+	/** Events after which the condition is re-evaluated */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Lesson Step", meta = (Bitmask, BitmaskEnum = "/Script/MechatronicsVR.ELessonStepEvent"))
+	int32 TriggerEvents = 0;
+
+	ELessonStepEvent GetTriggerEvents() const { return static_cast<ELessonStepEvent>(TriggerEvents); }
+
+	/** Build the completion predicate. The step asset is shared, so the predicate must capture what it needs. */
+	virtual FLessonStepPredicate CompileCondition() const PURE_VIRTUAL(ULessonStep::CompileCondition, return FLessonStepPredicate(););
+};
+
+/** Complete once a connection has been made Connection.Count times */
+UCLASS(DisplayName = "Assemble Step")
+class MECHATRONICSVR_API UAssembleStep : public ULessonStep
+{
+	GENERATED_BODY()
+
+public:
+	UAssembleStep();
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Lesson Step")
+	FLessonConnection Connection;
+
+	virtual FLessonStepPredicate CompileCondition() const override;
+};
+
+/** Complete once some part of PartClass is connected to the base, directly or through other parts */
+UCLASS(DisplayName = "Ground Part Step")
+class MECHATRONICSVR_API UGroundPartStep : public ULessonStep
+{
+	GENERATED_BODY()
+
+public:
+	UGroundPartStep();
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Lesson Step")
+	TSubclassOf<APartActor> PartClass;
+
+	virtual FLessonStepPredicate CompileCondition() const override;
+};
+
+/** Complete once the assembly reaches State (FullyAssembled ends a lesson) */
+UCLASS(DisplayName = "Assembly State Step")
+class MECHATRONICSVR_API UAssemblyStateStep : public ULessonStep
+{
+	GENERATED_BODY()
+
+public:
+	UAssemblyStateStep();
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Lesson Step")
+	EAssemblyState State = EAssemblyState::FullyAssembled;
+
+	virtual FLessonStepPredicate CompileCondition() const override;
+};
@@ -7,11 +7,43 @@
 #include "PartActor.generated.h"
 
 
+/** Counters for the continuous snap preview tracking of a held part */
+USTRUCT(BlueprintType)
+struct FSnapPreviewTrackingStats
+{
+	GENERATED_BODY()
+
+	/** Times the best target was actually rescored */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Snap Preview")
+	int32 Evaluations = 0;
+
+	/** Frames skipped because the tracking rate interval had not elapsed */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Snap Preview")
+	int32 SkippedByRate = 0;
+
+	/** Evaluations skipped because the part had not moved or rotated past the thresholds */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Snap Preview")
+	int32 SkippedByCoherence = 0;
+
+	/** Evaluations deferred because the shared per-frame budget was spent */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Snap Preview")
+	int32 SkippedByBudget = 0;
+
+	/** Times the preview moved to a different target */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Snap Preview")
+	int32 TargetSwitches = 0;
+
+	/** Times hysteresis kept the current target over a marginally closer one */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Snap Preview")
+	int32 HysteresisHolds = 0;
+};
+
 class UAssemblyComponent;
 class USnapValidatorComponent;
 class USnapPointComponent;
 class AAssemblyActor;
 class UGrabComponent;
+class UAssemblyRegistrySubsystem;
 
 UCLASS()
 class MECHATRONICSVR_API APartActor : public AActor
@@ -44,6 +76,14 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Snap Preview") 
 	USnapPointComponent* FindBestPreviewTarget() const;
 
+	/** Assembly this part snaps into; bound from AssemblyActorClass once the level has begun play unless set here */
+	UFUNCTION(BlueprintCallable, Category = "Part")
+	AAssemblyActor* GetAssemblyActor() const { return AssemblyActor; }
+
+	/** Assign the assembly directly, for parts spawned at runtime */
+	UFUNCTION(BlueprintCallable, Category = "Part")
+	void SetAssemblyActor(AAssemblyActor* InAssemblyActor) { AssemblyActor = InAssemblyActor; }
+
 	// Add this property in the public section with your other components
 	/** Component that handles grab interactions */
 	/** Optional: specific snap point IDs this part prefers to connect to */
@@ -56,11 +96,7 @@ public:
 
 
 	
-	/** Preview mesh that shows where this part will snap */
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Snap Preview")
-	TObjectPtr<UStaticMeshComponent> PreviewMesh;
-
-	/** Material for preview (ghost-like appearance) */
+	/** Material for preview (ghost-like appearance); the level's shared ghost material when unset */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snap Preview")
 	TObjectPtr<UMaterialInterface> PreviewMaterial;
 
@@ -84,6 +120,29 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Snap Preview")
 	bool bShowingPreview = false;
 
+	/** Keep re-evaluating the preview target while the part is held */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snap Preview|Tracking")
+	bool bContinuousPreviewTracking = true;
+
+	/** How often the preview target may be rescored while held (Hz, 0 = every frame) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snap Preview|Tracking", meta = (ClampMin = "0.0"))
+	float PreviewTrackingRate = 30.0f;
+
+	/** Part must move this far (cm) since the last evaluation to be rescored */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snap Preview|Tracking", meta = (ClampMin = "0.0"))
+	float PreviewMoveThreshold = 0.5f;
+
+	/** ...or rotate this far (degrees) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snap Preview|Tracking", meta = (ClampMin = "0.0"))
+	float PreviewRotateThreshold = 2.0f;
+
+	/** A new target must be this much closer (cm) than the current one before the ghost jumps */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snap Preview|Tracking", meta = (ClampMin = "0.0"))
+	float PreviewHysteresisDistance = 2.0f;
+
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Snap Preview|Tracking")
+	FSnapPreviewTrackingStats PreviewTrackingStats;
+
 	UFUNCTION(BlueprintCallable, Category = "Grab State")
 	bool IsAttachedToMotionController() const;
 
@@ -99,10 +158,25 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Snap Preview")
 	void HideSnapPreview();
 
-	// /** Calculate where this part should be positioned when snapped */
+	/** Re-evaluate the preview target if the rate, motion thresholds and frame budget allow. Driven by UAssemblyTickSubsystem while held. */
+	void TickPreviewTracking(float DeltaTime);
+
+	/** Where this part should be when snapped, from cached snap point transforms (no component updates) */
 	UFUNCTION(BlueprintCallable, Category = "Snap Preview")
 	FTransform CalculateSnapTransform(USnapPointComponent* SourceSnapPoint, USnapPointComponent* TargetSnapPoint) const;
 
+	/** Stop simulating and keep query collision once snapped; simulate again when the snap is undone */
+	void SetSnappedPhysics(bool bSnapped);
+
+	/**
+	 * Server: replicate movement only while the part is loose. Held parts travel as held-part samples
+	 * and snapped ones are placed from their connections on clients. Called when a hold or connection changes.
+	 */
+	void UpdateMovementReplication();
+
+	/** Ignores the server's pose while this machine holds the part; the server only catches up with the hand */
+	virtual void OnRep_ReplicatedMovement() override;
+
 
 	/** Snap system for this part */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Part")
@@ -116,10 +190,17 @@ public:
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Part")
 	TObjectPtr<USnapValidatorComponent> SnapValidator;
 
-	/** Returns all snap points on this part */
+	/** Replicates the pose while the part is held */
+	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Part")
+	TObjectPtr<class UHeldPartNetComponent> HeldPartNet;
+
+	/** Returns all snap points on this part. Copies; C++ should use GetSnapPointsView. */
 	UFUNCTION(BlueprintCallable, Category = "Part")
 	const TArray<USnapPointComponent*> GetSnapPoints() const;
 
+	/** Non-owning view of this part's snap points */
+	TConstArrayView<TObjectPtr<USnapPointComponent>> GetSnapPointsView() const;
+
 
 
 
@@ -157,14 +238,42 @@ protected:
 	// Called when the game starts or when spawned
 	virtual void BeginPlay() override;
 
-public:	
-	// Called every frame
-	virtual void Tick(float DeltaTime) override;
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
 
 private:
+	friend class UAssemblyRegistrySubsystem;
+
+	/** Bind PartAssembledOnto and AssemblyActor from their classes (called by the registry) */
+	void ResolveRegistryBindings(const UAssemblyRegistrySubsystem& Registry);
+
+	/** Bind AssemblyActor from AssemblyActorClass if it is still unset */
+	void ResolveAssemblyBinding(const UAssemblyRegistrySubsystem& Registry);
+
+	/** Rescore the best target and move the ghost, with hysteresis */
+	void EvaluatePreviewTarget();
+
+	/** Distance between my best snap point for Target and Target, FLT_MAX if incompatible */
+	float ScorePreviewTarget(USnapPointComponent* TargetSnapPoint) const;
+
+	void ResetPreviewTracking();
+
 	UPROPERTY()
 	TObjectPtr<APartActor> PartAssembledOnto = nullptr;
 
+
+	/** My snap point the ghost is currently aligned with */
+	UPROPERTY()
+	TObjectPtr<USnapPointComponent> CurrentPreviewSourceSnapPoint = nullptr;
+
+	float PreviewTrackingAccumulator = 0.0f;
+	FVector LastPreviewTrackingLocation = FVector::ZeroVector;
+	FQuat LastPreviewTrackingRotation = FQuat::Identity;
+	bool bHasPreviewTrackingPose = false;
+
+	/** IsAttachedToMotionController result for the attach parent it was computed for */
+	mutable TWeakObjectPtr<const USceneComponent> CachedAttachParent;
+	mutable bool bCachedAttachedToMotionController = false;
+
 	UPROPERTY()
 	TObjectPtr<AAssemblyActor> AssemblyActor = nullptr;
 };
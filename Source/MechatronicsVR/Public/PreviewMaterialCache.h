@@ -0,0 +1,54 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PreviewMaterialCache.generated.h"
+
+class UMaterialInterface;
+class UMaterialInstanceDynamic;
+
+/** A cached ghost MID and the parameter values last pushed to it */
+USTRUCT()
+struct FPreviewMaterialEntry
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TObjectPtr<UMaterialInstanceDynamic> MaterialInstance = nullptr;
+
+	float AppliedOpacity = -1.0f;
+	FLinearColor AppliedColor = FLinearColor::Transparent;
+	bool bColorApplied = false;
+};
+
+/**
+ * Ghost preview MIDs keyed by the material they were created from.
+ *
+ * Each MID is created the first time a preview needs it and reused for every later preview, so
+ * grabbing a part no longer leaves garbage MIDs for the GC. Opacity and colour are only pushed
+ * when they differ from what the MID already has. Reset releases the MIDs (call it on EndPlay).
+ */
+USTRUCT()
+struct MECHATRONICSVR_API FPreviewMaterialCache
+{
+	GENERATED_BODY()
+
+	/** Ghost MID for Source, created with Outer on first use. Color is skipped when nullptr. */
+	UMaterialInstanceDynamic* GetOrCreate(UMaterialInterface* Source, UObject* Outer, float Opacity, const FLinearColor* Color);
+
+	/** Drop every cached MID */
+	void Reset();
+
+	int32 Num() const { return Entries.Num(); }
+
+	/** MIDs currently held by all preview caches */
+	static int32 GetNumLiveInstances();
+
+	/** MIDs created by all preview caches since startup */
+	static int32 GetNumCreatedInstances();
+
+private:
+	UPROPERTY(Transient)
+	TMap<TObjectPtr<UMaterialInterface>, FPreviewMaterialEntry> Entries;
+};
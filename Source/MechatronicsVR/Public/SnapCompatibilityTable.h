@@ -0,0 +1,111 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class APartActor;
+
+/**
+ * Precompiled snap compatibility relation.
+ *
+ * Every distinct (SnapID, CompatibleSnapIDs, CompatibleParts) declaration is interned to a dense
+ * profile index, and every SnapID and part class to a dense id. Compile() turns the declarations
+ * into bit rows so a bidirectional point check is a single bit test and part checks skip IsA walks.
+ * Adding a profile or class after compiling marks the table stale, and the next use compiles only the
+ * rows and columns for what was added, so a part spawned mid-game costs O(profiles), not O(profiles^2).
+ */
+class MECHATRONICSVR_API FSnapCompatibilityTable
+{
+public:
+	/** Intern a snap point declaration and return its profile index */
+	int32 AddProfile(FName SnapID, const TArray<FName>& CompatibleSnapIDs, const TArray<TSubclassOf<APartActor>>& CompatibleParts);
+
+	/** Intern a part class so CanAcceptPart lookups for it are table driven */
+	int32 AddPartClass(const UClass* PartClass);
+
+	/** Build the bit rows for everything interned since the last compile and log asymmetric or dangling declarations */
+	void Compile();
+
+	/** Compile if anything was interned since the last compile */
+	void CompileIfDirty() { if (bDirty) { Compile(); } }
+
+	/** Drop everything (world teardown) */
+	void Reset();
+
+	/** Does profile A list profile B's SnapID as compatible? */
+	bool Accepts(int32 ProfileA, int32 ProfileB);
+
+	/** Does the profile list OtherSnapID? Returns false for ids the table has never seen */
+	bool AcceptsSnapID(int32 Profile, FName OtherSnapID);
+
+	/** A accepts B and B accepts A, precomputed as one bit */
+	bool AreMutuallyCompatible(int32 ProfileA, int32 ProfileB);
+
+	/** Does the profile accept parts of this class? Unset optional means the class is not interned */
+	TOptional<bool> AcceptsPartClass(int32 Profile, const UClass* PartClass);
+
+	bool IsValidProfile(int32 Profile) const { return Profiles.IsValidIndex(Profile); }
+	int32 GetNumProfiles() const { return Profiles.Num(); }
+	int32 GetNumSnapIDs() const { return SnapIDs.Num(); }
+	int32 GetNumAsymmetricPairs() const { return NumAsymmetricPairs; }
+	int32 GetNumDanglingSnapIDs() const { return NumDanglingSnapIDs; }
+
+private:
+	struct FProfileKey
+	{
+		FName SnapID;
+		TArray<FName> CompatibleSnapIDs;
+		TArray<const UClass*> CompatibleParts;
+
+		bool operator==(const FProfileKey& Other) const
+		{
+			return SnapID == Other.SnapID && CompatibleSnapIDs == Other.CompatibleSnapIDs && CompatibleParts == Other.CompatibleParts;
+		}
+		friend uint32 GetTypeHash(const FProfileKey& Key)
+		{
+			uint32 Hash = GetTypeHash(Key.SnapID);
+			for (const FName& CompatibleSnapID : Key.CompatibleSnapIDs)
+			{
+				Hash = HashCombineFast(Hash, GetTypeHash(CompatibleSnapID));
+			}
+			for (const UClass* PartClass : Key.CompatibleParts)
+			{
+				Hash = HashCombineFast(Hash, GetTypeHash(PartClass));
+			}
+			return Hash;
+		}
+	};
+
+	struct FProfile
+	{
+		int32 SnapIDIndex = INDEX_NONE;
+		TArray<int32> CompatibleSnapIDIndices;
+		TArray<const UClass*> CompatibleParts;
+	};
+
+	int32 InternSnapID(FName SnapID);
+
+	TMap<FName, int32> SnapIDIndices;
+	TArray<FName> SnapIDs;
+	TMap<FProfileKey, int32> ProfileIndices;
+	TArray<FProfile> Profiles;
+	TMap<const UClass*, int32> PartClassIndices;
+	TArray<const UClass*> PartClasses;
+
+	/** Row per profile, bit per SnapID it accepts */
+	TArray<TBitArray<>> AcceptsSnapIDRows;
+	/** Row per profile, bit per profile it is mutually compatible with */
+	TArray<TBitArray<>> MutualRows;
+	/** Row per profile, bit per interned part class it accepts */
+	TArray<TBitArray<>> PartClassRows;
+
+	int32 NumAsymmetricPairs = 0;
+	int32 NumDanglingSnapIDs = 0;
+
+	/** Entries the bit rows already cover; anything past these is built by the next Compile */
+	int32 NumCompiledProfiles = 0;
+	int32 NumCompiledSnapIDs = 0;
+	int32 NumCompiledPartClasses = 0;
+	bool bDirty = false;
+};
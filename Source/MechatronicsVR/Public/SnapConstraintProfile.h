@@ -0,0 +1,77 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Engine/DataAsset.h"
+#include "SnapConstraintProfile.generated.h"
+
+/** How a physics connection between two parts moves */
+UENUM(BlueprintType)
+enum class EAssemblyJointType : uint8
+{
+	Fixed		UMETA(DisplayName = "Fixed"),
+	Hinge		UMETA(DisplayName = "Hinge"),
+	Prismatic	UMETA(DisplayName = "Prismatic")
+};
+
+/** Motion, limits, drive and breaking of the joint a snap point makes */
+USTRUCT(BlueprintType)
+struct MECHATRONICSVR_API FSnapConstraintProfile
+{
+	GENERATED_BODY()
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Constraint")
+	EAssemblyJointType JointType = EAssemblyJointType::Fixed;
+
+	/** Hinge rotation axis or slide direction, in the snap point's local space */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Constraint", meta = (EditCondition = "JointType != EAssemblyJointType::Fixed"))
+	FVector Axis = FVector::ForwardVector;
+
+	/** Limit the free motion instead of leaving it unbounded */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Constraint|Limits", meta = (EditCondition = "JointType != EAssemblyJointType::Fixed"))
+	bool bLimited = false;
+
+	/** Degrees either side for a hinge, cm either side for a slide */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Constraint|Limits", meta = (EditCondition = "bLimited", ClampMin = "0"))
+	float Limit = 45.0f;
+
+	/** Drive the free motion (a motor shaft, an actuator) */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Constraint|Drive", meta = (EditCondition = "JointType != EAssemblyJointType::Fixed"))
+	bool bDriven = false;
+
+	/** Revolutions per second for a hinge, cm/s for a slide */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Constraint|Drive", meta = (EditCondition = "bDriven"))
+	float DriveTargetVelocity = 0.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Constraint|Drive", meta = (EditCondition = "bDriven", ClampMin = "0"))
+	float DriveDamping = 1.0f;
+
+	/** 0 = unlimited */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Constraint|Drive", meta = (EditCondition = "bDriven", ClampMin = "0"))
+	float DriveMaxForce = 0.0f;
+
+	/** Let the joint break under load; breakable fixed joints are never welded */
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Constraint|Breaking")
+	bool bBreakable = false;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Constraint|Breaking", meta = (EditCondition = "bBreakable", ClampMin = "0"))
+	float LinearBreakThreshold = 300.0f;
+
+	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Constraint|Breaking", meta = (EditCondition = "bBreakable", ClampMin = "0"))
+	float AngularBreakThreshold = 500.0f;
+
+	/** Profile for a legacy USnapPointComponent::Metadata string ("hinge"/"rotate"/"shaft", "slide"/"prismatic") */
+	static FSnapConstraintProfile FromLegacyMetadata(const FString& Metadata);
+};
+
+/** Shared constraint profile, so every shaft socket of a kind can reference one asset */
+UCLASS(BlueprintType)
+class MECHATRONICSVR_API USnapConstraintProfileAsset : public UDataAsset
+{
+	GENERATED_BODY()
+
+public:
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Constraint", meta = (ShowOnlyInnerProperties))
+	FSnapConstraintProfile Profile;
+};
@@ -5,10 +5,14 @@
 #include "CoreMinimal.h"
 #include "Components/SceneComponent.h"
 #include "Components/SphereComponent.h"
+#include "SnapConstraintProfile.h"
 
 #include "SnapPointComponent.generated.h"
 
 class APartActor;
+class UAssemblyComponent;
+class FSnapCompatibilityTable;
+
 UCLASS( ClassGroup=(Custom), meta=(BlueprintSpawnableComponent) )
 class MECHATRONICSVR_API USnapPointComponent : public USceneComponent
 {
@@ -32,18 +36,49 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snap Point")
 	TArray<FName> CompatibleSnapIDs; // ✅ Specific and flexible
 
+	/** Prefer SetIsAssembled, which keeps the world snap index in step */
 	UPROPERTY(BlueprintReadWrite, Category = "Assembly")
 	bool bIsAssembled = false;
 
+	UFUNCTION(BlueprintCallable, Category = "Assembly")
+	void SetIsAssembled(bool bNewIsAssembled);
+
+	/**
+	 * Legacy joint declaration ("hinge", "shaft", "slide", ...). Only read when no constraint profile
+	 * is set, and then only once at registration. Use MigrateMetadataToConstraintProfile to convert.
+	 */
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snap Point")
 	FString Metadata;
 
+	/** Shared joint profile for this snap point; takes priority over the inline profile */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Snap Point|Constraint")
+	TObjectPtr<USnapConstraintProfileAsset> ConstraintProfileAsset;
+
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Snap Point|Constraint", meta = (InlineEditConditionToggle))
+	bool bUseConstraintProfile = false;
+
+	/** Joint profile for this snap point alone */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Snap Point|Constraint", meta = (EditCondition = "bUseConstraintProfile"))
+	FSnapConstraintProfile ConstraintProfile;
+
+	/** Profile in effect, resolved once at registration */
+	const FSnapConstraintProfile& GetConstraintProfile() const { return ResolvedConstraintProfile; }
+
+	/** Call after changing the constraint profile or its asset at runtime */
+	UFUNCTION(BlueprintCallable, Category = "Snap Point|Constraint")
+	void ResolveConstraintProfile();
+
+	/** Convert Metadata into the inline constraint profile (one-time migration, editor button) */
+	UFUNCTION(CallInEditor, Category = "Snap Point|Constraint")
+	void MigrateMetadataToConstraintProfile();
+
 	
 	/** Is this snap point part of the current assembly step? */
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Assembly Sequence")
 	bool bIsActiveInCurrentStep = false;
 
-	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Snap Detection")
+	/** Only created at BeginPlay when bUseOverlapDetection is set */
+	UPROPERTY(VisibleAnywhere, Transient, BlueprintReadOnly, Category = "Snap Detection")
 	TObjectPtr<USphereComponent> SnapDetectionSphere;
 	
 	UPROPERTY(VisibleAnywhere, BlueprintReadOnly, Category = "Snap Detection")
@@ -53,6 +88,14 @@ public:
 	UPROPERTY(EditAnywhere, BlueprintReadWrite, Category = "Snap Detection")
 	float SnapDetectionRadius = 5.0f; // 5cm - much more reasonable
 
+	/**
+	 * Use the physics overlap sphere to fill NearbySnapPoints.
+	 * Off by default: nearby queries go through USnapPointSubsystem instead, which keeps
+	 * hundreds of query bodies out of the broadphase. The sphere component only exists when this is set.
+	 */
+	UPROPERTY(EditAnywhere, BlueprintReadOnly, Category = "Snap Detection")
+	bool bUseOverlapDetection = false;
+
 	
 
 
@@ -64,6 +107,36 @@ public:
 	UFUNCTION(BlueprintCallable, Category = "Snap Point")
 	bool CanAcceptPoint(const USnapPointComponent* OtherSnapPoint) const;
 
+	/** Both points accept each other. One bit test once the compatibility table is compiled. */
+	UFUNCTION(BlueprintCallable, Category = "Snap Point")
+	bool CanMutuallyAccept(const USnapPointComponent* OtherSnapPoint) const;
+
+	/** Call after changing SnapID, CompatibleSnapIDs or CompatibleParts at runtime */
+	UFUNCTION(BlueprintCallable, Category = "Snap Point")
+	void RefreshCompatibility();
+
+	/** Dense profile index in the world compatibility table, INDEX_NONE until registered */
+	int32 GetCompatIndex() const { return CompatIndex; }
+
+	/** Transform relative to the owning actor, baked at BeginPlay and by UAssemblyComponent::RegisterSnapPoints */
+	const FTransform& GetActorRelativeTransform() const { return CachedActorRelativeTransform; }
+
+	/** Inverse of GetActorRelativeTransform: maps this snap point's frame back to the actor */
+	const FTransform& GetActorRelativeInverse() const { return CachedActorRelativeInverse; }
+
+	/** Has the actor-relative transform been baked yet? */
+	bool HasCachedTransform() const { return bHasCachedTransform; }
+
+	/** World transform from the cached actor-relative transform and the owner's transform */
+	FTransform GetSnapWorldTransform() const;
+
+	/**
+	 * Snap points are assumed rigid on their actor. Call this after moving one relative to its actor
+	 * at runtime, so snap math and the world snap index pick up the new placement.
+	 */
+	UFUNCTION(BlueprintCallable, Category = "Snap Point")
+	void RefreshCachedTransform();
+
 	UFUNCTION(BlueprintCallable, Category = "Snap Point")
 	void OnSnapDetectionBeginOverlap(UPrimitiveComponent* OverlappedComponent, AActor* OtherActor, 
 													 UPrimitiveComponent* OtherComp, int32 OtherBodyIndex, bool bFromSweep, const FHitResult& SweepResult);
@@ -77,12 +150,35 @@ public:
 	void CleanupNearbySnapPoints();
 
 protected:
+	virtual void OnRegister() override;
+
 	// Called when the game starts
 	virtual void BeginPlay() override;
 
+	virtual void EndPlay(const EEndPlayReason::Type EndPlayReason) override;
+
 public:	
 	// Called every frame
 	virtual void TickComponent(float DeltaTime, ELevelTick TickType, FActorComponentTickFunction* ThisTickFunction) override;
 
-		
+private:
+	friend class USnapPointSubsystem;
+	friend class UAssemblyComponent;
+
+	/** Create, register and bind the overlap sphere */
+	void CreateDetectionSphere();
+
+	/** Cache the current actor-relative transform */
+	void BakeActorRelativeTransform();
+
+	FTransform CachedActorRelativeTransform;
+	FTransform CachedActorRelativeInverse;
+	bool bHasCachedTransform = false;
+
+	/** Table this point was interned into; owned by USnapPointSubsystem */
+	FSnapCompatibilityTable* CompatibilityTable = nullptr;
+
+	int32 CompatIndex = INDEX_NONE;
+
+	FSnapConstraintProfile ResolvedConstraintProfile;
 };
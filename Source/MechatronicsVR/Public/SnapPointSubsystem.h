@@ -0,0 +1,136 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "SnapCompatibilityTable.h"
+#include "SnapPoseCache.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "UObject/ObjectKey.h"
+#include "SnapPointSubsystem.generated.h"
+
+class USnapPointComponent;
+
+/**
+ * World-level spatial index over every snap point in the level.
+ *
+ * Snap points are bucketed into a uniform hash grid. An owner is only re-hashed after its
+ * root component reports a transform change, and that work is deferred to the next query,
+ * so parts resting on the table cost nothing per frame.
+ *
+ * The subsystem also owns the compiled snap compatibility table. Every registered snap point
+ * is interned into it, and it is compiled on the first query, once the level's snap points have
+ * registered. Snap points spawned later are compiled incrementally before the next query.
+ *
+ * Candidate scoring runs over FSnapPoseCache, a packed copy of every snap point pose that is
+ * refreshed only for owners that moved. A query walks the grid cells within its radius and
+ * scores only the pose blocks of owners found there.
+ */
+UCLASS()
+class MECHATRONICSVR_API USnapPointSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	/** Add a snap point to the index (called from USnapPointComponent::BeginPlay) */
+	void RegisterSnapPoint(USnapPointComponent* SnapPoint);
+
+	/** Remove a snap point from the index (called from USnapPointComponent::EndPlay) */
+	void UnregisterSnapPoint(USnapPointComponent* SnapPoint);
+
+	/** Re-intern a snap point whose compatibility declarations changed at runtime */
+	void RefreshCompatibility(USnapPointComponent* SnapPoint);
+
+	FSnapCompatibilityTable& GetCompatibilityTable() { return CompatibilityTable; }
+
+	/** Flag every snap point owned by Owner for re-hashing before the next query */
+	void MarkOwnerDirty(const AActor* Owner);
+
+	/** Collect free snap points within Radius of Location that are compatible with Source in both directions */
+	void QueryCompatibleSnapPoints(const FVector& Location, float Radius, const USnapPointComponent* Source,
+		TArray<USnapPointComponent*>& OutSnapPoints);
+
+	/** Closest free, compatible snap point within Radius of Source (ignores Source's own actor) */
+	UFUNCTION(BlueprintCallable, Category = "Snap Detection")
+	USnapPointComponent* FindClosestCompatibleSnapPoint(const USnapPointComponent* Source, float Radius);
+
+	/** Best K free, compatible snap points within Radius of Source by distance and alignment, best first */
+	void FindBestSnapCandidates(const USnapPointComponent* Source, float Radius, int32 K, TArray<FSnapPoseCandidate>& OutBest);
+
+	/**
+	 * Best free snap point on Owner to mate with Target (nullptr if nothing fits).
+	 * Returns false if Owner or Target is not indexed yet and the caller must fall back.
+	 */
+	bool FindBestSnapPointOnOwner(const AActor* Owner, const USnapPointComponent* Target, USnapPointComponent*& OutSnapPoint);
+
+	/** Keep the cached free flag in step with USnapPointComponent::bIsAssembled */
+	void NotifySnapPointStateChanged(const USnapPointComponent* SnapPoint);
+
+	/** Change the grid cell size (cm) and rebuild the index */
+	UFUNCTION(BlueprintCallable, Category = "Snap Detection")
+	void SetCellSize(float NewCellSize);
+
+	UFUNCTION(BlueprintCallable, Category = "Snap Detection")
+	float GetCellSize() const { return CellSize; }
+
+	UFUNCTION(BlueprintCallable, Category = "Snap Detection")
+	int32 GetNumRegisteredSnapPoints() const { return SnapPointCells.Num(); }
+
+	/**
+	 * Snap preview tracking shares one wall-clock budget per frame (Assembly.PreviewFrameBudgetMs).
+	 * Returns false once this frame's budget is spent; the caller should try again next frame.
+	 */
+	bool TryBeginPreviewEvaluation();
+
+	/** Charge an evaluation started with TryBeginPreviewEvaluation against this frame's budget */
+	void EndPreviewEvaluation(double ElapsedSeconds);
+
+	/** Convenience accessor, returns nullptr if the world has no subsystem */
+	static USnapPointSubsystem* Get(const UObject* WorldContextObject);
+
+private:
+	struct FOwnerEntry
+	{
+		TArray<USnapPointComponent*> SnapPoints;
+		TWeakObjectPtr<USceneComponent> WatchedRoot;
+		FDelegateHandle TransformUpdatedHandle;
+		int32 PoseRowBegin = INDEX_NONE;
+		bool bDirty = false;
+	};
+
+	FIntVector CellFor(const FVector& Location) const;
+	void InsertIntoCell(USnapPointComponent* SnapPoint, const FIntVector& Cell);
+	void RemoveFromCell(USnapPointComponent* SnapPoint, const FIntVector& Cell);
+	void FlushDirtyOwners();
+	void RebuildIndex();
+	void EnsurePoseCacheLayout();
+	FSnapPoseQuery MakePoseQuery(const USnapPointComponent* Source, float Radius) const;
+
+	/**
+	 * Fill PoseBlockScratch with the pose blocks of owners that have a free snap point within Radius.
+	 * Returns false when the radius covers more cells than are occupied and every row should be scored.
+	 */
+	bool GatherPoseBlocks(const FVector& Location, float Radius, const AActor* IgnoreOwner);
+	void HandleOwnerTransformUpdated(USceneComponent* UpdatedComponent, EUpdateTransformFlags UpdateTransformFlags, ETeleportType Teleport);
+
+	/** Grid cell edge length (cm). Roughly the typical query radius works best. */
+	float CellSize = 50.0f;
+
+	TMap<FIntVector, TArray<USnapPointComponent*>> Cells;
+	TMap<const USnapPointComponent*, FIntVector> SnapPointCells;
+	TMap<TObjectKey<AActor>, FOwnerEntry> Owners;
+	TArray<TObjectKey<AActor>> DirtyOwners;
+
+	FSnapCompatibilityTable CompatibilityTable;
+
+	FSnapPoseCache PoseCache;
+	TMap<const USnapPointComponent*, int32> PoseRows;
+	TArray<FSnapPoseCandidate> CandidateScratch;
+	TArray<FSnapPoseBlock> PoseBlockScratch;
+	bool bPoseLayoutDirty = true;
+
+	uint64 PreviewBudgetFrame = 0;
+	double PreviewBudgetSpentSeconds = 0.0;
+};
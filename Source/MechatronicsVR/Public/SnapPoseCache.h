@@ -0,0 +1,104 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+
+class USnapPointComponent;
+class FSnapCompatibilityTable;
+
+/** What to score snap candidates against */
+struct FSnapPoseQuery
+{
+	FVector Location = FVector::ZeroVector;
+	FVector Forward = FVector::ForwardVector;
+
+	/** Candidates further than this (cm) are rejected */
+	float MaxDistance = FLT_MAX;
+
+	/** Score penalty (cm) per unit of forward misalignment, 0 = pure distance */
+	float AlignmentWeight = 0.0f;
+
+	/** Candidates owned by this actor are rejected */
+	const AActor* IgnoreOwner = nullptr;
+
+	/** Profile candidates must be mutually compatible with, INDEX_NONE skips the check */
+	int32 CompatIndex = INDEX_NONE;
+	FSnapCompatibilityTable* CompatibilityTable = nullptr;
+};
+
+struct FSnapPoseCandidate
+{
+	USnapPointComponent* SnapPoint = nullptr;
+	float Score = FLT_MAX;
+};
+
+/** A run of rows to score, as returned by FSnapPoseCache::AddBlock */
+struct FSnapPoseBlock
+{
+	int32 FirstRow = 0;
+	int32 NumRows = 0;
+};
+
+/**
+ * Structure-of-arrays cache of snap point world poses.
+ *
+ * Rows are grouped into contiguous blocks per owning actor so a single part can be scored on its
+ * own, and the arrays are padded to the SIMD width with rows that can never win. Assembled and
+ * padding rows carry an infinite penalty that the kernel adds, so only owner and compatibility
+ * checks are left for the scalar pass, and only for candidates that would make the top K.
+ */
+class MECHATRONICSVR_API FSnapPoseCache
+{
+public:
+	/** Drop all rows */
+	void Reset();
+
+	/** Append a block of rows and return the first row index */
+	int32 AddBlock(TConstArrayView<USnapPointComponent*> SnapPoints);
+
+	/** Re-read world pose and free flag for a block of rows */
+	void RefreshBlock(int32 FirstRow, int32 NumRows);
+
+	/** Update only the free flag of one row */
+	void SetRowFree(int32 Row, bool bFree);
+
+	/** Score rows [FirstRow, FirstRow + NumRows) and return the best K candidates, best first */
+	void FindBestK(const FSnapPoseQuery& Query, int32 FirstRow, int32 NumRows, int32 K, TArray<FSnapPoseCandidate>& OutBest);
+
+	/** Score several blocks and return the best K across all of them, best first */
+	void FindBestK(const FSnapPoseQuery& Query, TConstArrayView<FSnapPoseBlock> Blocks, int32 K, TArray<FSnapPoseCandidate>& OutBest);
+
+	/** Score every row */
+	void FindBestK(const FSnapPoseQuery& Query, int32 K, TArray<FSnapPoseCandidate>& OutBest)
+	{
+		FindBestK(Query, 0, NumRows, K, OutBest);
+	}
+
+	int32 Num() const { return NumRows; }
+
+private:
+	static constexpr int32 Lanes = 4;
+
+	using FAlignedFloatArray = TArray<float, TAlignedHeapAllocator<16>>;
+
+	void PadTo(int32 NewNumRows);
+
+	/** Score one block and merge its rows into the sorted top K already in OutBest */
+	void ScoreBlock(const FSnapPoseQuery& Query, int32 FirstRow, int32 NumBlockRows, int32 K, TArray<FSnapPoseCandidate>& OutBest);
+
+	FAlignedFloatArray PosX, PosY, PosZ;
+	FAlignedFloatArray FwdX, FwdY, FwdZ;
+
+	/** 0 for a free snap point, +inf for assembled or padding rows */
+	FAlignedFloatArray Penalty;
+
+	TArray<int32> CompatIndices;
+	TArray<const AActor*> Owners;
+	TArray<USnapPointComponent*> SnapPoints;
+
+	/** Per-query score scratch, kept to avoid reallocating */
+	FAlignedFloatArray Scores;
+
+	int32 NumRows = 0;
+};
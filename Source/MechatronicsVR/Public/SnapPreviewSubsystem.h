@@ -0,0 +1,94 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "PreviewMaterialCache.h"
+#include "Subsystems/WorldSubsystem.h"
+#include "SnapPreviewSubsystem.generated.h"
+
+class APartActor;
+class UStaticMeshComponent;
+class UMaterialInterface;
+
+/** One pooled ghost mesh and the part currently borrowing it */
+USTRUCT()
+struct FSnapPreviewGhost
+{
+	GENERATED_BODY()
+
+	UPROPERTY(Transient)
+	TObjectPtr<UStaticMeshComponent> Mesh = nullptr;
+
+	/** Ghost MIDs, per ghost so two visible previews never fight over parameters */
+	UPROPERTY(Transient)
+	FPreviewMaterialCache MaterialCache;
+
+	TWeakObjectPtr<APartActor> User;
+
+	/** Motion source of the hand holding User, NAME_None if it is not held */
+	FName Hand;
+
+	uint32 AcquireSerial = 0;
+};
+
+/**
+ * Owns the ghost meshes that show where a held part will snap.
+ *
+ * Only a held part previews, so at most one or two ghosts per hand are ever visible. Parts borrow
+ * a ghost while they preview and hand it back when they hide, instead of every part constructing
+ * and registering its own preview component for the life of the level. A hand that wants more than
+ * Assembly.Preview.GhostsPerHand ghosts takes back the one it borrowed longest ago.
+ */
+UCLASS()
+class MECHATRONICSVR_API USnapPreviewSubsystem : public UWorldSubsystem
+{
+	GENERATED_BODY()
+
+public:
+	virtual void Deinitialize() override;
+
+	/**
+	 * Borrow (or keep) a ghost for Part and show SourceMesh's static mesh at Transform.
+	 * OverrideMaterial replaces every slot when set, otherwise the source slot materials are ghosted.
+	 * Returns false if no ghost could be shown.
+	 */
+	bool ShowGhost(APartActor* Part, FName Hand, const UStaticMeshComponent* SourceMesh, const FTransform& Transform,
+		UMaterialInterface* OverrideMaterial, float Opacity, const FLinearColor& Color);
+
+	/** Hide Part's ghost and return it to the pool */
+	void HideGhost(APartActor* Part);
+
+	/** Ghost meshes created so far */
+	UFUNCTION(BlueprintCallable, Category = "Snap Preview")
+	int32 GetNumGhosts() const { return Ghosts.Num(); }
+
+	/** Ghost meshes currently borrowed by a part */
+	UFUNCTION(BlueprintCallable, Category = "Snap Preview")
+	int32 GetNumActiveGhosts() const;
+
+	/** Ghost MIDs alive across every ghost */
+	UFUNCTION(BlueprintCallable, Category = "Snap Preview")
+	static int32 GetNumLivePreviewMaterialInstances() { return FPreviewMaterialCache::GetNumLiveInstances(); }
+
+	/** Convenience accessor, returns nullptr if the world has no subsystem */
+	static USnapPreviewSubsystem* Get(const UObject* WorldContextObject);
+
+private:
+	/** Index of the ghost Part should use, taking one back from its hand if needed. INDEX_NONE on failure. */
+	int32 AcquireGhost(APartActor* Part, FName Hand);
+
+	int32 FindGhost(const APartActor* Part) const;
+
+	/** New hidden ghost component, owned by GhostOwner */
+	int32 CreateGhost();
+
+	/** Transient actor that owns the ghost components */
+	UPROPERTY(Transient)
+	TObjectPtr<AActor> GhostOwner = nullptr;
+
+	UPROPERTY(Transient)
+	TArray<FSnapPreviewGhost> Ghosts;
+
+	uint32 NextAcquireSerial = 0;
+};
@@ -0,0 +1,117 @@
+// Fill out your copyright notice in the Description page of Project Settings.
+
+#pragma once
+
+#include "CoreMinimal.h"
+#include "Misc/MemStack.h"
+
+class APartActor;
+
+/**
+ * Incremental connected-component tracking for an assembly's connection graph.
+ *
+ * Parts are nodes in a union-find forest, with one extra node standing in for the assembly base
+ * (a nullptr part), so "grounded" is simply "in the same set as the base". Connecting two parts is
+ * a union by size with path compression. Each set also keeps its members on a circular list that
+ * two unions splice together in O(1), so membership queries never walk the connection graph.
+ *
+ * A disconnect runs two interleaved breadth-first searches from the endpoints over the remaining
+ * connections. If they meet, nothing changes. Otherwise the search that ran out first has found
+ * the smaller side, and only the old component is relabelled.
+ */
+class MECHATRONICSVR_API FSubAssemblyTracker
+{
+public:
+	/** Neighbour scratch, carved from the game thread's FMemStack so a disconnect never hits the heap */
+	using FNeighborArray = TArray<APartActor*, TMemStackAllocator<>>;
+
+	/** Calls back with every part directly connected to Part (nullptr means the base, both ways) */
+	using FGetNeighbors = TFunctionRef<void(APartActor* Part, FNeighborArray& OutNeighbors)>;
+
+	FSubAssemblyTracker();
+
+	/** Track a part as its own sub-assembly. Connect adds parts it has not seen. */
+	void AddPart(APartActor* Part);
+
+	/** Stop tracking a part; its connections must already be gone */
+	void RemovePart(const APartActor* Part);
+
+	/** Merge the sub-assemblies of A and B (nullptr is the base) */
+	void Connect(APartActor* PartA, APartActor* PartB);
+
+	/** Split A and B apart if the removed connection was their last path. GetNeighbors must no longer report it. */
+	void Disconnect(APartActor* PartA, APartActor* PartB, FGetNeighbors GetNeighbors);
+
+	/** Drop every part */
+	void Reset();
+
+	/** Id of the sub-assembly containing Part, INDEX_NONE if untracked. Ids may change on any connect or disconnect. */
+	int32 GetComponentId(const APartActor* Part) const;
+
+	/** Is Part connected to the base, directly or through other parts? */
+	bool IsGrounded(const APartActor* Part) const;
+
+	bool AreConnected(const APartActor* PartA, const APartActor* PartB) const;
+
+	/** Number of parts in Part's sub-assembly, 0 if untracked */
+	int32 GetComponentSize(const APartActor* Part) const;
+
+	/** Parts in Part's sub-assembly, including Part itself */
+	void GetComponentMembers(const APartActor* Part, TArray<APartActor*>& OutMembers) const;
+
+	/** Call Func with each part in Part's sub-assembly without building an array */
+	template <typename FuncType>
+	void ForEachComponentMember(const APartActor* Part, FuncType&& Func) const
+	{
+		const int32 Start = FindNode(Part);
+		if (Start == INDEX_NONE)
+		{
+			return;
+		}
+		int32 Node = Start;
+		do
+		{
+			if (NodeParts[Node])
+			{
+				Func(NodeParts[Node]);
+			}
+			Node = Next[Node];
+		}
+		while (Node != Start);
+	}
+
+	/** Sub-assemblies that contain at least one part */
+	int32 GetNumComponents() const;
+
+	int32 GetNumParts() const { return PartNodes.Num(); }
+
+private:
+	static constexpr int32 GroundNode = 0;
+
+	int32 FindNode(const APartActor* Part) const;
+	int32 FindOrAddNode(APartActor* Part);
+	int32 FindRoot(int32 Node) const;
+	void Union(int32 NodeA, int32 NodeB);
+
+	/** Link Nodes into one circular list and one set rooted at Nodes[0] */
+	void MakeSet(TConstArrayView<int32> Nodes);
+
+	TMap<const APartActor*, int32> PartNodes;
+	TArray<APartActor*> NodeParts;
+
+	/** Union-find parent, compressed during const lookups */
+	mutable TArray<int32> Parent;
+	/** Members in the set, valid on roots */
+	TArray<int32> Size;
+	/** Next member on the set's circular list */
+	TArray<int32> Next;
+	TArray<int32> FreeNodes;
+
+	/** Number of sets, including the base */
+	int32 NumSets = 0;
+
+	/** Disconnect search scratch: which side visited a node, keyed by SearchStamp */
+	TArray<uint32> VisitStamp;
+	TArray<uint8> VisitSide;
+	uint32 SearchStamp = 0;
+};